@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "ActorLearner.h"
+#include "Environment.h"
+
+ActorLearner::ActorLearner(const PipelineConfig& Config):
+	mConfig(Config),
+	mReports(4 * static_cast<std::size_t>(Config.Actors) * Config.EnvsPerActor),
+	mStop(false),
+	mProgressInterval(0),
+	mLagSum(0.0),
+	mLagCount(0),
+	mMaxLag(0),
+	mReturnSum(0.0),
+	mReturnCount(0),
+	mEpisodes(0)
+{
+	mConfig.Actors = std::max<std::uint32_t>(1, mConfig.Actors);
+	mConfig.EnvsPerActor = std::max<std::uint32_t>(1, mConfig.EnvsPerActor);
+	mConfig.BatchTrajectories = std::max<std::uint32_t>(1, mConfig.BatchTrajectories);
+}
+
+ActorLearner::~ActorLearner() = default;
+
+void ActorLearner::SetProgress(const std::uint64_t& Interval, ProgressFunc Progress)
+{
+	mProgressInterval = Interval;
+	mProgress = std::move(Progress);
+}
+
+PipelineStats ActorLearner::Run(const PolicyParams& Initial)
+{
+	mParams = Initial;
+	mWeights.reset(new VersionedPtr<PolicyParams>(mConfig.Actors, std::unique_ptr<PolicyParams>(new PolicyParams(mParams))));
+
+	mActors.clear();
+
+	for (std::uint32_t i = 0; i < mConfig.Actors; ++i)
+	{
+		mActors.emplace_back(new ActorState(mConfig.QueueCapacity));
+	}
+
+	mLagSum = 0.0;
+	mLagCount = mMaxLag = 0;
+	mReturnSum = 0.0;
+	mReturnCount = mEpisodes = 0;
+	mStop.store(false);
+
+	PolicyOptimizer Optimizer(mConfig.Update);
+	PipelineStats Stats;
+
+	const auto Start = std::chrono::steady_clock::now();
+	auto GetSeconds = [&Start]()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	};
+
+	std::vector<std::thread> Threads;
+
+	for (std::uint32_t i = 0; i < mConfig.Actors; ++i)
+	{
+		Threads.emplace_back(&ActorLearner::RunActor, this, i);
+	}
+
+	std::vector<Trajectory> Batch;
+	Batch.reserve(mConfig.BatchTrajectories);
+
+	Trajectory Temp;
+	EpisodeReport Report;
+	std::uint32_t Next = 0;
+
+	for (std::uint64_t Update = 1; Update <= mConfig.Updates; ++Update)
+	{
+		Batch.clear();
+
+		// Round robin over the actor queues so no actor's data goes stale.
+		while (Batch.size() < mConfig.BatchTrajectories)
+		{
+			bool IsPopped = false;
+
+			for (std::uint32_t i = 0; i < mConfig.Actors && Batch.size() < mConfig.BatchTrajectories; ++i)
+			{
+				if (mActors[(Next + i) % mConfig.Actors]->Queue.TryPop(Temp))
+				{
+					const std::uint64_t Lag = mParams.Version - Temp.Version;
+
+					mLagSum += static_cast<double>(Lag);
+					++mLagCount;
+					mMaxLag = std::max(mMaxLag, Lag);
+
+					Batch.push_back(Temp);
+					IsPopped = true;
+				}
+			}
+			Next = (Next + 1) % mConfig.Actors;
+
+			if (!IsPopped)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		Stats.LastUpdate = Optimizer.Update(mParams, Batch);
+		mWeights->Publish(std::unique_ptr<PolicyParams>(new PolicyParams(mParams)));
+		Stats.Updates = Update;
+
+		while (mReports.TryPop(Report))
+		{
+			mReturnSum += Report.Return;
+			++mReturnCount;
+			++mEpisodes;
+		}
+
+		if (mProgress && mProgressInterval > 0 && (Update % mProgressInterval == 0 || Update == mConfig.Updates))
+		{
+			CollectStats(Stats, GetSeconds());
+			mProgress(mParams, Stats);
+
+			mReturnSum = 0.0;
+			mReturnCount = 0;
+		}
+	}
+
+	mStop.store(true);
+
+	for (std::thread& Iter : Threads)
+	{
+		Iter.join();
+	}
+
+	CollectStats(Stats, GetSeconds());
+	return Stats;
+}
+
+void ActorLearner::RunActor(const std::uint32_t& Index)
+{
+	ActorState& State = *mActors[Index];
+	const std::size_t Count = mConfig.EnvsPerActor;
+
+	std::mt19937_64 Rng(mConfig.Seed * 0x9E3779B97F4A7C15ull + Index);
+
+	std::vector<TargetEnv> Envs;
+	std::vector<double> Obs(Count), Actions(Count), LogProbs(Count);
+	std::vector<Trajectory> Out(Count);
+
+	Envs.reserve(Count);
+
+	for (std::size_t e = 0; e < Count; ++e)
+	{
+		Envs.emplace_back(Rng(), mConfig.EpisodeLength);
+		Obs[e] = Envs[e].Reset();
+	}
+
+	while (!mStop.load(std::memory_order_relaxed))
+	{
+		// Held until the next Acquire, so one trajectory sees one version.
+		const PolicyParams* Params = mWeights->Acquire(Index);
+
+		for (Trajectory& Iter : Out)
+		{
+			Iter.Version = Params->Version;
+		}
+
+		for (std::size_t t = 0; t < Trajectory::LENGTH; ++t)
+		{
+			Policy::Act(*Params, Obs.data(), Count, Rng, Actions.data(), LogProbs.data());
+
+			for (std::size_t e = 0; e < Count; ++e)
+			{
+				Trajectory& Iter = Out[e];
+				double Reward;
+				bool Done;
+
+				Iter.Obs[t] = Obs[e];
+				Iter.Actions[t] = Actions[e];
+				Iter.LogProbs[t] = LogProbs[e];
+
+				Obs[e] = Envs[e].Step(Actions[e], Reward, Done);
+
+				Iter.Rewards[t] = Reward;
+				Iter.Dones[t] = Done;
+
+				if (Done && !mReports.TryPush({ Envs[e].GetLastReturn(), Params->Version }))
+				{
+					State.Dropped.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		State.Steps.fetch_add(Count * Trajectory::LENGTH, std::memory_order_relaxed);
+
+		for (std::size_t e = 0; e < Count; ++e)
+		{
+			Out[e].Obs[Trajectory::LENGTH] = Obs[e];
+
+			while (!State.Queue.TryPush(Out[e]))
+			{
+				if (mStop.load(std::memory_order_relaxed))
+				{
+					mWeights->Release(Index);
+					return;
+				}
+
+				State.Stalls.fetch_add(1, std::memory_order_relaxed);
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	mWeights->Release(Index);
+}
+
+void ActorLearner::CollectStats(PipelineStats& Stats, const double& Seconds)
+{
+	Stats.Seconds = Seconds;
+	Stats.EnvSteps = Stats.ActorStalls = Stats.DroppedReports = 0;
+
+	for (const std::unique_ptr<ActorState>& Iter : mActors)
+	{
+		Stats.EnvSteps += Iter->Steps.load(std::memory_order_relaxed);
+		Stats.ActorStalls += Iter->Stalls.load(std::memory_order_relaxed);
+		Stats.DroppedReports += Iter->Dropped.load(std::memory_order_relaxed);
+	}
+
+	Stats.Episodes = mEpisodes;
+	Stats.StepsPerSec = Seconds > 0.0 ? Stats.EnvSteps / Seconds : 0.0;
+	Stats.UpdatesPerSec = Seconds > 0.0 ? Stats.Updates / Seconds : 0.0;
+	Stats.MeanLag = mLagCount > 0 ? mLagSum / mLagCount : 0.0;
+	Stats.MaxLag = mMaxLag;
+	Stats.RecentReturn = mReturnCount > 0 ? mReturnSum / mReturnCount : 0.0;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "LockFreeQueue.h"
+#include "Policy.h"
+#include "VersionedPtr.h"
+
+struct PipelineConfig
+{
+	std::uint32_t Actors = 4;
+	std::uint32_t EnvsPerActor = 16;
+	std::uint32_t EpisodeLength = 32;
+
+	// Trajectories per learner update and per actor queue.
+	std::uint32_t BatchTrajectories = 32;
+	std::uint32_t QueueCapacity = 64;
+
+	std::uint64_t Updates = 500;
+	std::uint64_t Seed = 1;
+
+	UpdateConfig Update;
+};
+
+struct PipelineStats
+{
+	double Seconds = 0.0;
+
+	std::uint64_t EnvSteps = 0;
+	std::uint64_t Updates = 0;
+	std::uint64_t Episodes = 0;
+
+	double StepsPerSec = 0.0;
+	double UpdatesPerSec = 0.0;
+
+	// Learner version when a trajectory was consumed minus the version that
+	// generated it, i.e. how many updates behind the data was.
+	double MeanLag = 0.0;
+	std::uint64_t MaxLag = 0;
+
+	// Actor pushes that found their queue full, and episode reports dropped
+	// because the report queue was full.
+	std::uint64_t ActorStalls = 0;
+	std::uint64_t DroppedReports = 0;
+
+	// Mean return of the episodes reported since the previous progress call.
+	double RecentReturn = 0.0;
+
+	UpdateStats LastUpdate;
+};
+
+// Asynchronous actor-learner loop. Actor threads step their environments
+// with batched policy inference and push fixed-length trajectories into
+// their own SPSC queue; finished episodes are reported through one shared
+// MPSC queue. The learner (the thread calling Run) pops full batches, runs
+// a PPO or A2C update and publishes the new weights through a VersionedPtr,
+// so actors pick them up at their next trajectory without ever blocking.
+class ActorLearner
+{
+public:
+	using ProgressFunc = std::function<void(const PolicyParams&, const PipelineStats&)>;
+
+	explicit ActorLearner(const PipelineConfig& Config);
+	~ActorLearner();
+
+	ActorLearner(const ActorLearner&) = delete;
+	ActorLearner& operator=(const ActorLearner&) = delete;
+
+	// Called from the learner thread every Interval updates and at the end.
+	void SetProgress(const std::uint64_t& Interval, ProgressFunc Progress);
+
+	PipelineStats Run(const PolicyParams& Initial = PolicyParams());
+
+	const PolicyParams& GetParams() const { return mParams; }
+
+private:
+	struct EpisodeReport
+	{
+		double Return;
+		std::uint64_t Version;
+	};
+
+	struct alignas(CACHE_LINE) ActorState
+	{
+		explicit ActorState(const std::size_t& Capacity): Queue(Capacity) {}
+
+		SpscQueue<Trajectory> Queue;
+		std::atomic<std::uint64_t> Steps{ 0 };
+		std::atomic<std::uint64_t> Stalls{ 0 };
+		std::atomic<std::uint64_t> Dropped{ 0 };
+	};
+
+	void RunActor(const std::uint32_t& Index);
+
+	void CollectStats(PipelineStats& Stats, const double& Seconds);
+
+	PipelineConfig mConfig;
+	PolicyParams mParams;
+
+	std::unique_ptr<VersionedPtr<PolicyParams>> mWeights;
+	std::vector<std::unique_ptr<ActorState>> mActors;
+	MpscQueue<EpisodeReport> mReports;
+
+	std::atomic<bool> mStop;
+
+	std::uint64_t mProgressInterval;
+	ProgressFunc mProgress;
+
+	double mLagSum;
+	std::uint64_t mLagCount;
+	std::uint64_t mMaxLag;
+
+	double mReturnSum;
+	std::uint64_t mReturnCount;
+	std::uint64_t mEpisodes;
+};
@@ -0,0 +1,40 @@
+#include "Environment.h"
+
+TargetEnv::TargetEnv(const std::uint64_t& Seed, const std::uint32_t& EpisodeLength):
+	mRng(Seed),
+	mInput(0.0, 1.0),
+	mEpisodeLength(EpisodeLength),
+	mStep(0),
+	mObs(0.0),
+	mReturn(0.0),
+	mLastReturn(0.0)
+{
+	Reset();
+}
+
+double TargetEnv::Reset()
+{
+	mStep = 0;
+	mReturn = 0.0;
+	mObs = mInput(mRng);
+	return mObs;
+}
+
+double TargetEnv::Step(const double& Action, double& Reward, bool& Done)
+{
+	const double Error = Action - GetTarget(mObs);
+
+	Reward = -Error * Error;
+	mReturn += Reward;
+
+	Done = ++mStep >= mEpisodeLength;
+
+	if (Done)
+	{
+		mLastReturn = mReturn;
+		return Reset();
+	}
+
+	mObs = mInput(mRng);
+	return mObs;
+}
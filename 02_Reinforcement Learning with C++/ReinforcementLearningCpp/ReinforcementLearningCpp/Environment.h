@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+// The regression main.cpp trained by hand, posed as an RL task: every step
+// shows an input X in [0, 1], the agent answers with a real number and is
+// rewarded -(Action - Target(X))^2. Steps are independent (a contextual
+// bandit), so episodes only exist to report returns and cut bootstraps.
+class TargetEnv
+{
+public:
+	TargetEnv(const std::uint64_t& Seed, const std::uint32_t& EpisodeLength);
+
+	// 3X + 1 maps input 1 to the 4 main.cpp used as its target.
+	static double GetTarget(const double& X) { return 3.0 * X + 1.0; }
+
+	double Reset();
+
+	// Returns the next observation; after Done it is already the first one of
+	// the next episode.
+	double Step(const double& Action, double& Reward, bool& Done);
+
+	// Return of the episode that ended most recently.
+	double GetLastReturn() const { return mLastReturn; }
+
+private:
+	std::mt19937_64 mRng;
+	std::uniform_real_distribution<double> mInput;
+
+	std::uint32_t mEpisodeLength;
+	std::uint32_t mStep;
+
+	double mObs;
+	double mReturn;
+	double mLastReturn;
+};
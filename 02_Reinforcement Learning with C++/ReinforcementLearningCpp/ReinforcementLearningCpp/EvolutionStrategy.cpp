@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "EvolutionStrategy.h"
+
+namespace
+{
+	std::uint64_t SplitMix(std::uint64_t Value)
+	{
+		Value += 0x9E3779B97F4A7C15ull;
+		Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+		return Value ^ (Value >> 31);
+	}
+}
+
+EvolutionStrategy::EvolutionStrategy(const EsConfig& Config, const std::vector<double>& Initial, FitnessFunc Fitness):
+	mConfig(Config),
+	mFitness(std::move(Fitness)),
+	mParams(Initial),
+	mPairs(std::max<std::uint32_t>(1, (Config.Population + 1) / 2)),
+	mThreadCount(Config.Threads > 0 ? Config.Threads : std::max(1u, std::thread::hardware_concurrency())),
+	mGeneration(0),
+	mSeedRng(Config.Seed),
+	mSeedTable(mPairs),
+	mFitnessValues(2 * static_cast<std::size_t>(mPairs)),
+	mUtility(2 * static_cast<std::size_t>(mPairs)),
+	mOrder(2 * static_cast<std::size_t>(mPairs)),
+	mMoment(Initial.size(), 0.0),
+	mVelocity(Initial.size(), 0.0),
+	mPhase(Phase::EVALUATE),
+	mTicket(0),
+	mPending(0)
+{
+	mThreadCount = std::min(mThreadCount, mPairs);
+
+	mCandidates.assign(mThreadCount, std::vector<double>(mParams.size()));
+	mGradients.assign(mThreadCount, std::vector<double>(mParams.size()));
+
+	// The calling thread works as worker 0.
+	for (std::uint32_t i = 1; i < mThreadCount; ++i)
+	{
+		mThreads.emplace_back(&EvolutionStrategy::RunWorker, this, i);
+	}
+}
+
+EvolutionStrategy::~EvolutionStrategy()
+{
+	{
+		std::lock_guard<std::mutex> Lock(mMutex);
+		mPhase = Phase::EXIT;
+		++mTicket;
+	}
+	mWake.notify_all();
+
+	for (std::thread& Iter : mThreads)
+	{
+		Iter.join();
+	}
+}
+
+double EvolutionStrategy::GetNoise(const std::uint64_t& Seed, const std::size_t& Index)
+{
+	// Box-Muller on two counter-based uniforms, so any component can be
+	// regenerated on its own and in any order.
+	const std::uint64_t Bits0 = SplitMix(Seed ^ (2 * static_cast<std::uint64_t>(Index)));
+	const std::uint64_t Bits1 = SplitMix(Seed ^ (2 * static_cast<std::uint64_t>(Index) + 1));
+
+	const double U0 = (static_cast<double>(Bits0 >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+	const double U1 = static_cast<double>(Bits1 >> 11) * (1.0 / 9007199254740992.0);
+
+	return std::sqrt(-2.0 * std::log(U0)) * std::cos(6.283185307179586 * U1);
+}
+
+GenerationStats EvolutionStrategy::Step()
+{
+	for (std::uint64_t& Iter : mSeedTable)
+	{
+		Iter = mSeedRng();
+	}
+
+	RunPhase(Phase::EVALUATE);
+
+	// Centered ranks in [-0.5, 0.5]: only the order of the fitness values
+	// matters, so outliers cannot dominate the step.
+	const std::size_t Count = mFitnessValues.size();
+	std::iota(mOrder.begin(), mOrder.end(), 0u);
+	std::sort(mOrder.begin(), mOrder.end(), [this](const std::uint32_t& Left, const std::uint32_t& Right)
+	{
+		return mFitnessValues[Left] < mFitnessValues[Right];
+	});
+
+	for (std::size_t Rank = 0; Rank < Count; ++Rank)
+	{
+		mUtility[mOrder[Rank]] = static_cast<double>(Rank) / static_cast<double>(Count - 1) - 0.5;
+	}
+
+	GenerationStats Stats;
+	Stats.Generation = ++mGeneration;
+	Stats.MeanFitness = std::accumulate(mFitnessValues.begin(), mFitnessValues.end(), 0.0) / Count;
+	Stats.BestFitness = mFitnessValues[mOrder.back()];
+
+	RunPhase(Phase::ACCUMULATE);
+
+	// Adam ascent on Sum((U+ - U-) * Noise) / (Population * Sigma).
+	const double Beta1 = 0.9, Beta2 = 0.999;
+	const double Scale = 1.0 / (Count * mConfig.Sigma);
+	const double Correct1 = 1.0 - std::pow(Beta1, static_cast<double>(mGeneration));
+	const double Correct2 = 1.0 - std::pow(Beta2, static_cast<double>(mGeneration));
+
+	for (std::size_t j = 0; j < mParams.size(); ++j)
+	{
+		double Grad = 0.0;
+
+		for (const std::vector<double>& Partial : mGradients)
+		{
+			Grad += Partial[j];
+		}
+		Grad *= Scale;
+
+		mMoment[j] = Beta1 * mMoment[j] + (1.0 - Beta1) * Grad;
+		mVelocity[j] = Beta2 * mVelocity[j] + (1.0 - Beta2) * Grad * Grad;
+
+		mParams[j] += mConfig.LearnRate * (mMoment[j] / Correct1) / (std::sqrt(mVelocity[j] / Correct2) + 1e-8);
+	}
+
+	return Stats;
+}
+
+void EvolutionStrategy::RunPhase(const Phase& Job)
+{
+	{
+		std::lock_guard<std::mutex> Lock(mMutex);
+		mPhase = Job;
+		++mTicket;
+		mPending = mThreadCount - 1;
+	}
+	mWake.notify_all();
+
+	DoWork(Job, 0);
+
+	std::unique_lock<std::mutex> Lock(mMutex);
+	mDone.wait(Lock, [this]() { return mPending == 0; });
+}
+
+void EvolutionStrategy::RunWorker(const std::uint32_t& Worker)
+{
+	std::uint64_t Seen = 0;
+
+	while (true)
+	{
+		Phase Job;
+		{
+			std::unique_lock<std::mutex> Lock(mMutex);
+			mWake.wait(Lock, [this, Seen]() { return mTicket != Seen; });
+
+			Seen = mTicket;
+			Job = mPhase;
+		}
+
+		if (Job == Phase::EXIT)
+		{
+			return;
+		}
+
+		DoWork(Job, Worker);
+
+		bool Last;
+		{
+			std::lock_guard<std::mutex> Lock(mMutex);
+			Last = --mPending == 0;
+		}
+
+		if (Last)
+		{
+			mDone.notify_one();
+		}
+	}
+}
+
+void EvolutionStrategy::DoWork(const Phase& Job, const std::uint32_t& Worker)
+{
+	const std::size_t Begin = static_cast<std::size_t>(mPairs) * Worker / mThreadCount;
+	const std::size_t End = static_cast<std::size_t>(mPairs) * (Worker + 1) / mThreadCount;
+	const std::size_t Size = mParams.size();
+
+	if (Job == Phase::EVALUATE)
+	{
+		std::vector<double>& Candidate = mCandidates[Worker];
+
+		for (std::size_t Pair = Begin; Pair < End; ++Pair)
+		{
+			const std::uint64_t Seed = mSeedTable[Pair];
+
+			for (std::size_t j = 0; j < Size; ++j)
+			{
+				Candidate[j] = mParams[j] + mConfig.Sigma * GetNoise(Seed, j);
+			}
+			mFitnessValues[2 * Pair] = mFitness(Candidate.data(), Size, Worker);
+
+			for (std::size_t j = 0; j < Size; ++j)
+			{
+				Candidate[j] = 2.0 * mParams[j] - Candidate[j];
+			}
+			mFitnessValues[2 * Pair + 1] = mFitness(Candidate.data(), Size, Worker);
+		}
+	}
+	else
+	{
+		std::vector<double>& Gradient = mGradients[Worker];
+		std::fill(Gradient.begin(), Gradient.end(), 0.0);
+
+		for (std::size_t Pair = Begin; Pair < End; ++Pair)
+		{
+			const std::uint64_t Seed = mSeedTable[Pair];
+			const double Weight = mUtility[2 * Pair] - mUtility[2 * Pair + 1];
+
+			for (std::size_t j = 0; j < Size; ++j)
+			{
+				Gradient[j] += Weight * GetNoise(Seed, j);
+			}
+		}
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct EsConfig
+{
+	// Perturbed candidates per generation, evaluated as antithetic pairs
+	// (+Noise, -Noise), so odd values are rounded up.
+	std::uint32_t Population = 256;
+
+	double Sigma = 0.1;
+	double LearnRate = 0.05;
+
+	// 0 uses every hardware thread.
+	std::uint32_t Threads = 0;
+	std::uint64_t Seed = 1;
+};
+
+struct GenerationStats
+{
+	std::uint64_t Generation = 0;
+
+	double MeanFitness = 0.0;
+	double BestFitness = 0.0;
+};
+
+// OpenAI-style evolution strategies: sample Gaussian perturbations around
+// the current parameters, evaluate them on all threads, turn fitness into
+// centered ranks and step along the rank-weighted sum of the noise with
+// Adam. Perturbations are never stored. Each generation draws one seed per
+// pair into a shared table and every worker regenerates the noise it needs
+// from those seeds, so memory is O(params) per thread plus O(population)
+// scalars.
+class EvolutionStrategy
+{
+public:
+	// Fitness of Params (higher is better). Called concurrently; Worker is
+	// the calling thread's index in [0, GetThreadCount()).
+	using FitnessFunc = std::function<double(const double* Params, const std::size_t& Count, const std::uint32_t& Worker)>;
+
+	EvolutionStrategy(const EsConfig& Config, const std::vector<double>& Initial, FitnessFunc Fitness);
+	~EvolutionStrategy();
+
+	EvolutionStrategy(const EvolutionStrategy&) = delete;
+	EvolutionStrategy& operator=(const EvolutionStrategy&) = delete;
+
+	GenerationStats Step();
+
+	const std::vector<double>& GetParams() const { return mParams; }
+	std::uint32_t GetThreadCount() const { return mThreadCount; }
+	std::uint32_t GetPopulation() const { return 2 * mPairs; }
+	std::uint64_t GetGeneration() const { return mGeneration; }
+
+	// Component Index of the unit Gaussian vector for Seed.
+	static double GetNoise(const std::uint64_t& Seed, const std::size_t& Index);
+
+private:
+	enum class Phase
+	{
+		EVALUATE,
+		ACCUMULATE,
+		EXIT
+	};
+
+	void RunPhase(const Phase& Job);
+	void RunWorker(const std::uint32_t& Worker);
+	void DoWork(const Phase& Job, const std::uint32_t& Worker);
+
+	EsConfig mConfig;
+	FitnessFunc mFitness;
+
+	std::vector<double> mParams;
+	std::uint32_t mPairs;
+	std::uint32_t mThreadCount;
+	std::uint64_t mGeneration;
+
+	std::mt19937_64 mSeedRng;
+	std::vector<std::uint64_t> mSeedTable;
+
+	// Two entries per pair: fitness of +Noise then -Noise; reused for ranks.
+	std::vector<double> mFitnessValues;
+	std::vector<double> mUtility;
+	std::vector<std::uint32_t> mOrder;
+
+	// Per worker: one candidate and one partial gradient.
+	std::vector<std::vector<double>> mCandidates;
+	std::vector<std::vector<double>> mGradients;
+
+	std::vector<double> mMoment;
+	std::vector<double> mVelocity;
+
+	std::vector<std::thread> mThreads;
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	std::condition_variable mDone;
+	Phase mPhase;
+	std::uint64_t mTicket;
+	std::uint32_t mPending;
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+constexpr std::size_t CACHE_LINE = 64;
+
+inline std::size_t RoundUpPow2(std::size_t Value)
+{
+	std::size_t Result = 1;
+
+	while (Result < Value)
+	{
+		Result <<= 1;
+	}
+	return Result;
+}
+
+// Bounded ring for exactly one producer thread and one consumer thread.
+// Each side caches the other's index so the shared line is only read when
+// the ring looks full (producer) or empty (consumer).
+template <typename T>
+class SpscQueue
+{
+public:
+	explicit SpscQueue(std::size_t Capacity):
+		mCapacity(RoundUpPow2(Capacity)),
+		mMask(mCapacity - 1),
+		mBuffer(new T[mCapacity])
+	{}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	std::size_t GetCapacity() const { return mCapacity; }
+
+	std::size_t GetSizeApprox() const
+	{
+		return mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_acquire);
+	}
+
+	// Producer only.
+	bool TryPush(const T& Value)
+	{
+		const std::size_t Tail = mTail.load(std::memory_order_relaxed);
+
+		if (Tail - mHeadCache == mCapacity)
+		{
+			mHeadCache = mHead.load(std::memory_order_acquire);
+
+			if (Tail - mHeadCache == mCapacity)
+			{
+				return false;
+			}
+		}
+
+		mBuffer[Tail & mMask] = Value;
+		mTail.store(Tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only.
+	bool TryPop(T& Out)
+	{
+		const std::size_t Head = mHead.load(std::memory_order_relaxed);
+
+		if (Head == mTailCache)
+		{
+			mTailCache = mTail.load(std::memory_order_acquire);
+
+			if (Head == mTailCache)
+			{
+				return false;
+			}
+		}
+
+		Out = std::move(mBuffer[Head & mMask]);
+		mHead.store(Head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	const std::size_t mCapacity;
+	const std::size_t mMask;
+	std::unique_ptr<T[]> mBuffer;
+
+	alignas(CACHE_LINE) std::atomic<std::size_t> mHead{ 0 };
+	std::size_t mTailCache = 0;
+
+	alignas(CACHE_LINE) std::atomic<std::size_t> mTail{ 0 };
+	std::size_t mHeadCache = 0;
+};
+
+// Bounded queue for any number of producers and one consumer. Every cell
+// carries a sequence number (Vyukov's bounded queue): producers claim a slot
+// with one CAS on the tail, and the consumer sees a cell as ready once its
+// sequence is one past the slot index.
+template <typename T>
+class MpscQueue
+{
+public:
+	explicit MpscQueue(std::size_t Capacity):
+		mCapacity(RoundUpPow2(Capacity)),
+		mMask(mCapacity - 1),
+		mCells(new Cell[mCapacity])
+	{
+		for (std::size_t i = 0; i < mCapacity; ++i)
+		{
+			mCells[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+	std::size_t GetCapacity() const { return mCapacity; }
+
+	// Any thread.
+	bool TryPush(const T& Value)
+	{
+		std::size_t Pos = mTail.load(std::memory_order_relaxed);
+		Cell* Target;
+
+		while (true)
+		{
+			Target = &mCells[Pos & mMask];
+			const std::size_t Sequence = Target->Sequence.load(std::memory_order_acquire);
+			const std::intptr_t Diff = static_cast<std::intptr_t>(Sequence) - static_cast<std::intptr_t>(Pos);
+
+			if (Diff == 0)
+			{
+				if (mTail.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (Diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				Pos = mTail.load(std::memory_order_relaxed);
+			}
+		}
+
+		Target->Value = Value;
+		Target->Sequence.store(Pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only.
+	bool TryPop(T& Out)
+	{
+		Cell& Source = mCells[mHead & mMask];
+
+		if (Source.Sequence.load(std::memory_order_acquire) != mHead + 1)
+		{
+			return false;
+		}
+
+		Out = std::move(Source.Value);
+		Source.Sequence.store(mHead + mCapacity, std::memory_order_release);
+		++mHead;
+		return true;
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<std::size_t> Sequence;
+		T Value;
+	};
+
+	const std::size_t mCapacity;
+	const std::size_t mMask;
+	std::unique_ptr<Cell[]> mCells;
+
+	alignas(CACHE_LINE) std::atomic<std::size_t> mTail{ 0 };
+	alignas(CACHE_LINE) std::size_t mHead = 0;
+};
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cmath>
+#include "Policy.h"
+
+namespace
+{
+	const double HALF_LOG_2PI = 0.91893853320467274;
+
+	double GetPreActivation(const PolicyParams& Params, const double& Obs)
+	{
+		return Params.Values[PolicyParams::WEIGHT] * Obs + Params.Values[PolicyParams::BIAS];
+	}
+}
+
+double Policy::GetMean(const PolicyParams& Params, const double& Obs)
+{
+	return std::max(0.0, GetPreActivation(Params, Obs));
+}
+
+double Policy::GetValue(const PolicyParams& Params, const double& Obs)
+{
+	return Params.Values[PolicyParams::VALUE_WEIGHT] * Obs + Params.Values[PolicyParams::VALUE_BIAS];
+}
+
+double Policy::GetLogProb(const PolicyParams& Params, const double& Obs, const double& Action)
+{
+	const double LogStd = Params.Values[PolicyParams::LOG_STD];
+	const double Z = (Action - GetMean(Params, Obs)) * std::exp(-LogStd);
+
+	return -0.5 * Z * Z - LogStd - HALF_LOG_2PI;
+}
+
+void Policy::Act(const PolicyParams& Params, const double* Obs, const std::size_t& Count,
+	std::mt19937_64& Rng, double* Actions, double* LogProbs)
+{
+	const double Weight = Params.Values[PolicyParams::WEIGHT];
+	const double Bias = Params.Values[PolicyParams::BIAS];
+	const double LogStd = Params.Values[PolicyParams::LOG_STD];
+	const double Std = std::exp(LogStd);
+
+	// Kept apart from the sampling so the compiler can vectorize it.
+	for (std::size_t i = 0; i < Count; ++i)
+	{
+		Actions[i] = std::max(0.0, Weight * Obs[i] + Bias);
+	}
+
+	std::normal_distribution<double> Noise(0.0, 1.0);
+
+	for (std::size_t i = 0; i < Count; ++i)
+	{
+		const double Z = Noise(Rng);
+
+		Actions[i] += Std * Z;
+		LogProbs[i] = -0.5 * Z * Z - LogStd - HALF_LOG_2PI;
+	}
+}
+
+PolicyOptimizer::PolicyOptimizer(const UpdateConfig& Config):
+	mConfig(Config),
+	mRng(0x5EED),
+	mMoment(),
+	mVelocity(),
+	mSteps(0)
+{}
+
+UpdateStats PolicyOptimizer::Update(PolicyParams& Params, const std::vector<Trajectory>& Batch)
+{
+	BuildSamples(Params, Batch);
+
+	UpdateStats Stats;
+
+	if (mSamples.empty())
+	{
+		return Stats;
+	}
+
+	if (mConfig.Algo == Algorithm::A2C)
+	{
+		Step(Params, 0, mSamples.size(), Stats);
+	}
+	else
+	{
+		const std::size_t MiniBatches = std::max<std::size_t>(1, mConfig.MiniBatches);
+		const std::size_t Size = (mSamples.size() + MiniBatches - 1) / MiniBatches;
+
+		for (std::uint32_t Epoch = 0; Epoch < mConfig.Epochs; ++Epoch)
+		{
+			std::shuffle(mSamples.begin(), mSamples.end(), mRng);
+
+			for (std::size_t Begin = 0; Begin < mSamples.size(); Begin += Size)
+			{
+				Step(Params, Begin, std::min(Begin + Size, mSamples.size()), Stats);
+			}
+		}
+	}
+
+	const double Passes = mConfig.Algo == Algorithm::A2C ? 1.0 : std::max<std::uint32_t>(1, mConfig.Epochs);
+	const double Scale = 1.0 / (Passes * mSamples.size());
+
+	Stats.PolicyLoss *= Scale;
+	Stats.ValueLoss *= Scale;
+	Stats.ClipFraction *= Scale;
+	Stats.ApproxKl *= Scale;
+
+	++Params.Version;
+	return Stats;
+}
+
+void PolicyOptimizer::BuildSamples(const PolicyParams& Params, const std::vector<Trajectory>& Batch)
+{
+	mSamples.clear();
+
+	for (const Trajectory& Iter : Batch)
+	{
+		double Values[Trajectory::LENGTH + 1];
+
+		for (std::size_t t = 0; t <= Trajectory::LENGTH; ++t)
+		{
+			Values[t] = Policy::GetValue(Params, Iter.Obs[t]);
+		}
+
+		const std::size_t First = mSamples.size();
+		mSamples.resize(First + Trajectory::LENGTH);
+
+		double Gae = 0.0;
+
+		for (std::size_t t = Trajectory::LENGTH; t-- > 0;)
+		{
+			const double Next = Iter.Dones[t] ? 0.0 : 1.0;
+			const double Delta = Iter.Rewards[t] + mConfig.Gamma * Next * Values[t + 1] - Values[t];
+
+			Gae = Delta + mConfig.Gamma * mConfig.Lambda * Next * Gae;
+
+			Sample& Out = mSamples[First + t];
+			Out.Obs = Iter.Obs[t];
+			Out.Action = Iter.Actions[t];
+			Out.LogProb = Iter.LogProbs[t];
+			Out.Advantage = Gae;
+			Out.Return = Gae + Values[t];
+		}
+	}
+
+	double Mean = 0.0, Square = 0.0;
+
+	for (const Sample& Iter : mSamples)
+	{
+		Mean += Iter.Advantage;
+		Square += Iter.Advantage * Iter.Advantage;
+	}
+
+	const double Count = static_cast<double>(std::max<std::size_t>(1, mSamples.size()));
+	Mean /= Count;
+	const double InvStd = 1.0 / (std::sqrt(std::max(0.0, Square / Count - Mean * Mean)) + 1e-8);
+
+	for (Sample& Iter : mSamples)
+	{
+		Iter.Advantage = (Iter.Advantage - Mean) * InvStd;
+	}
+}
+
+void PolicyOptimizer::Step(PolicyParams& Params, const std::size_t& Begin, const std::size_t& End, UpdateStats& Stats)
+{
+	double Grad[PolicyParams::COUNT] = {};
+
+	const double LogStd = Params.Values[PolicyParams::LOG_STD];
+	const double InvStd = std::exp(-LogStd);
+
+	for (std::size_t i = Begin; i < End; ++i)
+	{
+		const Sample& Iter = mSamples[i];
+
+		const double Pre = GetPreActivation(Params, Iter.Obs);
+		const double Z = (Iter.Action - std::max(0.0, Pre)) * InvStd;
+		const double LogProb = -0.5 * Z * Z - LogStd - HALF_LOG_2PI;
+
+		// dLoss / dLogProb for the policy term.
+		double PolicyGrad;
+
+		if (mConfig.Algo == Algorithm::A2C)
+		{
+			PolicyGrad = -Iter.Advantage;
+			Stats.PolicyLoss -= LogProb * Iter.Advantage;
+		}
+		else
+		{
+			const double Ratio = std::exp(LogProb - Iter.LogProb);
+			const double Clipped = std::min(std::max(Ratio, 1.0 - mConfig.ClipRange), 1.0 + mConfig.ClipRange);
+			const bool IsClipped = Ratio * Iter.Advantage > Clipped * Iter.Advantage;
+
+			PolicyGrad = IsClipped ? 0.0 : -Ratio * Iter.Advantage;
+			Stats.PolicyLoss -= std::min(Ratio * Iter.Advantage, Clipped * Iter.Advantage);
+			Stats.ClipFraction += IsClipped ? 1.0 : 0.0;
+			Stats.ApproxKl += Iter.LogProb - LogProb;
+		}
+
+		if (Pre > 0.0)
+		{
+			const double MeanGrad = PolicyGrad * Z * InvStd;
+			Grad[PolicyParams::WEIGHT] += MeanGrad * Iter.Obs;
+			Grad[PolicyParams::BIAS] += MeanGrad;
+		}
+		Grad[PolicyParams::LOG_STD] += PolicyGrad * (Z * Z - 1.0) - mConfig.EntropyCoef;
+
+		const double Error = Policy::GetValue(Params, Iter.Obs) - Iter.Return;
+		Grad[PolicyParams::VALUE_WEIGHT] += 2.0 * mConfig.ValueCoef * Error * Iter.Obs;
+		Grad[PolicyParams::VALUE_BIAS] += 2.0 * mConfig.ValueCoef * Error;
+		Stats.ValueLoss += Error * Error;
+	}
+
+	// Adam.
+	const double Beta1 = 0.9, Beta2 = 0.999;
+	const double InvCount = 1.0 / static_cast<double>(End - Begin);
+
+	++mSteps;
+	const double Correct1 = 1.0 - std::pow(Beta1, static_cast<double>(mSteps));
+	const double Correct2 = 1.0 - std::pow(Beta2, static_cast<double>(mSteps));
+
+	for (std::size_t k = 0; k < PolicyParams::COUNT; ++k)
+	{
+		const double G = Grad[k] * InvCount;
+
+		mMoment[k] = Beta1 * mMoment[k] + (1.0 - Beta1) * G;
+		mVelocity[k] = Beta2 * mVelocity[k] + (1.0 - Beta2) * G * G;
+
+		Params.Values[k] -= mConfig.LearnRate * (mMoment[k] / Correct1) / (std::sqrt(mVelocity[k] / Correct2) + 1e-8);
+	}
+
+	Params.Values[PolicyParams::LOG_STD] = std::max(Params.Values[PolicyParams::LOG_STD], mConfig.MinLogStd);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Gaussian policy whose mean is the same ReLU unit as Neuron, plus a linear
+// value baseline. All parameters sit in one flat array, so a weight snapshot
+// is a plain copy.
+struct PolicyParams
+{
+	enum Index
+	{
+		WEIGHT,
+		BIAS,
+		LOG_STD,
+		VALUE_WEIGHT,
+		VALUE_BIAS,
+		COUNT
+	};
+
+	double Values[COUNT] = { 2.0, 1.0, -0.5, 0.0, 0.0 };
+
+	// Number of learner updates that produced these values.
+	std::uint64_t Version = 0;
+};
+
+namespace Policy
+{
+	double GetMean(const PolicyParams& Params, const double& Obs);
+	double GetValue(const PolicyParams& Params, const double& Obs);
+	double GetLogProb(const PolicyParams& Params, const double& Obs, const double& Action);
+
+	// Batched inference: means for the whole batch first, then one sample and
+	// its log-probability per entry.
+	void Act(const PolicyParams& Params, const double* Obs, const std::size_t& Count,
+		std::mt19937_64& Rng, double* Actions, double* LogProbs);
+}
+
+// Fixed-length slice of one environment's experience, tagged with the policy
+// version that generated it. Obs holds one extra entry to bootstrap from.
+struct Trajectory
+{
+	static constexpr std::size_t LENGTH = 16;
+
+	double Obs[LENGTH + 1];
+	double Actions[LENGTH];
+	double LogProbs[LENGTH];
+	double Rewards[LENGTH];
+	bool Dones[LENGTH];
+
+	std::uint64_t Version;
+};
+
+enum class Algorithm
+{
+	A2C,
+	PPO
+};
+
+struct UpdateConfig
+{
+	Algorithm Algo = Algorithm::PPO;
+
+	double LearnRate = 0.003;
+	double Gamma = 0.5;
+	double Lambda = 0.9;
+
+	// PPO only; A2C takes one pass over the batch as a single step.
+	double ClipRange = 0.2;
+	std::uint32_t Epochs = 4;
+	std::uint32_t MiniBatches = 4;
+
+	double ValueCoef = 0.5;
+	double EntropyCoef = 0.01;
+	double MinLogStd = -4.0;
+};
+
+struct UpdateStats
+{
+	double PolicyLoss = 0.0;
+	double ValueLoss = 0.0;
+	double ClipFraction = 0.0;
+	double ApproxKl = 0.0;
+};
+
+// Learner-side update. Advantages come from GAE over each trajectory with
+// the current value baseline; the gradients are written out by hand and
+// applied with Adam. PPO clips the importance ratio against the behavior
+// log-probabilities, which also absorbs the policy lag of asynchronous
+// actors; A2C ignores the lag.
+class PolicyOptimizer
+{
+public:
+	explicit PolicyOptimizer(const UpdateConfig& Config);
+
+	const UpdateConfig& GetConfig() const { return mConfig; }
+
+	UpdateStats Update(PolicyParams& Params, const std::vector<Trajectory>& Batch);
+
+private:
+	struct Sample
+	{
+		double Obs;
+		double Action;
+		double LogProb;
+		double Advantage;
+		double Return;
+	};
+
+	void BuildSamples(const PolicyParams& Params, const std::vector<Trajectory>& Batch);
+	void Step(PolicyParams& Params, const std::size_t& Begin, const std::size_t& End, UpdateStats& Stats);
+
+	UpdateConfig mConfig;
+	std::mt19937_64 mRng;
+
+	std::vector<Sample> mSamples;
+
+	double mMoment[PolicyParams::COUNT];
+	double mVelocity[PolicyParams::COUNT];
+	std::uint64_t mSteps;
+};
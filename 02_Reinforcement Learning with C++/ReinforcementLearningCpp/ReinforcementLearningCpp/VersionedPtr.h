@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "LockFreeQueue.h"
+
+// RCU-style pointer with one writer and a fixed set of readers. Publish()
+// swaps in a new value and never waits; the old value is retired and freed
+// by a later Publish() once no reader still holds it. A reader keeps the
+// value from Acquire() valid until its next Acquire() or Release(), which is
+// one atomic store plus a re-check of the current pointer.
+template <typename T>
+class VersionedPtr
+{
+public:
+	VersionedPtr(std::size_t ReaderCount, std::unique_ptr<T> Initial):
+		mCurrent(Initial.release()),
+		mReaderCount(ReaderCount),
+		mSlots(new Slot[ReaderCount])
+	{}
+
+	VersionedPtr(const VersionedPtr&) = delete;
+	VersionedPtr& operator=(const VersionedPtr&) = delete;
+
+	// Readers must be done by now.
+	~VersionedPtr()
+	{
+		delete mCurrent.load(std::memory_order_relaxed);
+
+		for (T* Iter : mRetired)
+		{
+			delete Iter;
+		}
+	}
+
+	// Writer only.
+	void Publish(std::unique_ptr<T> Next)
+	{
+		T* Old = mCurrent.exchange(Next.release(), std::memory_order_seq_cst);
+		mVersion.fetch_add(1, std::memory_order_release);
+
+		mRetired.push_back(Old);
+		Reclaim();
+	}
+
+	// The latest value the writer has published.
+	const T* Acquire(std::size_t Reader)
+	{
+		std::atomic<const T*>& Held = mSlots[Reader].Held;
+		T* Current = mCurrent.load(std::memory_order_acquire);
+
+		while (true)
+		{
+			Held.store(Current, std::memory_order_seq_cst);
+			T* Check = mCurrent.load(std::memory_order_seq_cst);
+
+			if (Check == Current)
+			{
+				return Current;
+			}
+			Current = Check;
+		}
+	}
+
+	void Release(std::size_t Reader)
+	{
+		mSlots[Reader].Held.store(nullptr, std::memory_order_release);
+	}
+
+	// Number of Publish() calls so far.
+	std::uint64_t GetVersion() const { return mVersion.load(std::memory_order_acquire); }
+
+	std::size_t GetRetiredCount() const { return mRetired.size(); }
+
+private:
+	struct alignas(CACHE_LINE) Slot
+	{
+		std::atomic<const T*> Held{ nullptr };
+	};
+
+	void Reclaim()
+	{
+		mHeld.clear();
+
+		for (std::size_t i = 0; i < mReaderCount; ++i)
+		{
+			mHeld.push_back(mSlots[i].Held.load(std::memory_order_seq_cst));
+		}
+
+		auto Freed = std::remove_if(mRetired.begin(), mRetired.end(), [this](T* Candidate)
+		{
+			if (std::find(mHeld.begin(), mHeld.end(), Candidate) != mHeld.end())
+			{
+				return false;
+			}
+			delete Candidate;
+			return true;
+		});
+		mRetired.erase(Freed, mRetired.end());
+	}
+
+	std::atomic<T*> mCurrent;
+	std::atomic<std::uint64_t> mVersion{ 0 };
+
+	const std::size_t mReaderCount;
+	std::unique_ptr<Slot[]> mSlots;
+
+	std::vector<T*> mRetired;
+	std::vector<const T*> mHeld;
+};
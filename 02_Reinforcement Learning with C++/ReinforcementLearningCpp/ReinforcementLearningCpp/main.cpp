@@ -1,23 +1,226 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <thread>
+#include <vector>
+#include "ActorLearner.h"
+#include "Environment.h"
+#include "EvolutionStrategy.h"
 #include "Neuron.h"
 
-int main()
+// ReinforcementLearningCpp [--actors N] [--envs N] [--batch N] [--updates N] [--algo ppo|a2c]
+// ReinforcementLearningCpp --es [--threads N] [--population N] [--generations N] [--samples N]
+int RunActorLearner(int argc, char* argv[])
 {
-	Neuron MyNeuron(2.0, 1.0, 0.4);
+	PipelineConfig Config;
 
-	for (std::size_t i = 0; i < 10; ++i)
+	for (int i = 1; i < argc; ++i)
 	{
-		std::cout << "Training repeat : " << i << '\n';
+		const bool HasValue = i + 1 < argc;
 
-		MyNeuron.PrintFeedForward(1.0);
-		MyNeuron.PropBackward(4.0);
+		if (!std::strcmp(argv[i], "--actors") && HasValue)
+		{
+			Config.Actors = static_cast<std::uint32_t>(std::atoi(argv[++i]));
+		}
+		else if (!std::strcmp(argv[i], "--envs") && HasValue)
+		{
+			Config.EnvsPerActor = static_cast<std::uint32_t>(std::atoi(argv[++i]));
+		}
+		else if (!std::strcmp(argv[i], "--batch") && HasValue)
+		{
+			Config.BatchTrajectories = static_cast<std::uint32_t>(std::atoi(argv[++i]));
+		}
+		else if (!std::strcmp(argv[i], "--updates") && HasValue)
+		{
+			Config.Updates = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (!std::strcmp(argv[i], "--algo") && HasValue)
+		{
+			Config.Update.Algo = std::strcmp(argv[++i], "a2c") ? Algorithm::PPO : Algorithm::A2C;
+		}
+		else
+		{
+			std::cout << "Usage : " << argv[0]
+				<< " [--actors N] [--envs N] [--batch N] [--updates N] [--algo ppo|a2c]\n";
+			return 1;
+		}
+	}
+
+	std::cout << (Config.Update.Algo == Algorithm::PPO ? "PPO" : "A2C")
+		<< ", " << Config.Actors << " actors x " << Config.EnvsPerActor << " envs, "
+		<< Config.BatchTrajectories * Trajectory::LENGTH << " steps per update\n\n";
+
+	ActorLearner Pipeline(Config);
+
+	Pipeline.SetProgress(50, [](const PolicyParams& Params, const PipelineStats& Stats)
+	{
+		std::cout << "Update " << Stats.Updates
+			<< " : Weight = " << Params.Values[PolicyParams::WEIGHT]
+			<< ", Bias = " << Params.Values[PolicyParams::BIAS]
+			<< ", Std = " << std::exp(Params.Values[PolicyParams::LOG_STD])
+			<< ", Return = " << Stats.RecentReturn
+			<< ", Lag = " << Stats.MeanLag << '\n';
+	});
+
+	const PipelineStats Stats = Pipeline.Run();
+
+	std::cout << '\n';
+	std::cout << "Env steps / sec = " << Stats.StepsPerSec << " (" << Stats.EnvSteps << " steps)\n";
+	std::cout << "Updates / sec = " << Stats.UpdatesPerSec << " (" << Stats.Updates << " updates)\n";
+	std::cout << "Policy lag = " << Stats.MeanLag << " updates on average, " << Stats.MaxLag << " at most\n";
+	std::cout << "Actor stalls = " << Stats.ActorStalls << ", Dropped reports = " << Stats.DroppedReports << '\n';
+	std::cout << '\n';
+
+	// The learned mean is a plain neuron again.
+	const PolicyParams& Params = Pipeline.GetParams();
+	Neuron MyNeuron(Params.Values[PolicyParams::WEIGHT], Params.Values[PolicyParams::BIAS]);
+
+	std::cout << "Target at 1.0 = " << TargetEnv::GetTarget(1.0) << '\n';
+	MyNeuron.PrintFeedForward(1.0);
+	return 0;
+}
+
+// Trains the single-neuron regression with evolution strategies instead of
+// PropBackward, then times the same run for every thread count.
+int RunEvolution(int argc, char* argv[])
+{
+	EsConfig Config;
+	std::uint64_t Generations = 300;
+	std::size_t Samples = 256;
+
+	for (int i = 2; i < argc; ++i)
+	{
+		const bool HasValue = i + 1 < argc;
+
+		if (!std::strcmp(argv[i], "--threads") && HasValue)
+		{
+			Config.Threads = static_cast<std::uint32_t>(std::atoi(argv[++i]));
+		}
+		else if (!std::strcmp(argv[i], "--population") && HasValue)
+		{
+			Config.Population = static_cast<std::uint32_t>(std::atoi(argv[++i]));
+		}
+		else if (!std::strcmp(argv[i], "--generations") && HasValue)
+		{
+			Generations = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (!std::strcmp(argv[i], "--samples") && HasValue)
+		{
+			Samples = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+		}
+		else
+		{
+			std::cout << "Usage : " << argv[0]
+				<< " --es [--threads N] [--population N] [--generations N] [--samples N]\n";
+			return 1;
+		}
+	}
+
+	std::vector<double> Inputs(Samples), Targets(Samples);
+
+	for (std::size_t i = 0; i < Samples; ++i)
+	{
+		Inputs[i] = (i + 0.5) / Samples;
+		Targets[i] = TargetEnv::GetTarget(Inputs[i]);
+	}
+
+	const std::uint32_t MaxThreads = std::max({ 1u, std::thread::hardware_concurrency(), Config.Threads });
+
+	// FeedForward writes into the neuron, so each worker gets its own line.
+	struct alignas(CACHE_LINE) WorkerNeuron
+	{
+		Neuron Unit;
+	};
+	std::vector<WorkerNeuron> Neurons(MaxThreads);
+
+	// Negative mean squared error of one neuron per worker thread.
+	auto Fitness = [&](const double* Params, const std::size_t&, const std::uint32_t& Worker)
+	{
+		Neuron& Unit = Neurons[Worker].Unit;
+		Unit.SetWeight(Params[0]);
+		Unit.SetBias(Params[1]);
+
+		double Error = 0.0;
+
+		for (std::size_t i = 0; i < Samples; ++i)
+		{
+			const double Delta = Unit.FeedForward(Inputs[i]) - Targets[i];
+			Error += Delta * Delta;
+		}
+		return -Error / Samples;
+	};
+
+	{
+		EvolutionStrategy Trainer(Config, { 2.0, 1.0 }, Fitness);
+
+		std::cout << "ES, population " << Trainer.GetPopulation() << ", "
+			<< Trainer.GetThreadCount() << " threads, " << Samples << " samples\n\n";
+
+		for (std::uint64_t Generation = 1; Generation <= Generations; ++Generation)
+		{
+			const GenerationStats Stats = Trainer.Step();
+
+			if (Generation % 50 == 0 || Generation == Generations)
+			{
+				std::cout << "Generation " << Generation
+					<< " : Weight = " << Trainer.GetParams()[0]
+					<< ", Bias = " << Trainer.GetParams()[1]
+					<< ", Mean fitness = " << Stats.MeanFitness
+					<< ", Best fitness = " << Stats.BestFitness << '\n';
+			}
+		}
+	}
+
+	std::vector<std::uint32_t> ThreadCounts;
+
+	for (std::uint32_t Count = 1; Count < MaxThreads; Count *= 2)
+	{
+		ThreadCounts.push_back(Count);
+	}
+	ThreadCounts.push_back(MaxThreads);
+
+	std::cout << "\nthreads  generations/sec  evals/sec  speedup\n";
+
+	double Base = 0.0;
+
+	for (const std::uint32_t& Count : ThreadCounts)
+	{
+		EsConfig Timed = Config;
+		Timed.Threads = Count;
+
+		EvolutionStrategy Trainer(Timed, { 2.0, 1.0 }, Fitness);
+		Trainer.Step();
 
-		std::cout << '\n';
+		const auto Start = std::chrono::steady_clock::now();
 
-		std::cout << "Now Weight = " << MyNeuron.GetWeight() << '\n';
-		std::cout << "Now Bias = " << MyNeuron.GetBias() << '\n';
+		for (std::uint64_t Generation = 0; Generation < Generations; ++Generation)
+		{
+			Trainer.Step();
+		}
 
-		std::cout << '\n';
+		const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		const double Rate = Generations / Seconds;
+
+		Base = Base > 0.0 ? Base : Rate;
+
+		std::cout << std::setw(7) << Trainer.GetThreadCount()
+			<< std::setw(17) << std::fixed << std::setprecision(1) << Rate
+			<< std::setw(11) << std::setprecision(0) << Rate * Trainer.GetPopulation()
+			<< std::setw(9) << std::setprecision(2) << Rate / Base << '\n';
 	}
+	std::cout << std::defaultfloat << '\n';
 	return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && !std::strcmp(argv[1], "--es"))
+	{
+		return RunEvolution(argc, argv);
+	}
+	return RunActorLearner(argc, argv);
+}
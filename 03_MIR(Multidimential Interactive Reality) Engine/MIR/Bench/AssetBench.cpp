@@ -0,0 +1,623 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+// Builds a tiled terrain scene as OBJ, converts it to .mira, and compares
+// cold / warm loads of the text file against the mapped asset. Then walks a
+// viewer across the tiles with the streaming loader.
+//
+//   AssetBench [--verify] [--grid N] [--cells N] [--dir Path]
+//   AssetBench --convert Scene.obj Scene.mira
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../MIR/AssetStreamer.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	double Millis(std::chrono::steady_clock::time_point Start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+	// Drops the file from the page cache so the next read goes to the disk.
+	bool DropCache(const std::string& Path)
+	{
+#ifdef __linux__
+		int File = ::open(Path.c_str(), O_RDONLY);
+
+		if (File < 0)
+		{
+			return false;
+		}
+
+		bool IsOk = ::fdatasync(File) == 0 && ::posix_fadvise(File, 0, 0, POSIX_FADV_DONTNEED) == 0;
+		::close(File);
+		return IsOk;
+#else
+		(void)Path;
+		return false;
+#endif
+	}
+
+	double GetMegabytes(const std::string& Path)
+	{
+		std::FILE* File = std::fopen(Path.c_str(), "rb");
+
+		if (File == nullptr)
+		{
+			return 0.0;
+		}
+
+		std::fseek(File, 0, SEEK_END);
+		double Size = static_cast<double>(std::ftell(File));
+		std::fclose(File);
+		return Size / (1024.0 * 1024.0);
+	}
+
+	std::vector<char> ReadBytes(const std::string& Path)
+	{
+		std::vector<char> Bytes;
+		std::FILE* File = std::fopen(Path.c_str(), "rb");
+		char Buffer[4096];
+		std::size_t Read;
+
+		while (File != nullptr && (Read = std::fread(Buffer, 1, sizeof(Buffer), File)) > 0)
+		{
+			Bytes.insert(Bytes.end(), Buffer, Buffer + Read);
+		}
+
+		if (File != nullptr)
+		{
+			std::fclose(File);
+		}
+		return Bytes;
+	}
+
+	// Grid x Grid terrain tiles, one OBJ object each, with normals.
+	bool WriteTerrainObj(const std::string& Path, int Grid, int Cells, float TileSize)
+	{
+		std::FILE* File = std::fopen(Path.c_str(), "w");
+
+		if (File == nullptr)
+		{
+			return false;
+		}
+
+		std::fprintf(File, "# AssetBench terrain, %d x %d tiles of %d x %d cells\n", Grid, Grid, Cells, Cells);
+		long Base = 1;
+
+		for (int TileZ = 0; TileZ < Grid; ++TileZ)
+		{
+			for (int TileX = 0; TileX < Grid; ++TileX)
+			{
+				std::fprintf(File, "o tile_%d_%d\n", TileX, TileZ);
+
+				for (int Z = 0; Z <= Cells; ++Z)
+				{
+					for (int X = 0; X <= Cells; ++X)
+					{
+						float U = TileX + static_cast<float>(X) / Cells, V = TileZ + static_cast<float>(Z) / Cells;
+						float Height = 2.f * Math::Sin(1.3f * U) * Math::Cos(1.7f * V) + 0.4f * Math::Sin(5.1f * U + 3.3f * V);
+						float Dx = 2.6f * Math::Cos(1.3f * U) * Math::Cos(1.7f * V) + 2.04f * Math::Cos(5.1f * U + 3.3f * V);
+						float Dz = -3.4f * Math::Sin(1.3f * U) * Math::Sin(1.7f * V) + 1.32f * Math::Cos(5.1f * U + 3.3f * V);
+						Vector3 Normal = Vector3::Norm(Vector3(-Dx / TileSize, 1.f, -Dz / TileSize));
+
+						std::fprintf(File, "v %.6f %.6f %.6f\n", U * TileSize, Height, V * TileSize);
+						std::fprintf(File, "vn %.6f %.6f %.6f\n", Normal.X, Normal.Y, Normal.Z);
+					}
+				}
+
+				for (int Z = 0; Z < Cells; ++Z)
+				{
+					for (int X = 0; X < Cells; ++X)
+					{
+						long I = Base + Z * (Cells + 1) + X, J = I + Cells + 1;
+						std::fprintf(File, "f %ld//%ld %ld//%ld %ld//%ld %ld//%ld\n", I, I, J, J, J + 1, J + 1, I + 1, I + 1);
+					}
+				}
+				Base += static_cast<long>(Cells + 1) * (Cells + 1);
+			}
+		}
+		return std::fclose(File) == 0;
+	}
+
+	// Reads every byte of every mesh the way a renderer would on first use.
+	double Touch(const Asset::SceneFile& Scene)
+	{
+		double Sum = 0.0;
+
+		for (std::uint32_t m = 0; m < Scene.GetMeshCount(); ++m)
+		{
+			const Asset::MeshRecord& Mesh = Scene.GetMesh(m);
+
+			for (std::uint32_t v = 0; v < Mesh.VertexCount; ++v)
+			{
+				Sum += Mesh.PositionX.Ptr[v] + Mesh.PositionY.Ptr[v] + Mesh.PositionZ.Ptr[v] + Mesh.NormalY.Ptr[v];
+			}
+
+			for (std::uint32_t i = 0; i < 3 * Mesh.TriangleCount; ++i)
+			{
+				Sum += Mesh.Indices.Ptr[i];
+			}
+
+			for (std::uint32_t n = 0; n < Mesh.BvhNodeCount; ++n)
+			{
+				Sum += Mesh.BvhNodes.Ptr[n].MinX[0];
+			}
+
+			for (std::uint32_t b = 0; b < Mesh.BvhBlockCount; ++b)
+			{
+				Sum += Mesh.BvhBlocks.Ptr[b].V0X[0];
+			}
+		}
+		return Sum;
+	}
+
+	bool SameMesh(const Asset::MeshRecord& Mesh, const Asset::ObjMesh& Source)
+	{
+		if (Mesh.VertexCount != Source.Positions.size() || 3 * static_cast<std::size_t>(Mesh.TriangleCount) != Source.Indices.size())
+		{
+			return false;
+		}
+
+		for (std::uint32_t v = 0; v < Mesh.VertexCount; ++v)
+		{
+			if ((Mesh.GetPosition(v) - Source.Positions[v]).Square() != 0.f
+				|| (!Source.Normals.empty() && (Mesh.GetNormal(v) - Source.Normals[v]).Square() != 0.f))
+			{
+				return false;
+			}
+		}
+		return std::memcmp(Mesh.Indices.Ptr, Source.Indices.data(), sizeof(std::uint32_t) * Source.Indices.size()) == 0;
+	}
+
+	int Verify(const std::string& Dir)
+	{
+		int Failures = 0;
+		auto Check = [&Failures](bool Condition, const char* What)
+		{
+			if (!Condition)
+			{
+				std::cout << "  failed : " << What << '\n';
+				++Failures;
+			}
+		};
+
+		// Parser corner cases: comments, groups, quads, v/vt/vn and negative indices.
+		std::string Small = Dir + "/asset_verify_small.obj";
+		std::FILE* File = std::fopen(Small.c_str(), "w");
+		std::fputs("# test\nv 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0 0\nvn 0 0 1\n"
+			"g quad\nf 1/1/1 2/1/1 3/1/1 4/1/1\n"
+			"o tri\r\nf -4 -3 -2\n", File);
+		std::fclose(File);
+
+		std::vector<Asset::ObjMesh> Parsed;
+		Check(Asset::LoadObj(Small.c_str(), Parsed) && Parsed.size() == 2, "obj groups");
+
+		if (Parsed.size() == 2)
+		{
+			Check(Parsed[0].Name == "quad" && Parsed[0].Positions.size() == 4 && Parsed[0].Indices.size() == 6, "obj quad");
+			Check(Parsed[0].Normals.size() == 4 && Parsed[0].Normals[2].Z == 1.f, "obj normals");
+			Check(Parsed[1].Name == "tri" && Parsed[1].Positions.size() == 3 && Parsed[1].Normals.empty(), "obj negative indices");
+			Check(Parsed[1].Positions[2].Y == 1.f, "obj positions");
+		}
+
+		// Round trip: every mesh of the mapped file matches the parsed OBJ.
+		std::string Obj = Dir + "/asset_verify.obj", Mira = Dir + "/asset_verify.mira";
+		Check(WriteTerrainObj(Obj, 3, 8, 4.f), "write obj");
+		Check(Asset::ConvertObj(Obj.c_str(), Mira.c_str()), "convert");
+
+		std::vector<Asset::ObjMesh> Source;
+		Asset::LoadObj(Obj.c_str(), Source);
+
+		Asset::SceneFile Scene;
+		Check(Scene.Open(Mira.c_str()) && Scene.GetMeshCount() == Source.size() && Scene.GetNodeCount() == Source.size(), "open mapped");
+
+		for (std::uint32_t m = 0; Scene.IsOpen() && m < Scene.GetMeshCount(); ++m)
+		{
+			const Asset::MeshRecord& Mesh = Scene.GetMesh(m);
+			Check(SameMesh(Mesh, Source[m]), "mapped mesh data");
+
+			// The stored tree answers exactly like a freshly built one.
+			RayTrace::Bvh Stored, Built;
+			Mesh.AttachBvh(Stored);
+			Built.Build(Source[m].Positions.data(), Source[m].Indices.data(), Source[m].Indices.size() / 3);
+
+			int Mismatch = 0;
+
+			for (int r = 0; r < 500; ++r)
+			{
+				RayTrace::Ray R;
+				R.Origin = Mesh.Bounds.GetCenter() + Vector3(Math::Random(-4.f, 4.f), 6.f, Math::Random(-4.f, 4.f));
+				R.Dir = Vector3::Norm(Vector3(Math::Random(-0.5f, 0.5f), -1.f, Math::Random(-0.5f, 0.5f)));
+
+				RayTrace::Hit A, B;
+				bool HitA = Stored.Intersect(R, A), HitB = Built.Intersect(R, B);
+				Mismatch += (HitA != HitB || A.Triangle != B.Triangle || A.T != B.T) ? 1 : 0;
+			}
+			Check(Mismatch == 0, "mapped bvh");
+		}
+
+		// Streaming: everything resident near the scene, everything gone far away.
+		{
+			Asset::StreamConfig Config;
+			Config.LoadRadius = 1000.f;
+			Config.UnloadRadius = 1001.f;
+
+			Asset::Streamer Stream(Config);
+			Check(Stream.Open(Mira.c_str()), "open stream");
+
+			Stream.Update(Stream.GetBounds().GetCenter());
+			Stream.WaitIdle();
+
+			for (std::uint32_t m = 0; m < Stream.GetMeshCount(); ++m)
+			{
+				const Asset::MeshRecord* Mesh = Stream.GetMesh(m);
+				Check(Mesh != nullptr && m < Source.size() && SameMesh(*Mesh, Source[m]), "streamed mesh data");
+			}
+
+			Stream.Update(Vector3(1.0e5f, 0.f, 0.f));
+			Asset::StreamStats Stats = Stream.GetStats();
+			Check(Stats.ResidentMeshes == 0 && Stats.Evictions == Stream.GetMeshCount() && Stats.Failures == 0, "stream eviction");
+		}
+
+		// Node transforms: World = Local * parent World, bounds follow.
+		{
+			Asset::SceneWriter Writer;
+			Vector3 Tri[3] = { Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(0, 1, 0) };
+			std::uint32_t Indices[3] = { 0, 1, 2 };
+
+			std::uint32_t Mesh = Writer.AddMesh(Tri, nullptr, 3, Indices, 1);
+			std::uint32_t Root = Writer.AddNode(Matrix4::CreateTranslation(Vector3(10.f, 0.f, 0.f)), Asset::NO_MESH);
+			Writer.AddNode(Matrix4::CreateScale(2.f) * Matrix4::CreateTranslation(Vector3(0.f, 5.f, 0.f)), Mesh, Root);
+
+			std::string Path = Dir + "/asset_verify_nodes.mira";
+			Check(Writer.Write(Path.c_str()), "write nodes");
+
+			Asset::SceneFile Nodes;
+			Check(Nodes.Open(Path.c_str()) && Nodes.GetNodeCount() == 2, "open nodes");
+
+			if (Nodes.IsOpen() && Nodes.GetNodeCount() == 2)
+			{
+				const Asset::NodeRecord& Child = Nodes.GetNode(1);
+				Vector3 Corner = Vector3::Transform(Vector3(1.f, 0.f, 0.f), Child.World);
+
+				Check((Corner - Vector3(12.f, 5.f, 0.f)).Square() < 1e-8f, "world transform");
+				Check((Child.Bounds.Max - Vector3(12.f, 7.f, 0.f)).Square() < 1e-8f && Child.Parent == 0, "world bounds");
+				Check(Nodes.GetMesh(0).NormalZ.Ptr[0] == 1.f, "computed normals");
+			}
+		}
+
+		// Damaged files are rejected instead of being dereferenced.
+		{
+			std::vector<char> Bytes = ReadBytes(Mira);
+			std::string Broken = Dir + "/asset_verify_broken.mira";
+			Asset::SceneFile Damaged;
+			Asset::Streamer Stream;
+
+			File = std::fopen(Broken.c_str(), "wb");
+			std::fwrite(Bytes.data(), 1, Bytes.size() / 2, File);
+			std::fclose(File);
+			Check(!Damaged.Open(Broken.c_str()) && !Stream.Open(Broken.c_str()), "truncated file");
+
+			// Writes a copy of Source after Damage has edited the first mesh record
+			// and its chunk, still in file form (offsets, not pointers). Layout
+			// damage is also caught by the streamer, which checks chunks only on load.
+			auto Corrupt = [&](const std::vector<char>& Source, const char* What, bool Layout, auto&& Damage)
+			{
+				std::vector<char> Copy = Source;
+				Asset::FileHeader* Header = reinterpret_cast<Asset::FileHeader*>(Copy.data());
+				Asset::MeshRecord* Mesh = reinterpret_cast<Asset::MeshRecord*>(Copy.data() + Header->Meshes.Offset);
+				Damage(*Header, *Mesh, Copy.data() + Mesh->ChunkOffset);
+
+				File = std::fopen(Broken.c_str(), "wb");
+				std::fwrite(Copy.data(), 1, Copy.size(), File);
+				std::fclose(File);
+				Check(!Damaged.Open(Broken.c_str()) && (!Layout || !Stream.Open(Broken.c_str())), What);
+			};
+
+			Corrupt(Bytes, "table out of range", true, [&](Asset::FileHeader& Header, Asset::MeshRecord&, char*)
+			{
+				Header.Meshes.Offset = Bytes.size() - 8;
+			});
+
+			Corrupt(Bytes, "chunk overlaps table", true, [](Asset::FileHeader& Header, Asset::MeshRecord& Mesh, char*)
+			{
+				Mesh.ChunkOffset = Header.Nodes.Offset / Asset::CHUNK_ALIGN * Asset::CHUNK_ALIGN;
+			});
+
+			Corrupt(Bytes, "chunks overlap", true, [](Asset::FileHeader&, Asset::MeshRecord& Mesh, char*)
+			{
+				(&Mesh)[1].ChunkOffset = Mesh.ChunkOffset;
+			});
+
+			Corrupt(Bytes, "index out of range", false, [](Asset::FileHeader&, Asset::MeshRecord& Mesh, char* Chunk)
+			{
+				reinterpret_cast<std::uint32_t*>(Chunk + Mesh.Indices.Offset)[1] = Mesh.VertexCount;
+			});
+
+			Corrupt(Bytes, "bvh node out of range", false, [](Asset::FileHeader&, Asset::MeshRecord& Mesh, char* Chunk)
+			{
+				reinterpret_cast<RayTrace::Bvh::Node*>(Chunk + Mesh.BvhNodes.Offset)[0].Child[0] = Mesh.BvhNodeCount;
+			});
+
+			Corrupt(Bytes, "bvh cycle", false, [](Asset::FileHeader&, Asset::MeshRecord& Mesh, char* Chunk)
+			{
+				reinterpret_cast<RayTrace::Bvh::Node*>(Chunk + Mesh.BvhNodes.Offset)[0].Child[0] = 0;
+			});
+
+			Corrupt(Bytes, "bvh leaf out of range", false, [](Asset::FileHeader&, Asset::MeshRecord& Mesh, char* Chunk)
+			{
+				RayTrace::Bvh::Node& Root = reinterpret_cast<RayTrace::Bvh::Node*>(Chunk + Mesh.BvhNodes.Offset)[0];
+				Root.Child[0] = RayTrace::Bvh::LEAF | (Mesh.BvhBlockCount - 1);
+				Root.Count[0] = 2;
+			});
+
+			Corrupt(Bytes, "triangle id out of range", false, [](Asset::FileHeader&, Asset::MeshRecord& Mesh, char* Chunk)
+			{
+				reinterpret_cast<RayTrace::Bvh::TriangleBlock*>(Chunk + Mesh.BvhBlocks.Offset)[0].Id[0] = Mesh.TriangleCount;
+			});
+
+			// A well-formed tree too deep for the traversal stack: every node of a
+			// large mesh relinked into one chain.
+			std::vector<Vector3> Positions;
+			std::vector<std::uint32_t> Indices;
+			const std::uint32_t Side = 64;
+
+			for (std::uint32_t i = 0; i <= Side; ++i)
+			{
+				for (std::uint32_t j = 0; j <= Side; ++j)
+				{
+					Positions.push_back(Vector3(static_cast<float>(j), Math::Random(0.f, 1.f), static_cast<float>(i)));
+				}
+			}
+
+			for (std::uint32_t i = 0; i < Side; ++i)
+			{
+				for (std::uint32_t j = 0; j < Side; ++j)
+				{
+					std::uint32_t V = i * (Side + 1) + j;
+					Indices.insert(Indices.end(), { V, V + 1, V + Side + 1, V + 1, V + Side + 2, V + Side + 1 });
+				}
+			}
+
+			Asset::SceneWriter Writer;
+			Writer.AddNode(Matrix4::Identity, Writer.AddMesh(Positions.data(), nullptr, Positions.size(), Indices.data(), Indices.size() / 3));
+			Check(Writer.Write(Broken.c_str()) && Damaged.Open(Broken.c_str()), "open large mesh");
+
+			bool IsLarge = Damaged.IsOpen() && Damaged.GetMesh(0).BvhNodeCount > RayTrace::Bvh::MAX_DEPTH;
+			Check(IsLarge, "large mesh node count");
+			Damaged.Close();
+
+			if (IsLarge)
+			{
+				Corrupt(ReadBytes(Broken), "bvh too deep", false, [](Asset::FileHeader&, Asset::MeshRecord& Mesh, char* Chunk)
+				{
+					RayTrace::Bvh::Node* Nodes = reinterpret_cast<RayTrace::Bvh::Node*>(Chunk + Mesh.BvhNodes.Offset);
+
+					for (std::uint32_t n = 0; n < Mesh.BvhNodeCount; ++n)
+					{
+						Nodes[n].Child[0] = n + 1 < Mesh.BvhNodeCount ? n + 1 : RayTrace::Bvh::LEAF;
+						Nodes[n].Count[0] = 1;
+					}
+				});
+			}
+
+			std::remove(Broken.c_str());
+		}
+
+		std::remove(Small.c_str());
+		std::remove(Obj.c_str());
+		std::remove(Mira.c_str());
+		std::remove((Dir + "/asset_verify_nodes.mira").c_str());
+
+		std::cout << "Reference checks : " << (Failures == 0 ? "passed" : "FAILED") << " (" << Failures << " failures)\n\n";
+		return Failures;
+	}
+
+	void BenchLoads(const std::string& Obj, const std::string& Mira)
+	{
+		bool CanDrop = DropCache(Obj) && DropCache(Mira);
+		std::cout << (CanDrop ? "" : "(page cache cannot be dropped here; cold numbers are warm)\n");
+
+		std::vector<Asset::ObjMesh> Parsed;
+		Asset::SceneFile Scene;
+		volatile double Sink = 0.0;
+
+		auto Start = std::chrono::steady_clock::now();
+		Asset::LoadObj(Obj.c_str(), Parsed);
+		double ColdText = Millis(Start);
+
+		DropCache(Mira);
+		Start = std::chrono::steady_clock::now();
+		Scene.Open(Mira.c_str());
+		double ColdOpen = Millis(Start);
+		Sink = Sink + Touch(Scene);
+		double ColdTotal = Millis(Start);
+		Scene.Close();
+
+		double WarmText = 1.0e30, WarmOpen = 1.0e30, WarmTotal = 1.0e30;
+
+		for (int Run = 0; Run < 5; ++Run)
+		{
+			Start = std::chrono::steady_clock::now();
+			Asset::LoadObj(Obj.c_str(), Parsed);
+			WarmText = Math::Min(WarmText, Millis(Start));
+
+			Start = std::chrono::steady_clock::now();
+			Scene.Open(Mira.c_str());
+			WarmOpen = Math::Min(WarmOpen, Millis(Start));
+			Sink = Sink + Touch(Scene);
+			WarmTotal = Math::Min(WarmTotal, Millis(Start));
+			Scene.Close();
+		}
+
+		std::printf("%-26s %12s %12s\n", "load", "cold ms", "warm ms");
+		std::printf("%-26s %12.2f %12.2f\n", "obj text parse", ColdText, WarmText);
+		std::printf("%-26s %12.3f %12.3f\n", "mira map + fixup", ColdOpen, WarmOpen);
+		std::printf("%-26s %12.2f %12.2f\n", "mira map + touch all", ColdTotal, WarmTotal);
+		std::printf("speedup (touch all, warm)  : %.0fx\n\n", WarmText / WarmTotal);
+	}
+
+	void BenchStreaming(const std::string& Mira, float Extent)
+	{
+		DropCache(Mira);
+
+		Asset::StreamConfig Config;
+		Config.LoadRadius = 0.2f * Extent;
+		Config.UnloadRadius = 0.3f * Extent;
+
+		Asset::Streamer Stream(Config);
+
+		if (!Stream.Open(Mira.c_str()))
+		{
+			std::cout << "cannot open " << Mira << '\n';
+			return;
+		}
+
+		const RayTrace::Aabb& Bounds = Stream.GetBounds();
+		const int Frames = 240;
+
+		double UpdateMs = 0.0;
+		std::uint32_t PeakResident = 0, MissingNear = 0;
+
+		for (int Frame = 0; Frame < Frames; ++Frame)
+		{
+			float T = static_cast<float>(Frame) / (Frames - 1);
+			Vector3 Viewer = Bounds.Min + T * (Bounds.Max - Bounds.Min);
+			Viewer.Y = Bounds.Max.Y + 2.f;
+
+			auto Start = std::chrono::steady_clock::now();
+			Stream.Update(Viewer);
+			UpdateMs += Millis(Start);
+
+			// Meshes right under the viewer that are not in yet (streaming latency).
+			for (std::uint32_t n = 0; n < Stream.GetNodeCount(); ++n)
+			{
+				const Asset::NodeRecord& Node = Stream.GetNode(n);
+
+				if (Node.Mesh != Asset::NO_MESH && Stream.GetMesh(Node.Mesh) == nullptr
+					&& (Node.Bounds.GetCenter() - Viewer).Square() < 0.01f * Extent * Extent)
+				{
+					++MissingNear;
+				}
+			}
+
+			PeakResident = Math::Max(PeakResident, Stream.GetStats().ResidentMeshes);
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+		Stream.WaitIdle();
+
+		Asset::StreamStats Stats = Stream.GetStats();
+
+		std::printf("streaming walk, %d frames, radius %.0f / %.0f, %u meshes\n", Frames, Config.LoadRadius, Config.UnloadRadius, Stream.GetMeshCount());
+		std::printf("  loads %llu, evictions %llu, cancels %llu, failures %llu\n",
+			static_cast<unsigned long long>(Stats.Loads), static_cast<unsigned long long>(Stats.Evictions),
+			static_cast<unsigned long long>(Stats.Cancels), static_cast<unsigned long long>(Stats.Failures));
+		std::printf("  read %.1f MB, chunk load avg %.3f ms / max %.3f ms\n", Stats.BytesRead / (1024.0 * 1024.0),
+			Stats.Loads > 0 ? Stats.TotalLoadMs / Stats.Loads : 0.0, Stats.MaxLoadMs);
+		std::printf("  Update() avg %.3f ms, peak resident %u meshes, near misses %u\n\n", UpdateMs / Frames, PeakResident, MissingNear);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	bool VerifyOnly = false;
+	int Grid = 8, Cells = 64;
+	std::string Dir = ".";
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--verify"))
+		{
+			VerifyOnly = true;
+		}
+		else if (!std::strcmp(argv[i], "--convert") && i + 2 < argc)
+		{
+			bool IsOk = Asset::ConvertObj(argv[i + 1], argv[i + 2]);
+			std::cout << (IsOk ? "wrote " : "cannot convert to ") << argv[i + 2] << '\n';
+			return IsOk ? 0 : 1;
+		}
+		else if (!std::strcmp(argv[i], "--grid") && i + 1 < argc)
+		{
+			Grid = Math::Max(1, std::atoi(argv[++i]));
+		}
+		else if (!std::strcmp(argv[i], "--cells") && i + 1 < argc)
+		{
+			Cells = Math::Max(1, std::atoi(argv[++i]));
+		}
+		else if (!std::strcmp(argv[i], "--dir") && i + 1 < argc)
+		{
+			Dir = argv[++i];
+		}
+		else
+		{
+			std::cout << "Usage : AssetBench [--verify] [--grid N] [--cells N] [--dir Path]\n"
+				<< "        AssetBench --convert Scene.obj Scene.mira\n";
+			return 1;
+		}
+	}
+
+	Math::SeedRandom(7);
+
+	if (Verify(Dir) != 0)
+	{
+		return 1;
+	}
+
+	if (VerifyOnly)
+	{
+		return 0;
+	}
+
+	const float TileSize = 16.f;
+	std::string Obj = Dir + "/asset_bench.obj", Mira = Dir + "/asset_bench.mira";
+
+	if (!WriteTerrainObj(Obj, Grid, Cells, TileSize))
+	{
+		std::cout << "cannot write " << Obj << '\n';
+		return 1;
+	}
+
+	auto Start = std::chrono::steady_clock::now();
+	bool IsConverted = Asset::ConvertObj(Obj.c_str(), Mira.c_str());
+	double ConvertMs = Millis(Start);
+
+	if (!IsConverted)
+	{
+		std::cout << "cannot convert " << Obj << '\n';
+		return 1;
+	}
+
+	Asset::SceneFile Scene;
+	Scene.Open(Mira.c_str());
+
+	std::size_t Triangles = 0;
+
+	for (std::uint32_t m = 0; m < Scene.GetMeshCount(); ++m)
+	{
+		Triangles += Scene.GetMesh(m).TriangleCount;
+	}
+
+	std::printf("%d x %d tiles, %zu triangles, obj %.1f MB -> mira %.1f MB, convert %.0f ms (incl. BVH build)\n\n",
+		Grid, Grid, Triangles, GetMegabytes(Obj), Scene.GetFileSize() / (1024.0 * 1024.0), ConvertMs);
+	Scene.Close();
+
+	BenchLoads(Obj, Mira);
+	BenchStreaming(Mira, Grid * TileSize);
+
+	std::remove(Obj.c_str());
+	std::remove(Mira.c_str());
+	return 0;
+}
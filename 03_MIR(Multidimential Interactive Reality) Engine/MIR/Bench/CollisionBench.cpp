@@ -0,0 +1,504 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+// Narrowphase correctness against brute-force references, then pairs/sec for
+// each routine. Exits non-zero if any reference check fails.
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../MIR/Collision.h"
+
+namespace
+{
+	std::mt19937 Rng(1234);
+
+	float RandRange(float Lower, float Upper)
+	{
+		return std::uniform_real_distribution<float>(Lower, Upper)(Rng);
+	}
+
+	Vector3 RandVector(float Extent)
+	{
+		return Vector3(RandRange(-Extent, Extent), RandRange(-Extent, Extent), RandRange(-Extent, Extent));
+	}
+
+	Quaternion RandRotation()
+	{
+		Vector3 Axis = RandVector(1.f);
+
+		if (Axis.Square() < 1.0e-4f)
+		{
+			Axis = Vector3::UnitY;
+		}
+		return Quaternion(Vector3::Norm(Axis), RandRange(0.f, 2.f * Math::PI));
+	}
+
+	Vector3 ClosestOnTriangle(const Vector3& A, const Vector3& B, const Vector3& C)
+	{
+		Vector3 AB = B - A, AC = C - A;
+		float D1 = -Vector3::Dot(AB, A), D2 = -Vector3::Dot(AC, A);
+
+		if (D1 <= 0.f && D2 <= 0.f) return A;
+
+		float D3 = -Vector3::Dot(AB, B), D4 = -Vector3::Dot(AC, B);
+
+		if (D3 >= 0.f && D4 <= D3) return B;
+
+		float VC = D1 * D4 - D3 * D2;
+
+		if (VC <= 0.f && D1 >= 0.f && D3 <= 0.f) return A + (D1 / (D1 - D3)) * AB;
+
+		float D5 = -Vector3::Dot(AB, C), D6 = -Vector3::Dot(AC, C);
+
+		if (D6 >= 0.f && D5 <= D6) return C;
+
+		float VB = D5 * D2 - D1 * D6;
+
+		if (VB <= 0.f && D2 >= 0.f && D6 <= 0.f) return A + (D2 / (D2 - D6)) * AC;
+
+		float VA = D3 * D6 - D5 * D4;
+
+		if (VA <= 0.f && (D4 - D3) >= 0.f && (D5 - D6) >= 0.f) return B + ((D4 - D3) / ((D4 - D3) + (D5 - D6))) * (C - B);
+
+		float Den = 1.f / (VA + VB + VC);
+		return A + (VB * Den) * AB + (VC * Den) * AC;
+	}
+
+	struct Reference
+	{
+		bool Overlap;
+		float Distance;
+		float Depth;
+	};
+
+	// Enumerates every supporting plane of the Minkowski difference's hull. The
+	// origin is outside iff some plane has it strictly in front; the distance is
+	// the nearest supporting triangle; depth is the nearest plane from inside.
+	Reference BruteForce(const std::vector<Vector3>& A, const std::vector<Vector3>& B)
+	{
+		std::vector<Vector3> Diff;
+
+		for (const Vector3& Pa : A)
+		{
+			for (const Vector3& Pb : B)
+			{
+				Diff.push_back(Pa - Pb);
+			}
+		}
+
+		Reference Result = { true, Math::INF, Math::INF };
+		const float Eps = 1.0e-5f;
+
+		for (std::size_t i = 0; i < Diff.size(); ++i)
+		{
+			for (std::size_t j = i + 1; j < Diff.size(); ++j)
+			{
+				for (std::size_t k = j + 1; k < Diff.size(); ++k)
+				{
+					Vector3 Normal = Vector3::Cross(Diff[j] - Diff[i], Diff[k] - Diff[i]);
+
+					if (Normal.Square() < 1.0e-10f)
+					{
+						continue;
+					}
+
+					Normal.Norm();
+
+					bool Front = false, Back = false;
+
+					for (const Vector3& P : Diff)
+					{
+						float D = Vector3::Dot(Normal, P - Diff[i]);
+						Front |= D > Eps;
+						Back |= D < -Eps;
+					}
+
+					if (Front && Back)
+					{
+						continue;
+					}
+
+					if (Front)
+					{
+						Normal = -Normal;
+					}
+
+					float Plane = Vector3::Dot(Normal, Diff[i]);
+
+					if (Plane < 0.f)
+					{
+						Result.Overlap = false;
+					}
+
+					Result.Depth = Math::Min(Result.Depth, Plane);
+					Result.Distance = Math::Min(Result.Distance, ClosestOnTriangle(Diff[i], Diff[j], Diff[k]).Length());
+				}
+			}
+		}
+		return Result;
+	}
+
+	std::vector<Vector3> RandTetra(const Vector3& Center)
+	{
+		std::vector<Vector3> Temp;
+
+		for (short i = 0; i < 4; ++i)
+		{
+			Temp.push_back(Center + RandVector(1.f));
+		}
+		return Temp;
+	}
+
+	std::vector<Vector3> BoxCorners(const Collision::Collider& Box)
+	{
+		std::vector<Vector3> Temp;
+
+		for (short i = 0; i < 8; ++i)
+		{
+			Vector3 Local
+			(
+				(i & 1 ? 1.f : -1.f) * Box.HalfExtents.X,
+				(i & 2 ? 1.f : -1.f) * Box.HalfExtents.Y,
+				(i & 4 ? 1.f : -1.f) * Box.HalfExtents.Z
+			);
+			Temp.push_back(Box.Position + Vector3::Transform(Local, Box.Rotation));
+		}
+		return Temp;
+	}
+
+	int Failures = 0;
+
+	void Check(bool Condition, const char* What, int Case)
+	{
+		if (!Condition)
+		{
+			++Failures;
+
+			if (Failures <= 10)
+			{
+				std::cout << "  FAIL " << What << " (case " << Case << ")\n";
+			}
+		}
+	}
+
+	void VerifyGjkEpa()
+	{
+		const int Cases = 400;
+		Collision::ConvexHull HullA, HullB;
+
+		for (int c = 0; c < Cases; ++c)
+		{
+			std::vector<Vector3> A = RandTetra(Vector3::Zero);
+			std::vector<Vector3> B = RandTetra(RandVector(1.5f));
+
+			HullA.Set(A.data(), A.size());
+			HullB.Set(B.data(), B.size());
+
+			Collision::Collider Ca = Collision::Collider::MakeHull(Vector3::Zero, Quaternion::Identity, HullA);
+			Collision::Collider Cb = Collision::Collider::MakeHull(Vector3::Zero, Quaternion::Identity, HullB);
+
+			Reference Ref = BruteForce(A, B);
+			Collision::GjkResult Result = Collision::Gjk(Ca, Cb);
+
+			// Skip grazing cases where float round-off decides the answer.
+			if ((!Ref.Overlap && Ref.Distance < 1.0e-3f) || (Ref.Overlap && Ref.Depth < 1.0e-3f))
+			{
+				continue;
+			}
+
+			Check(Result.Overlap == Ref.Overlap, "GJK overlap", c);
+
+			if (!Ref.Overlap && !Result.Overlap)
+			{
+				Check(Math::Abs(Result.Distance - Ref.Distance) <= 1.0e-3f + 1.0e-3f * Ref.Distance, "GJK distance", c);
+				Check(Math::Abs((Result.PointA - Result.PointB).Length() - Ref.Distance) <= 2.0e-3f, "GJK witness points", c);
+				Check(Math::Abs((Result.PointA - Result.PointB).Length() - Result.Distance) <= 1.0e-4f, "GJK witness distance", c);
+			}
+
+			if (Ref.Overlap && Result.Overlap)
+			{
+				Collision::PenetrationResult Pen = Collision::Epa(Ca, Cb);
+				Check(Pen.Valid, "EPA valid", c);
+				Check(Math::Abs(Pen.Depth - Ref.Depth) <= 2.0e-3f + 1.0e-2f * Ref.Depth, "EPA depth", c);
+			}
+		}
+
+		// Dense point spheres drive EPA into its vertex, face and iteration
+		// limits; the answer must still be the face nearest the origin.
+		std::vector<Vector3> Ball;
+
+		for (int i = 0; i < 400; ++i)
+		{
+			float Y = 1.f - 2.f * (i + 0.5f) / 400.f, R = Math::Sqrt(1.f - Y * Y), Phi = 2.39996323f * i;
+			Ball.push_back(Vector3(R * Math::Cos(Phi), Y, R * Math::Sin(Phi)));
+		}
+		HullA.Set(Ball.data(), Ball.size());
+
+		for (int c = 0; c < 50; ++c)
+		{
+			Vector3 Dir = RandVector(1.f);
+
+			if (Dir.Square() < 1.0e-4f)
+			{
+				continue;
+			}
+
+			Dir = Vector3::Norm(Dir);
+			float Offset = Math::Random(0.3f, 1.6f);
+
+			Collision::Collider Ca = Collision::Collider::MakeHull(Vector3::Zero, RandRotation(), HullA);
+			Collision::Collider Cb = Collision::Collider::MakeHull(Offset * Dir, RandRotation(), HullA);
+			Collision::PenetrationResult Pen = Collision::Epa(Ca, Cb);
+
+			Check(Pen.Valid, "EPA dense valid", c);
+			Check(Pen.Depth <= 2.f - Offset + 1.0e-3f && Pen.Depth >= 0.95f * (2.f - Offset) - 0.02f, "EPA dense depth", c);
+			Check(Vector3::Dot(Pen.Normal, Dir) > 0.95f, "EPA dense normal", c);
+		}
+	}
+
+	void VerifyBoxBox()
+	{
+		const int Cases = 200;
+
+		for (int c = 0; c < Cases; ++c)
+		{
+			Collision::Collider A = Collision::Collider::MakeBox(Vector3::Zero, RandRotation(),
+				Vector3(RandRange(0.2f, 1.f), RandRange(0.2f, 1.f), RandRange(0.2f, 1.f)));
+			Collision::Collider B = Collision::Collider::MakeBox(RandVector(1.8f), RandRotation(),
+				Vector3(RandRange(0.2f, 1.f), RandRange(0.2f, 1.f), RandRange(0.2f, 1.f)));
+
+			Reference Ref = BruteForce(BoxCorners(A), BoxCorners(B));
+
+			if ((!Ref.Overlap && Ref.Distance < 1.0e-3f) || (Ref.Overlap && Ref.Depth < 1.0e-3f))
+			{
+				continue;
+			}
+
+			Collision::Manifold Sat;
+			bool Hit = Collision::SatBoxBox(A, B, Sat);
+
+			Check(Hit == Ref.Overlap, "SAT overlap", c);
+
+			if (Hit && Ref.Overlap)
+			{
+				Check(Sat.Count >= 1 && Sat.Count <= Collision::MAX_CONTACTS, "SAT contact count", c);
+
+				float MaxDepth = 0.f;
+
+				for (std::uint32_t i = 0; i < Sat.Count; ++i)
+				{
+					MaxDepth = Math::Max(MaxDepth, Sat.Points[i].Depth);
+				}
+
+				// Face axes are preferred within 5% + 1cm, so allow that much slack.
+				Check(MaxDepth >= Ref.Depth - 2.0e-3f && MaxDepth <= Ref.Depth / 0.95f + 0.02f, "SAT depth", c);
+				Check(Vector3::Dot(Sat.Normal, B.Position - A.Position) > -1.0e-3f, "SAT normal direction", c);
+			}
+		}
+	}
+
+	void VerifySpheres()
+	{
+		const int Cases = 400;
+
+		for (int c = 0; c < Cases; ++c)
+		{
+			Collision::Collider Sphere = Collision::Collider::MakeSphere(RandVector(1.5f), RandRange(0.1f, 0.8f));
+			Collision::Collider Box = Collision::Collider::MakeBox(Vector3::Zero, RandRotation(),
+				Vector3(RandRange(0.2f, 1.f), RandRange(0.2f, 1.f), RandRange(0.2f, 1.f)));
+
+			// Reference: clamp the centre into the box in box space.
+			Quaternion Inv = Box.Rotation;
+			Inv.Conjugate();
+
+			Vector3 Local = Vector3::Transform(Sphere.Position, Inv);
+			Vector3 Clamped
+			(
+				Math::Clamp(Local.X, -Box.HalfExtents.X, Box.HalfExtents.X),
+				Math::Clamp(Local.Y, -Box.HalfExtents.Y, Box.HalfExtents.Y),
+				Math::Clamp(Local.Z, -Box.HalfExtents.Z, Box.HalfExtents.Z)
+			);
+			float Dist = (Local - Clamped).Length();
+
+			if (Dist == 0.f || Math::Abs(Dist - Sphere.Radius) < 1.0e-3f)
+			{
+				continue;
+			}
+
+			Collision::Manifold Out;
+			bool Hit = Collision::Collide(Sphere, Box, Out);
+
+			Check(Hit == (Dist < Sphere.Radius), "sphere-box overlap", c);
+
+			if (Hit)
+			{
+				Check(Math::Abs(Out.Points[0].Depth - (Sphere.Radius - Dist)) <= 1.0e-3f, "sphere-box depth", c);
+			}
+
+			Collision::GjkResult Gjk = Collision::Gjk(Sphere, Box);
+			Check(Math::Abs(Gjk.Distance - Dist) <= 1.0e-3f, "GJK point-box distance", c);
+		}
+	}
+
+	void VerifyCache()
+	{
+		// A resting box on a box: impulses written into the cached manifold must
+		// come back on the next frame's matching points.
+		Collision::Collider Colliders[2] =
+		{
+			Collision::Collider::MakeBox(Vector3::Zero, Quaternion::Identity, Vector3(2.f, 0.5f, 2.f)),
+			Collision::Collider::MakeBox(Vector3(0.f, 0.95f, 0.f), Quaternion::Identity, Vector3(0.5f, 0.5f, 0.5f))
+		};
+		Collision::CollisionPair Pair = { 0, 1 };
+		Collision::ManifoldCache Cache;
+		Collision::Manifold Out;
+
+		Check(Collision::CollideBatch(Colliders, &Pair, 1, Cache, &Out) == 1, "cache first frame", 0);
+		Check(Out.Count == 4, "box-on-box manifold size", 0);
+
+		// Simulate the solver writing impulses back into the cache.
+		for (std::uint32_t i = 0; i < Out.Count; ++i)
+		{
+			Out.Points[i].NormalImpulse = 1.f + i;
+		}
+
+		Cache.Store(Out);
+		Cache.EndFrame();
+
+		Collision::Manifold Next;
+		Collision::CollideBatch(Colliders, &Pair, 1, Cache, &Next);
+
+		float Sum = 0.f;
+
+		for (std::uint32_t i = 0; i < Next.Count; ++i)
+		{
+			Sum += Next.Points[i].NormalImpulse;
+		}
+
+		Check(Sum == 10.f, "warm-start impulses", 0);
+
+		Cache.EndFrame();
+		Cache.EndFrame();
+		Check(Cache.GetSize() == 0, "stale pair eviction", 0);
+
+		// Every cached pair is one pool block, whatever the library's node type.
+		std::vector<Collision::Collider> Balls;
+		std::vector<Collision::CollisionPair> BallPairs;
+		std::vector<Collision::Manifold> BallOut(63);
+
+		for (std::uint32_t i = 0; i < 64; ++i)
+		{
+			Balls.push_back(Collision::Collider::MakeSphere(Vector3(0.1f * i, 0.f, 0.f), 10.f));
+			BallPairs.push_back({ 0, i });
+		}
+
+		std::size_t Pooled = Cache.GetPooledNodes();
+		Collision::CollideBatch(Balls.data(), BallPairs.data() + 1, 63, Cache, BallOut.data());
+		Check(Cache.GetSize() == 63 && Cache.GetPooledNodes() - Pooled == 63, "pooled cache nodes", 0);
+	}
+
+	template <typename Fn>
+	void Bench(const char* Name, std::size_t Pairs, Fn&& Body)
+	{
+		const int Repeat = 20;
+		auto Start = std::chrono::steady_clock::now();
+		std::size_t Hits = 0;
+
+		for (int r = 0; r < Repeat; ++r)
+		{
+			Hits += Body();
+		}
+
+		double Sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		std::cout << Name << " : " << (Pairs * Repeat) / Sec / 1.0e6 << " Mpairs/s ("
+			<< Hits / Repeat << '/' << Pairs << " touching)\n";
+	}
+
+	void RunBenchmarks()
+	{
+		const std::size_t Count = 1 << 14;
+
+		std::vector<Vector3> Points;
+
+		for (short i = 0; i < 32; ++i)
+		{
+			Points.push_back(Vector3::Norm(RandVector(1.f)));
+		}
+
+		Collision::ConvexHull Hull(Points.data(), Points.size());
+
+		std::vector<Collision::Collider> Spheres, Boxes, Hulls, Mixed;
+
+		for (std::size_t i = 0; i < Count * 2; ++i)
+		{
+			Vector3 Pos = RandVector(1.f) + Vector3(static_cast<float>(i / 2) * 4.f, 0.f, 0.f);
+
+			Spheres.push_back(Collision::Collider::MakeSphere(Pos, 0.8f));
+			Boxes.push_back(Collision::Collider::MakeBox(Pos, RandRotation(), Vector3(0.6f, 0.6f, 0.6f)));
+			Hulls.push_back(Collision::Collider::MakeHull(Pos, RandRotation(), Hull));
+
+			switch (i % 3)
+			{
+			case 0: Mixed.push_back(Spheres.back()); break;
+			case 1: Mixed.push_back(Boxes.back()); break;
+			default: Mixed.push_back(Hulls.back()); break;
+			}
+		}
+
+		std::vector<Collision::CollisionPair> Pairs(Count);
+
+		for (std::size_t i = 0; i < Count; ++i)
+		{
+			Pairs[i].A = static_cast<std::uint32_t>(2 * i);
+			Pairs[i].B = static_cast<std::uint32_t>(2 * i + 1);
+		}
+
+		Collision::Manifold Out;
+
+		auto Single = [&](const std::vector<Collision::Collider>& Set)
+		{
+			std::size_t Hits = 0;
+
+			for (const Collision::CollisionPair& Pair : Pairs)
+			{
+				Hits += Collision::Collide(Set[Pair.A], Set[Pair.B], Out) ? 1 : 0;
+			}
+			return Hits;
+		};
+
+		Bench("sphere-sphere      ", Count, [&]() { return Single(Spheres); });
+		Bench("box-box SAT        ", Count, [&]() { return Single(Boxes); });
+		Bench("hull-hull GJK/EPA  ", Count, [&]() { return Single(Hulls); });
+
+		std::vector<Collision::Manifold> Batch(Count);
+		Collision::ManifoldCache Cache(Count);
+
+		Bench("mixed batch + cache", Count, [&]()
+		{
+			std::size_t Hits = Collision::CollideBatch(Mixed.data(), Pairs.data(), Count, Cache, Batch.data());
+			Cache.EndFrame();
+			return Hits;
+		});
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	bool VerifyOnly = Argc > 1 && std::strcmp(Argv[1], "--verify") == 0;
+
+	VerifyGjkEpa();
+	VerifyBoxBox();
+	VerifySpheres();
+	VerifyCache();
+
+	std::cout << "Reference checks : " << (Failures == 0 ? "passed" : "FAILED") << " (" << Failures << " failures)\n\n";
+
+	if (!VerifyOnly)
+	{
+		RunBenchmarks();
+	}
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,584 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+// Times every operation in Math.h twice: "single" runs one call at a time on a
+// handful of L1-resident inputs, "batch" streams the call over arrays far larger
+// than L2. Reports ns/op, Mops/s and, where perf_event_open works, hardware
+// counters per op. Results can be saved as JSON and compared against a baseline.
+//
+//   MathBench [--filter Text] [--min-time Sec] [--repeat N] [--list]
+//             [--json Out.json] [--compare Baseline.json] [--threshold Percent]
+//
+// With --compare the exit code is 2 when any op got slower than the threshold.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "../MIR/Math.h"
+#include "../MIR/Memory.h"
+#include "PerfCounters.h"
+
+namespace
+{
+	const std::size_t HOT_COUNT = 64;
+	const std::size_t BATCH_COUNT = 1 << 16;
+
+	template <typename T>
+	inline void DoNotOptimize(const T& Value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r"(&Value) : "memory");
+#else
+		static const volatile void* Sink;
+		Sink = &Value;
+		_ReadWriteBarrier();
+#endif
+	}
+
+	inline void ClobberMemory()
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : : "memory");
+#else
+		_ReadWriteBarrier();
+#endif
+	}
+
+	class Cubic : public Calculas
+	{
+	public:
+		float Function(float X) override { return X * X * X - 2.f * X; }
+	};
+
+	struct Inputs
+	{
+		std::vector<float> S0, S1, Rate;
+		std::vector<Vector2> A2, B2, N2;
+		std::vector<Vector3> A3, B3, N3;
+		std::vector<Matrix3> M3a, M3b;
+		std::vector<Matrix4> M4a, M4b;
+		std::vector<Quaternion> Qa, Qb;
+
+		Cubic Curve;
+	};
+
+	Inputs gIn;
+	void* gOutput = nullptr;
+
+	Vector3 RandomUnit()
+	{
+		Vector3 Temp(Math::Random(-1.f, 1.f), Math::Random(-1.f, 1.f), Math::Random(-1.f, 1.f));
+		return Temp.Square() > 1.0e-4f ? Vector3::Norm(Temp) : Vector3::UnitX;
+	}
+
+	void FillInputs()
+	{
+		const std::size_t Count = BATCH_COUNT;
+
+		gIn.S0.resize(Count), gIn.S1.resize(Count), gIn.Rate.resize(Count);
+		gIn.A2.resize(Count), gIn.B2.resize(Count), gIn.N2.resize(Count);
+		gIn.A3.resize(Count), gIn.B3.resize(Count), gIn.N3.resize(Count);
+		gIn.M3a.resize(Count), gIn.M3b.resize(Count);
+		gIn.M4a.resize(Count), gIn.M4b.resize(Count);
+		gIn.Qa.resize(Count), gIn.Qb.resize(Count);
+
+		for (std::size_t i = 0; i < Count; ++i)
+		{
+			gIn.S0[i] = Math::Random(-0.99f, 0.99f);
+			gIn.S1[i] = Math::Random(0.5f, 4.f);
+			gIn.Rate[i] = Math::Random(0.f, 1.f);
+
+			gIn.A2[i].Set(Math::Random(-10.f, 10.f), Math::Random(-10.f, 10.f));
+			gIn.B2[i].Set(Math::Random(-10.f, 10.f), Math::Random(-10.f, 10.f));
+			gIn.N2[i] = Vector2::Norm(gIn.B2[i]);
+
+			gIn.A3[i].Set(Math::Random(-10.f, 10.f), Math::Random(-10.f, 10.f), Math::Random(-10.f, 10.f));
+			gIn.B3[i].Set(Math::Random(-10.f, 10.f), Math::Random(-10.f, 10.f), Math::Random(-10.f, 10.f));
+			gIn.N3[i] = RandomUnit();
+
+			gIn.Qa[i] = Quaternion(RandomUnit(), Math::Random(-Math::PI, Math::PI));
+			gIn.Qb[i] = Quaternion(RandomUnit(), Math::Random(-Math::PI, Math::PI));
+
+			gIn.M3a[i] = Matrix3::CreateScale(gIn.S1[i]) * Matrix3::CreateRotation(gIn.S0[i]) * Matrix3::CreateTranslation(gIn.A2[i]);
+			gIn.M3b[i] = Matrix3::CreateRotation(gIn.Rate[i]) * Matrix3::CreateTranslation(gIn.B2[i]);
+
+			gIn.M4a[i] = Matrix4::CreateScale(gIn.S1[i]) * Matrix4::CreateFromQuaternion(gIn.Qa[i]) * Matrix4::CreateTranslation(gIn.A3[i]);
+			gIn.M4b[i] = Matrix4::CreateFromQuaternion(gIn.Qb[i]) * Matrix4::CreateTranslation(gIn.B3[i]);
+		}
+
+		gOutput = Memory::HeapAlloc(BATCH_COUNT * sizeof(Matrix4), 64);
+	}
+
+	struct Case
+	{
+		std::string Name;
+		std::function<void(std::size_t)> Run;
+		std::size_t OpsPerRep;
+	};
+
+	// Registers Op(Index) as both a single-call and a batched case.
+	template <typename Fn>
+	void AddOp(std::vector<Case>& Cases, const std::string& Name, Fn Op)
+	{
+		using Result = decltype(Op(std::size_t()));
+		static_assert(std::is_trivially_copyable<Result>::value && sizeof(Result) <= sizeof(Matrix4), "Result must fit the output buffer");
+
+		Cases.push_back({ Name + "/single", [Op](std::size_t Reps)
+		{
+			for (std::size_t r = 0; r < Reps; ++r)
+			{
+				Result Value = Op(r & (HOT_COUNT - 1));
+				DoNotOptimize(Value);
+			}
+		}, 1 });
+
+		Cases.push_back({ Name + "/batch", [Op](std::size_t Reps)
+		{
+			Result* Out = static_cast<Result*>(gOutput);
+
+			for (std::size_t r = 0; r < Reps; ++r)
+			{
+				for (std::size_t i = 0; i < BATCH_COUNT; ++i)
+				{
+					Out[i] = Op(i);
+				}
+				ClobberMemory();
+			}
+		}, BATCH_COUNT });
+	}
+
+	std::vector<Case> BuildCases()
+	{
+		std::vector<Case> Cases;
+		const Inputs& In = gIn;
+
+		// Math
+		AddOp(Cases, "Math::ToRad", [&](std::size_t i) { return Math::ToRad(In.S0[i]); });
+		AddOp(Cases, "Math::ToDeg", [&](std::size_t i) { return Math::ToDeg(In.S0[i]); });
+		AddOp(Cases, "Math::IsNearZero", [&](std::size_t i) { return Math::IsNearZero(In.S0[i]); });
+		AddOp(Cases, "Math::Cos", [&](std::size_t i) { return Math::Cos(In.S0[i]); });
+		AddOp(Cases, "Math::Sin", [&](std::size_t i) { return Math::Sin(In.S0[i]); });
+		AddOp(Cases, "Math::Tan", [&](std::size_t i) { return Math::Tan(In.S0[i]); });
+		AddOp(Cases, "Math::Acos", [&](std::size_t i) { return Math::Acos(In.S0[i]); });
+		AddOp(Cases, "Math::Asin", [&](std::size_t i) { return Math::Asin(In.S0[i]); });
+		AddOp(Cases, "Math::Atan", [&](std::size_t i) { return Math::Atan(In.S0[i]); });
+		AddOp(Cases, "Math::Sec", [&](std::size_t i) { return Math::Sec(In.S0[i]); });
+		AddOp(Cases, "Math::Csc", [&](std::size_t i) { return Math::Csc(In.S1[i]); });
+		AddOp(Cases, "Math::Cot", [&](std::size_t i) { return Math::Cot(In.S1[i]); });
+		AddOp(Cases, "Math::Abs", [&](std::size_t i) { return Math::Abs(In.S0[i]); });
+		AddOp(Cases, "Math::Lerp", [&](std::size_t i) { return Math::Lerp(In.S0[i], In.S1[i], In.Rate[i]); });
+		AddOp(Cases, "Math::Sqrt", [&](std::size_t i) { return Math::Sqrt(In.S1[i]); });
+		AddOp(Cases, "Math::Fmod", [&](std::size_t i) { return Math::Fmod(In.S1[i], In.Rate[i] + 0.1f); });
+		AddOp(Cases, "Math::Max", [&](std::size_t i) { return Math::Max(In.S0[i], In.Rate[i]); });
+		AddOp(Cases, "Math::Min", [&](std::size_t i) { return Math::Min(In.S0[i], In.Rate[i]); });
+		AddOp(Cases, "Math::Clamp", [&](std::size_t i) { return Math::Clamp(In.S1[i], 1.f, 2.f); });
+		AddOp(Cases, "Math::Random<float>", [&](std::size_t) { return Math::Random(0.f, 1.f); });
+		AddOp(Cases, "Math::Random<int>", [&](std::size_t) { return Math::Random(0, 1000); });
+
+		// Vector2
+		AddOp(Cases, "Vector2::Square", [&](std::size_t i) { return In.A2[i].Square(); });
+		AddOp(Cases, "Vector2::Length", [&](std::size_t i) { return In.A2[i].Length(); });
+		AddOp(Cases, "Vector2::operator+", [&](std::size_t i) { return In.A2[i] + In.B2[i]; });
+		AddOp(Cases, "Vector2::operator-", [&](std::size_t i) { return In.A2[i] - In.B2[i]; });
+		AddOp(Cases, "Vector2::operator-(unary)", [&](std::size_t i) { return -In.A2[i]; });
+		AddOp(Cases, "Vector2::operator*", [&](std::size_t i) { return In.S0[i] * In.A2[i]; });
+		AddOp(Cases, "Vector2::operator+=", [&](std::size_t i) { Vector2 V = In.A2[i]; V += In.B2[i]; return V; });
+		AddOp(Cases, "Vector2::operator-=", [&](std::size_t i) { Vector2 V = In.A2[i]; V -= In.B2[i]; return V; });
+		AddOp(Cases, "Vector2::operator*=", [&](std::size_t i) { Vector2 V = In.A2[i]; V *= In.S0[i]; return V; });
+		AddOp(Cases, "Vector2::Norm", [&](std::size_t i) { Vector2 V = In.A2[i]; V.Norm(); return V; });
+		AddOp(Cases, "Vector2::Dot", [&](std::size_t i) { return Vector2::Dot(In.A2[i], In.B2[i]); });
+		AddOp(Cases, "Vector2::Lerp", [&](std::size_t i) { return Vector2::Lerp(In.A2[i], In.B2[i], In.Rate[i]); });
+		AddOp(Cases, "Vector2::Reflect", [&](std::size_t i) { return Vector2::Reflect(In.A2[i], In.N2[i]); });
+		AddOp(Cases, "Vector2::Transform", [&](std::size_t i) { return Vector2::Transform(In.A2[i], In.M3a[i]); });
+
+		// Vector3
+		AddOp(Cases, "Vector3::Square", [&](std::size_t i) { return In.A3[i].Square(); });
+		AddOp(Cases, "Vector3::Length", [&](std::size_t i) { return In.A3[i].Length(); });
+		AddOp(Cases, "Vector3::operator+", [&](std::size_t i) { return In.A3[i] + In.B3[i]; });
+		AddOp(Cases, "Vector3::operator-", [&](std::size_t i) { return In.A3[i] - In.B3[i]; });
+		AddOp(Cases, "Vector3::operator-(unary)", [&](std::size_t i) { return -In.A3[i]; });
+		AddOp(Cases, "Vector3::operator*", [&](std::size_t i) { return In.S0[i] * In.A3[i]; });
+		AddOp(Cases, "Vector3::operator+=", [&](std::size_t i) { Vector3 V = In.A3[i]; V += In.B3[i]; return V; });
+		AddOp(Cases, "Vector3::operator-=", [&](std::size_t i) { Vector3 V = In.A3[i]; V -= In.B3[i]; return V; });
+		AddOp(Cases, "Vector3::operator*=", [&](std::size_t i) { Vector3 V = In.A3[i]; V *= In.S0[i]; return V; });
+		AddOp(Cases, "Vector3::Norm", [&](std::size_t i) { return Vector3::Norm(In.A3[i]); });
+		AddOp(Cases, "Vector3::Dot", [&](std::size_t i) { return Vector3::Dot(In.A3[i], In.B3[i]); });
+		AddOp(Cases, "Vector3::Cross", [&](std::size_t i) { return Vector3::Cross(In.A3[i], In.B3[i]); });
+		AddOp(Cases, "Vector3::Lerp", [&](std::size_t i) { return Vector3::Lerp(In.A3[i], In.B3[i], In.Rate[i]); });
+		AddOp(Cases, "Vector3::Reflect", [&](std::size_t i) { return Vector3::Reflect(In.A3[i], In.N3[i]); });
+		AddOp(Cases, "Vector3::Transform(Matrix4)", [&](std::size_t i) { return Vector3::Transform(In.A3[i], In.M4a[i]); });
+		AddOp(Cases, "Vector3::Transform(Quaternion)", [&](std::size_t i) { return Vector3::Transform(In.A3[i], In.Qa[i]); });
+
+		// Matrix3
+		AddOp(Cases, "Matrix3::operator*", [&](std::size_t i) { return In.M3a[i] * In.M3b[i]; });
+		AddOp(Cases, "Matrix3::operator*=", [&](std::size_t i) { Matrix3 M = In.M3a[i]; M *= In.M3b[i]; return M; });
+		AddOp(Cases, "Matrix3::CreateScale", [&](std::size_t i) { return Matrix3::CreateScale(In.A2[i]); });
+		AddOp(Cases, "Matrix3::CreateRotation", [&](std::size_t i) { return Matrix3::CreateRotation(In.S0[i]); });
+		AddOp(Cases, "Matrix3::CreateTranslation", [&](std::size_t i) { return Matrix3::CreateTranslation(In.A2[i]); });
+		AddOp(Cases, "Matrix3::CreateAffine", [&](std::size_t i) { return Matrix3::CreateAffine(In.A2[i], In.S0[i], In.B2[i]); });
+
+		// Matrix4
+		AddOp(Cases, "Matrix4::operator*", [&](std::size_t i) { return In.M4a[i] * In.M4b[i]; });
+		AddOp(Cases, "Matrix4::operator*=", [&](std::size_t i) { Matrix4 M = In.M4a[i]; M *= In.M4b[i]; return M; });
+		AddOp(Cases, "Matrix4::Invert", [&](std::size_t i) { Matrix4 M = In.M4a[i]; M.Invert(); return M; });
+		AddOp(Cases, "Matrix4::GetTranslation", [&](std::size_t i) { return In.M4a[i].GetTranslation(); });
+		AddOp(Cases, "Matrix4::GetXAxis", [&](std::size_t i) { return In.M4a[i].GetXAxis(); });
+		AddOp(Cases, "Matrix4::GetYAxis", [&](std::size_t i) { return In.M4a[i].GetYAxis(); });
+		AddOp(Cases, "Matrix4::GetZAxis", [&](std::size_t i) { return In.M4a[i].GetZAxis(); });
+		AddOp(Cases, "Matrix4::GetScale", [&](std::size_t i) { return In.M4a[i].GetScale(); });
+		AddOp(Cases, "Matrix4::CreateScale", [&](std::size_t i) { return Matrix4::CreateScale(In.A3[i]); });
+		AddOp(Cases, "Matrix4::CreateRotationX", [&](std::size_t i) { return Matrix4::CreateRotationX(In.S0[i]); });
+		AddOp(Cases, "Matrix4::CreateRotationY", [&](std::size_t i) { return Matrix4::CreateRotationY(In.S0[i]); });
+		AddOp(Cases, "Matrix4::CreateRotationZ", [&](std::size_t i) { return Matrix4::CreateRotationZ(In.S0[i]); });
+		AddOp(Cases, "Matrix4::CreateFromQuaternion", [&](std::size_t i) { return Matrix4::CreateFromQuaternion(In.Qa[i]); });
+		AddOp(Cases, "Matrix4::CreateTranslation", [&](std::size_t i) { return Matrix4::CreateTranslation(In.A3[i]); });
+		AddOp(Cases, "Matrix4::CreateLookAt", [&](std::size_t i) { return Matrix4::CreateLookAt(In.A3[i], In.B3[i], Vector3::UnitZ); });
+		AddOp(Cases, "Matrix4::CreateOrtho", [&](std::size_t i) { return Matrix4::CreateOrtho(In.S1[i] * 100.f, In.S1[i] * 50.f, 0.1f, 1000.f); });
+		AddOp(Cases, "Matrix4::CreatePerspectiveFOV", [&](std::size_t i) { return Matrix4::CreatePerspectiveFOV(In.Rate[i] + 0.5f, 1280.f, 720.f, 0.1f, 1000.f); });
+		AddOp(Cases, "Matrix4::CreateProjView", [&](std::size_t i) { return Matrix4::CreateProjView(In.S1[i] * 100.f, In.S1[i] * 50.f); });
+
+		// Quaternion
+		AddOp(Cases, "Quaternion::Quaternion(Axis,Rad)", [&](std::size_t i) { return Quaternion(In.N3[i], In.S0[i]); });
+		AddOp(Cases, "Quaternion::Conjugate", [&](std::size_t i) { Quaternion Q = In.Qa[i]; Q.Conjugate(); return Q; });
+		AddOp(Cases, "Quaternion::Square", [&](std::size_t i) { return In.Qa[i].Square(); });
+		AddOp(Cases, "Quaternion::Length", [&](std::size_t i) { return In.Qa[i].Length(); });
+		AddOp(Cases, "Quaternion::Norm", [&](std::size_t i) { return Quaternion::Norm(In.Qa[i]); });
+		AddOp(Cases, "Quaternion::Dot", [&](std::size_t i) { return Quaternion::Dot(In.Qa[i], In.Qb[i]); });
+		AddOp(Cases, "Quaternion::Lerp", [&](std::size_t i) { return Quaternion::Lerp(In.Qa[i], In.Qb[i], In.Rate[i]); });
+		AddOp(Cases, "Quaternion::Slerp", [&](std::size_t i) { return Quaternion::Slerp(In.Qa[i], In.Qb[i], In.Rate[i]); });
+		AddOp(Cases, "Quaternion::Concatenate", [&](std::size_t i) { return Quaternion::Concatenate(In.Qa[i], In.Qb[i]); });
+
+		// Calculas, through the virtual Function() like any user subclass.
+		Calculas* Curve = &gIn.Curve;
+		AddOp(Cases, "Calculas::NumericDifferentiate", [=](std::size_t i) { return Curve->NumericDifferentiate(In.S1[i], 1.0e-3f); });
+		AddOp(Cases, "Calculas::NumericIntegrate(16)", [=](std::size_t i) { return Curve->NumericIntegrate(In.S0[i], In.S1[i], 16); });
+
+		return Cases;
+	}
+
+	struct Result
+	{
+		std::string Name;
+		std::uint64_t Ops;
+		double NsPerOp;
+		double PerOp[Bench::PERF_EVENT_COUNT];
+		bool HasCounter[Bench::PERF_EVENT_COUNT];
+	};
+
+	double Seconds(std::chrono::steady_clock::time_point Start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+	// Grows the repetition count until one run takes MinTime, then keeps the
+	// fastest of Repeats runs; counters come from that same run.
+	Result Measure(const Case& Target, double MinTime, int Repeats, Bench::PerfCounters& Perf)
+	{
+		std::size_t Reps = 1;
+
+		while (true)
+		{
+			auto Start = std::chrono::steady_clock::now();
+			Target.Run(Reps);
+			double Elapsed = Seconds(Start);
+
+			if (Elapsed >= MinTime)
+			{
+				break;
+			}
+
+			double Scale = Elapsed > 0.0 ? MinTime / Elapsed * 1.2 : 10.0;
+			Reps = static_cast<std::size_t>(static_cast<double>(Reps) * std::min(10.0, std::max(2.0, Scale)));
+		}
+
+		Result Best;
+		Best.Name = Target.Name;
+		Best.Ops = Reps * Target.OpsPerRep;
+		Best.NsPerOp = 0.0;
+
+		for (int r = 0; r < Repeats; ++r)
+		{
+			Perf.Start();
+			auto Start = std::chrono::steady_clock::now();
+			Target.Run(Reps);
+			double Elapsed = Seconds(Start);
+			Perf.Stop();
+
+			double NsPerOp = Elapsed * 1.0e9 / static_cast<double>(Best.Ops);
+
+			if (r == 0 || NsPerOp < Best.NsPerOp)
+			{
+				Best.NsPerOp = NsPerOp;
+
+				for (int e = 0; e < Bench::PERF_EVENT_COUNT; ++e)
+				{
+					Bench::PerfEvent Event = static_cast<Bench::PerfEvent>(e);
+					Best.HasCounter[e] = Perf.IsAvailable(Event);
+					Best.PerOp[e] = static_cast<double>(Perf.Get(Event)) / static_cast<double>(Best.Ops);
+				}
+			}
+		}
+		return Best;
+	}
+
+	std::string Escape(const std::string& Text)
+	{
+		std::string Out;
+
+		for (char Iter : Text)
+		{
+			if (Iter == '"' || Iter == '\\')
+			{
+				Out += '\\';
+			}
+			Out += Iter;
+		}
+		return Out;
+	}
+
+	bool WriteJson(const std::string& Path, const std::vector<Result>& Results, bool HasCounters)
+	{
+		std::ofstream File(Path);
+
+		if (!File)
+		{
+			return false;
+		}
+
+		char Date[32];
+		std::time_t Now = std::time(nullptr);
+		std::strftime(Date, sizeof(Date), "%Y-%m-%dT%H:%M:%S", std::localtime(&Now));
+
+#if defined(__VERSION__)
+		const char* Compiler = __VERSION__;
+#elif defined(_MSC_VER)
+		const std::string MsvcVersion = "MSVC " + std::to_string(_MSC_VER);
+		const char* Compiler = MsvcVersion.c_str();
+#else
+		const char* Compiler = "unknown";
+#endif
+
+		File << "{\n";
+		File << "\t\"context\": { \"date\": \"" << Date << "\", \"compiler\": \"" << Escape(Compiler)
+			<< "\", \"hardware_threads\": " << std::thread::hardware_concurrency()
+			<< ", \"perf_counters\": " << (HasCounters ? "true" : "false") << " },\n";
+		File << "\t\"benchmarks\": [\n";
+
+		// One result per line so the file diffs cleanly and --compare can read it line by line.
+		for (std::size_t i = 0; i < Results.size(); ++i)
+		{
+			const Result& Iter = Results[i];
+			char Line[512];
+			int Length = std::snprintf(Line, sizeof(Line), "\t\t{ \"name\": \"%s\", \"ops\": %llu, \"ns_per_op\": %.4f, \"mops_per_sec\": %.3f",
+				Escape(Iter.Name).c_str(), static_cast<unsigned long long>(Iter.Ops), Iter.NsPerOp, 1.0e3 / Iter.NsPerOp);
+
+			for (int e = 0; e < Bench::PERF_EVENT_COUNT && Length > 0 && Length < static_cast<int>(sizeof(Line)); ++e)
+			{
+				if (Iter.HasCounter[e])
+				{
+					Length += std::snprintf(Line + Length, sizeof(Line) - Length, ", \"%s_per_op\": %.4f",
+						Bench::PerfCounters::GetName(static_cast<Bench::PerfEvent>(e)), Iter.PerOp[e]);
+				}
+			}
+
+			File << Line << " }" << (i + 1 < Results.size() ? "," : "") << '\n';
+		}
+
+		File << "\t]\n}\n";
+		return static_cast<bool>(File);
+	}
+
+	// Reads back the name -> ns_per_op pairs of a file written by WriteJson.
+	bool ReadBaseline(const std::string& Path, std::map<std::string, double>& Out)
+	{
+		std::ifstream File(Path);
+
+		if (!File)
+		{
+			return false;
+		}
+
+		const std::string NameKey = "\"name\": \"";
+		const std::string TimeKey = "\"ns_per_op\": ";
+		std::string Line;
+
+		while (std::getline(File, Line))
+		{
+			std::size_t Name = Line.find(NameKey);
+			std::size_t Time = Line.find(TimeKey);
+
+			if (Name == std::string::npos || Time == std::string::npos)
+			{
+				continue;
+			}
+
+			Name += NameKey.size();
+			std::size_t NameEnd = Line.find('"', Name);
+
+			if (NameEnd != std::string::npos)
+			{
+				Out[Line.substr(Name, NameEnd - Name)] = std::strtod(Line.c_str() + Time + TimeKey.size(), nullptr);
+			}
+		}
+		return true;
+	}
+
+	int Compare(const std::vector<Result>& Results, const std::map<std::string, double>& Baseline, double Threshold)
+	{
+		int Regressions = 0, Improvements = 0, Missing = 0;
+
+		std::printf("\n%-48s %12s %12s %9s\n", "compare", "base ns", "now ns", "delta");
+
+		for (const Result& Iter : Results)
+		{
+			auto Found = Baseline.find(Iter.Name);
+
+			if (Found == Baseline.end() || Found->second <= 0.0)
+			{
+				std::printf("%-48s %12s %12.3f %9s  new\n", Iter.Name.c_str(), "-", Iter.NsPerOp, "-");
+				++Missing;
+				continue;
+			}
+
+			double Delta = (Iter.NsPerOp - Found->second) / Found->second * 100.0;
+			const char* Flag = "";
+
+			if (Delta > Threshold)
+			{
+				Flag = "  REGRESSION";
+				++Regressions;
+			}
+			else if (Delta < -Threshold)
+			{
+				Flag = "  faster";
+				++Improvements;
+			}
+
+			std::printf("%-48s %12.3f %12.3f %+8.1f%%%s\n", Iter.Name.c_str(), Found->second, Iter.NsPerOp, Delta, Flag);
+		}
+
+		std::printf("\n%d regression(s), %d improvement(s) beyond %.1f%%, %d op(s) not in baseline\n",
+			Regressions, Improvements, Threshold, Missing);
+		return Regressions;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	std::string Filter, JsonPath, ComparePath;
+	double MinTime = 0.05, Threshold = 10.0;
+	int Repeats = 3;
+	bool ListOnly = false;
+
+	for (int i = 1; i < Argc; ++i)
+	{
+		std::string Arg = Argv[i];
+		bool HasValue = i + 1 < Argc;
+
+		if (Arg == "--filter" && HasValue) Filter = Argv[++i];
+		else if (Arg == "--min-time" && HasValue) MinTime = std::atof(Argv[++i]);
+		else if (Arg == "--repeat" && HasValue) Repeats = std::max(1, std::atoi(Argv[++i]));
+		else if (Arg == "--json" && HasValue) JsonPath = Argv[++i];
+		else if (Arg == "--compare" && HasValue) ComparePath = Argv[++i];
+		else if (Arg == "--threshold" && HasValue) Threshold = std::atof(Argv[++i]);
+		else if (Arg == "--list") ListOnly = true;
+		else
+		{
+			std::cerr << "usage: MathBench [--filter Text] [--min-time Sec] [--repeat N] [--list]\n"
+				"                 [--json Out.json] [--compare Baseline.json] [--threshold Percent]\n";
+			return 1;
+		}
+	}
+
+	std::map<std::string, double> Baseline;
+
+	if (!ComparePath.empty() && !ReadBaseline(ComparePath, Baseline))
+	{
+		std::cerr << "cannot read baseline " << ComparePath << '\n';
+		return 1;
+	}
+
+	Math::SeedRandom(42);
+	FillInputs();
+
+	std::vector<Case> Cases = BuildCases();
+	std::vector<Result> Results;
+	Bench::PerfCounters Perf;
+
+	std::printf("%zu ops x {single, batch of %zu}, min time %.3fs, best of %d, hw counters: %s\n\n",
+		Cases.size() / 2, BATCH_COUNT, MinTime, Repeats, Perf.IsAvailable() ? "on" : "unavailable");
+	std::printf("%-48s %10s %10s", "op", "ns/op", "Mops/s");
+
+	if (Perf.IsAvailable())
+	{
+		std::printf(" %10s %10s %10s %10s", "cyc/op", "ins/op", "llc/op", "brm/op");
+	}
+	std::printf("\n");
+
+	for (const Case& Iter : Cases)
+	{
+		if (!Filter.empty() && Iter.Name.find(Filter) == std::string::npos)
+		{
+			continue;
+		}
+
+		if (ListOnly)
+		{
+			std::printf("%s\n", Iter.Name.c_str());
+			continue;
+		}
+
+		Result Res = Measure(Iter, MinTime, Repeats, Perf);
+		std::printf("%-48s %10.3f %10.2f", Res.Name.c_str(), Res.NsPerOp, 1.0e3 / Res.NsPerOp);
+
+		for (int e = 0; e < Bench::PERF_EVENT_COUNT && Perf.IsAvailable(); ++e)
+		{
+			if (Res.HasCounter[e])
+			{
+				std::printf(" %10.3f", Res.PerOp[e]);
+			}
+			else
+			{
+				std::printf(" %10s", "-");
+			}
+		}
+		std::printf("\n");
+		std::fflush(stdout);
+
+		Results.push_back(Res);
+	}
+
+	Memory::HeapFree(gOutput, 64);
+
+	if (!JsonPath.empty())
+	{
+		if (!WriteJson(JsonPath, Results, Perf.IsAvailable()))
+		{
+			std::cerr << "cannot write " << JsonPath << '\n';
+			return 1;
+		}
+		std::printf("\nwrote %zu results to %s\n", Results.size(), JsonPath.c_str());
+	}
+
+	if (!ComparePath.empty())
+	{
+		return Compare(Results, Baseline, Threshold) > 0 ? 2 : 0;
+	}
+	return 0;
+}
@@ -0,0 +1,514 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+// Runs a synthetic frame loop on the MIR allocators and counts every general
+// heap call made after warm-up. Exits non-zero if a steady-state frame hit the heap.
+//
+//   MemoryBench [--verify]
+//
+// --verify runs the allocator reference checks and the frame loop, then skips the timings.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <thread>
+#include <vector>
+
+#include "../MIR/Math.h"
+#include "../MIR/Memory.h"
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+namespace
+{
+	std::atomic<std::size_t> HeapCalls(0);
+}
+
+#if defined(__GLIBC__)
+// glibc lets the executable interpose the C allocator itself, so malloc calls
+// made from inside the standard library are counted as well.
+extern "C"
+{
+	void* __libc_malloc(std::size_t Size);
+	void* __libc_calloc(std::size_t Count, std::size_t Size);
+	void* __libc_realloc(void* Ptr, std::size_t Size);
+	void* __libc_memalign(std::size_t Align, std::size_t Size);
+	void __libc_free(void* Ptr);
+
+	void* malloc(std::size_t Size) noexcept
+	{
+		HeapCalls.fetch_add(1, std::memory_order_relaxed);
+		return __libc_malloc(Size);
+	}
+
+	void* calloc(std::size_t Count, std::size_t Size) noexcept
+	{
+		HeapCalls.fetch_add(1, std::memory_order_relaxed);
+		return __libc_calloc(Count, Size);
+	}
+
+	void* realloc(void* Ptr, std::size_t Size) noexcept
+	{
+		HeapCalls.fetch_add(1, std::memory_order_relaxed);
+		return __libc_realloc(Ptr, Size);
+	}
+
+	void free(void* Ptr) noexcept
+	{
+		__libc_free(Ptr);
+	}
+}
+
+static void* CountedAlloc(std::size_t Size) { return malloc(Size == 0 ? 1 : Size); }
+static void CountedFree(void* Ptr) { free(Ptr); }
+
+static void* CountedAlignedAlloc(std::size_t Size, std::size_t Align)
+{
+	HeapCalls.fetch_add(1, std::memory_order_relaxed);
+	return __libc_memalign(Align, Size == 0 ? 1 : Size);
+}
+
+static void CountedAlignedFree(void* Ptr) { free(Ptr); }
+#else
+static void* CountedAlloc(std::size_t Size)
+{
+	HeapCalls.fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(Size == 0 ? 1 : Size);
+}
+
+static void CountedFree(void* Ptr) { std::free(Ptr); }
+
+static void* CountedAlignedAlloc(std::size_t Size, std::size_t Align)
+{
+	HeapCalls.fetch_add(1, std::memory_order_relaxed);
+#if defined(_MSC_VER)
+	return _aligned_malloc(Size == 0 ? 1 : Size, Align);
+#else
+	return std::aligned_alloc(Align, Memory::AlignUp(Size == 0 ? 1 : Size, Align));
+#endif
+}
+
+static void CountedAlignedFree(void* Ptr)
+{
+#if defined(_MSC_VER)
+	_aligned_free(Ptr);
+#else
+	std::free(Ptr);
+#endif
+}
+#endif
+
+static void* CheckedAlloc(void* Ptr)
+{
+	if (Ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return Ptr;
+}
+
+void* operator new(std::size_t Size) { return CheckedAlloc(CountedAlloc(Size)); }
+void* operator new[](std::size_t Size) { return CheckedAlloc(CountedAlloc(Size)); }
+void operator delete(void* Ptr) noexcept { CountedFree(Ptr); }
+void operator delete[](void* Ptr) noexcept { CountedFree(Ptr); }
+void operator delete(void* Ptr, std::size_t) noexcept { CountedFree(Ptr); }
+void operator delete[](void* Ptr, std::size_t) noexcept { CountedFree(Ptr); }
+
+void* operator new(std::size_t Size, std::align_val_t Align) { return CheckedAlloc(CountedAlignedAlloc(Size, static_cast<std::size_t>(Align))); }
+void* operator new[](std::size_t Size, std::align_val_t Align) { return CheckedAlloc(CountedAlignedAlloc(Size, static_cast<std::size_t>(Align))); }
+void operator delete(void* Ptr, std::align_val_t) noexcept { CountedAlignedFree(Ptr); }
+void operator delete[](void* Ptr, std::align_val_t) noexcept { CountedAlignedFree(Ptr); }
+void operator delete(void* Ptr, std::size_t, std::align_val_t) noexcept { CountedAlignedFree(Ptr); }
+void operator delete[](void* Ptr, std::size_t, std::align_val_t) noexcept { CountedAlignedFree(Ptr); }
+
+struct Body
+{
+	Vector3 Position;
+	Vector3 Velocity;
+	Quaternion Rotation;
+	float InvMass;
+};
+
+struct Contact
+{
+	Body* A;
+	Body* B;
+	Vector3 Point;
+	Vector3 Normal;
+	float Depth;
+};
+
+struct FrameHandoff
+{
+	Contact* Contacts = nullptr;
+	std::size_t Count = 0;
+};
+
+static const std::size_t BODY_COUNT = 2048;
+static const std::size_t CHURN_PER_FRAME = 64;
+static const std::size_t WARMUP_FRAMES = 64;
+static const std::size_t MEASURED_FRAMES = 1024;
+
+static std::size_t SimulateFrame(std::vector<Body*>& Bodies, Memory::ObjectPool<Body>& BodyPool,
+	Memory::FixedPool& NodePool, FrameHandoff& Handoff, std::size_t Frame)
+{
+	// Churn a slice of the bodies through the pool.
+	for (std::size_t i = 0; i < CHURN_PER_FRAME; ++i)
+	{
+		std::size_t Slot = (Frame * CHURN_PER_FRAME + i) % Bodies.size();
+		BodyPool.Delete(Bodies[Slot]);
+		Bodies[Slot] = BodyPool.New();
+		Bodies[Slot]->Position.Set(static_cast<float>(Slot), 0.f, 0.f);
+		Bodies[Slot]->InvMass = 1.f;
+	}
+
+	// Transient contact list, grown without reserving to exercise the adapter.
+	std::vector<Contact, Memory::FrameAllocator<Contact>> Contacts;
+
+	for (std::size_t i = 0; i + 1 < Bodies.size(); i += 2)
+	{
+		Contact Temp;
+		Temp.A = Bodies[i];
+		Temp.B = Bodies[i + 1];
+		Temp.Point = Vector3::Lerp(Temp.A->Position, Temp.B->Position, 0.5f);
+		Temp.Normal = Vector3::UnitY;
+		Temp.Depth = 0.01f * static_cast<float>(i % 7);
+		Contacts.push_back(Temp);
+	}
+
+	// Warm-start from last frame's contacts, then publish this frame's for the next one.
+	std::size_t Matched = 0;
+
+	for (std::size_t i = 0; i < Handoff.Count && i < Contacts.size(); ++i)
+	{
+		Matched += Handoff.Contacts[i].A == Contacts[i].A ? 1 : 0;
+	}
+
+	Contact* Published = static_cast<Contact*>(Memory::Frame::AllocDoubleBuffered(sizeof(Contact) * Contacts.size(), alignof(Contact)));
+
+	for (std::size_t i = 0; i < Contacts.size(); ++i)
+	{
+		Published[i] = Contacts[i];
+	}
+
+	Handoff.Contacts = Published;
+	Handoff.Count = Contacts.size();
+
+	// Node container backed by a fixed-size pool.
+	std::list<std::size_t, Memory::PoolAllocator<std::size_t>> Visible{Memory::PoolAllocator<std::size_t>(NodePool)};
+
+	for (std::size_t i = 0; i < Contacts.size(); i += 8)
+	{
+		Visible.push_back(i);
+	}
+
+	return Matched + Visible.size();
+}
+
+static void RunWorker(std::atomic<std::size_t>& FrameGo, std::atomic<std::size_t>& FrameDone, std::atomic<bool>& Quit, std::size_t& Sink)
+{
+	std::size_t Frame = 0;
+
+	while (true)
+	{
+		while (FrameGo.load(std::memory_order_acquire) == Frame && !Quit.load(std::memory_order_acquire))
+		{
+			std::this_thread::yield();
+		}
+
+		if (Quit.load(std::memory_order_acquire))
+		{
+			return;
+		}
+
+		std::vector<float, Memory::FrameAllocator<float>> Scratch;
+
+		for (std::size_t i = 0; i < 4096; ++i)
+		{
+			Scratch.push_back(static_cast<float>(i + Frame));
+		}
+
+		Sink += Scratch.size();
+		++Frame;
+		FrameDone.store(Frame, std::memory_order_release);
+	}
+}
+
+static void BenchAllocators()
+{
+	const std::size_t Count = 1 << 20;
+	const std::size_t Size = 64;
+
+	Memory::LinearArena Arena(Count * Size);
+
+	// Touch every page once so the timed pass measures the bump, not page faults.
+	for (std::size_t i = 0; i < Count; ++i)
+	{
+		static_cast<volatile unsigned char*>(Arena.Alloc(Size))[0] = 1;
+	}
+
+	Arena.Reset();
+	auto Start = std::chrono::steady_clock::now();
+
+	for (std::size_t i = 0; i < Count; ++i)
+	{
+		static_cast<volatile unsigned char*>(Arena.Alloc(Size))[0] = 1;
+	}
+
+	auto ArenaTime = std::chrono::steady_clock::now() - Start;
+
+	std::vector<void*> Ptrs(Count);
+	Start = std::chrono::steady_clock::now();
+
+	for (std::size_t i = 0; i < Count; ++i)
+	{
+		Ptrs[i] = std::malloc(Size);
+		static_cast<volatile unsigned char*>(Ptrs[i])[0] = 1;
+	}
+
+	for (std::size_t i = 0; i < Count; ++i)
+	{
+		std::free(Ptrs[i]);
+	}
+
+	auto MallocTime = std::chrono::steady_clock::now() - Start;
+
+	Memory::FixedPool Pool(Size, 4096);
+	Pool.Reserve(Count);
+	Start = std::chrono::steady_clock::now();
+
+	for (std::size_t i = 0; i < Count; ++i)
+	{
+		Ptrs[i] = Pool.Alloc();
+		static_cast<volatile unsigned char*>(Ptrs[i])[0] = 1;
+	}
+
+	for (std::size_t i = 0; i < Count; ++i)
+	{
+		Pool.Free(Ptrs[i]);
+	}
+
+	auto PoolTime = std::chrono::steady_clock::now() - Start;
+
+	auto PerOp = [Count](std::chrono::steady_clock::duration Time)
+	{
+		return std::chrono::duration<double, std::nano>(Time).count() / Count;
+	};
+
+	std::cout << "LinearArena alloc     : " << PerOp(ArenaTime) << " ns/op\n";
+	std::cout << "FixedPool alloc+free  : " << PerOp(PoolTime) << " ns/op\n";
+	std::cout << "malloc+free           : " << PerOp(MallocTime) << " ns/op\n";
+}
+
+static bool IsAligned(const void* Ptr, std::size_t Align)
+{
+	return reinterpret_cast<std::uintptr_t>(Ptr) % Align == 0;
+}
+
+static int Verify()
+{
+	int Failures = 0;
+	auto Check = [&Failures](bool Condition, const char* What)
+	{
+		if (!Condition)
+		{
+			std::cout << "  failed : " << What << '\n';
+			++Failures;
+		}
+	};
+
+	// LinearArena: alignment, rewind, and regrowth after an overflow.
+	{
+		Memory::LinearArena Arena(256);
+
+		void* A = Arena.Alloc(3, 1);
+		void* B = Arena.Alloc(8, 64);
+		Check(IsAligned(B, 64) && static_cast<unsigned char*>(B) >= static_cast<unsigned char*>(A) + 3, "LinearArena alignment");
+
+		std::size_t Marker = Arena.GetMarker();
+		void* C = Arena.Alloc(16);
+		Arena.Rewind(Marker);
+		Check(Arena.Alloc(16) == C, "LinearArena rewind");
+
+		void* Big = Arena.Alloc(1024, 128);
+		Check(Big != nullptr && IsAligned(Big, 128) && Arena.GetUsed() >= 1024, "LinearArena overflow");
+
+		std::size_t Used = Arena.GetUsed();
+		Arena.Reset();
+		Check(Arena.GetUsed() == 0 && Arena.GetCapacity() >= Used, "LinearArena regrows on reset");
+
+		std::size_t Blocks = Arena.GetStats().HeapBlocks;
+		Arena.Alloc(3, 1);
+		Arena.Alloc(8, 64);
+		Arena.Alloc(1024, 128);
+		Check(Arena.GetStats().HeapBlocks == Blocks, "LinearArena steady after regrow");
+	}
+
+	// FixedPool: distinct aligned blocks across chunks and LIFO reuse.
+	{
+		Memory::FixedPool Pool(48, 4, 32);
+		std::vector<void*> Blocks;
+		bool IsDistinct = true;
+
+		for (int i = 0; i < 10; ++i)
+		{
+			void* Ptr = Pool.Alloc();
+			IsDistinct = IsDistinct && Ptr != nullptr && IsAligned(Ptr, 32);
+
+			for (void* Iter : Blocks)
+			{
+				std::uintptr_t Left = reinterpret_cast<std::uintptr_t>(Iter);
+				std::uintptr_t Right = reinterpret_cast<std::uintptr_t>(Ptr);
+				IsDistinct = IsDistinct && (Left > Right ? Left - Right : Right - Left) >= 48;
+			}
+			Blocks.push_back(Ptr);
+		}
+		Check(IsDistinct, "FixedPool distinct aligned blocks");
+		Check(Pool.GetLiveBlocks() == 10, "FixedPool live count");
+		Check(Pool.GetBlockSize() == 64, "FixedPool rounds blocks to the alignment");
+		Check(Pool.Fits(64, 32) && !Pool.Fits(65, 32) && !Pool.Fits(8, 64), "FixedPool fits");
+
+		Pool.Free(Blocks[5]);
+		Check(Pool.Alloc() == Blocks[5], "FixedPool reuses freed block");
+
+		for (void* Iter : Blocks)
+		{
+			Pool.Free(Iter);
+		}
+		Check(Pool.GetLiveBlocks() == 0, "FixedPool frees all blocks");
+	}
+
+	// ObjectPool constructs in place and returns its blocks.
+	{
+		Memory::ObjectPool<Body> Pool(8);
+		Body* Temp = Pool.New();
+		Temp->InvMass = 2.f;
+		Check(Pool.GetLiveCount() == 1 && IsAligned(Temp, alignof(Body)), "ObjectPool new");
+		Pool.Delete(Temp);
+		Check(Pool.GetLiveCount() == 0, "ObjectPool delete");
+	}
+
+	// Double-buffered frame data survives exactly one EndFrame().
+	{
+		int* Previous = static_cast<int*>(Memory::Frame::AllocDoubleBuffered(sizeof(int) * 64, alignof(int)));
+
+		for (int i = 0; i < 64; ++i)
+		{
+			Previous[i] = i * 7;
+		}
+
+		std::uint64_t Index = Memory::Frame::GetFrameIndex();
+		Memory::Frame::EndFrame();
+
+		int* Current = static_cast<int*>(Memory::Frame::AllocDoubleBuffered(sizeof(int) * 64, alignof(int)));
+		bool IsIntact = Current != Previous;
+
+		for (int i = 0; i < 64; ++i)
+		{
+			Current[i] = -1;
+			IsIntact = IsIntact && Previous[i] == i * 7;
+		}
+		Check(IsIntact, "double-buffered data survives one frame");
+		Check(Memory::Frame::GetFrameIndex() == Index + 1, "frame index advances");
+
+		Memory::Frame::EndFrame();
+	}
+
+	std::cout << "Reference checks : " << (Failures == 0 ? "passed" : "FAILED") << " (" << Failures << " failures)\n\n";
+	return Failures;
+}
+
+int main(int argc, char* argv[])
+{
+	bool VerifyOnly = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--verify"))
+		{
+			VerifyOnly = true;
+		}
+		else
+		{
+			std::cout << "Usage : MemoryBench [--verify]\n";
+			return 1;
+		}
+	}
+
+	Memory::Frame::SetDefaultCapacity(64 << 10, 64 << 10);
+
+	if (Verify() != 0)
+	{
+		return 1;
+	}
+
+	Memory::ObjectPool<Body> BodyPool(512);
+	Memory::FixedPool NodePool(64, 256);
+	std::vector<Body*> Bodies(BODY_COUNT);
+
+	for (Body*& Iter : Bodies)
+	{
+		Iter = BodyPool.New();
+	}
+
+	std::atomic<std::size_t> FrameGo(0);
+	std::atomic<std::size_t> FrameDone(0);
+	std::atomic<bool> Quit(false);
+	std::size_t WorkerSink = 0;
+
+	std::thread Worker(RunWorker, std::ref(FrameGo), std::ref(FrameDone), std::ref(Quit), std::ref(WorkerSink));
+
+	FrameHandoff Handoff;
+	std::size_t Sink = 0;
+	std::size_t SteadyCalls = 0;
+
+	for (std::size_t Frame = 0; Frame < WARMUP_FRAMES + MEASURED_FRAMES; ++Frame)
+	{
+		std::size_t Before = HeapCalls.load(std::memory_order_relaxed);
+
+		FrameGo.store(Frame + 1, std::memory_order_release);
+		Sink += SimulateFrame(Bodies, BodyPool, NodePool, Handoff, Frame);
+
+		while (FrameDone.load(std::memory_order_acquire) != Frame + 1)
+		{
+			std::this_thread::yield();
+		}
+
+		Memory::Frame::EndFrame();
+
+		if (Frame >= WARMUP_FRAMES)
+		{
+			SteadyCalls += HeapCalls.load(std::memory_order_relaxed) - Before;
+		}
+	}
+
+	Quit.store(true, std::memory_order_release);
+	Worker.join();
+
+	for (Body* Iter : Bodies)
+	{
+		BodyPool.Delete(Iter);
+	}
+
+	Memory::AllocStats FrameStats = Memory::Frame::GetStats();
+
+	std::cout << "Steady-state frames   : " << MEASURED_FRAMES << '\n';
+	std::cout << "Heap calls in frames  : " << SteadyCalls << '\n';
+	std::cout << "Frame allocations     : " << FrameStats.Allocations << '\n';
+	std::cout << "Frame arena capacity  : " << FrameStats.Capacity << " bytes\n";
+	std::cout << "Frame arena heap grows: " << FrameStats.HeapBlocks << '\n';
+	std::cout << "Body pool peak        : " << BodyPool.GetStats().PeakBytes << " bytes\n";
+	std::cout << "(checksum " << Sink + WorkerSink << ")\n\n";
+
+	if (!VerifyOnly)
+	{
+		BenchAllocators();
+	}
+
+	return SteadyCalls == 0 ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#include "PerfCounters.h"
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Bench
+{
+#if defined(__linux__)
+	namespace
+	{
+		int OpenEvent(std::uint32_t Type, std::uint64_t Config, int Group)
+		{
+			perf_event_attr Attr;
+			std::memset(&Attr, 0, sizeof(Attr));
+			Attr.size = sizeof(Attr);
+			Attr.type = Type;
+			Attr.config = Config;
+			Attr.disabled = Group < 0 ? 1 : 0;
+			Attr.exclude_kernel = 1;
+			Attr.exclude_hv = 1;
+			Attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+
+			return static_cast<int>(syscall(__NR_perf_event_open, &Attr, 0, -1, Group, 0));
+		}
+	}
+#endif
+
+	PerfCounters::PerfCounters()
+		: mGroup(-1)
+	{
+		for (int i = 0; i < PERF_EVENT_COUNT; ++i)
+		{
+			mFds[i] = -1;
+			mIds[i] = 0;
+			mValues[i] = 0;
+		}
+
+#if defined(__linux__)
+		const std::uint64_t Configs[PERF_EVENT_COUNT] =
+		{
+			PERF_COUNT_HW_CPU_CYCLES,
+			PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_MISSES,
+			PERF_COUNT_HW_BRANCH_MISSES
+		};
+
+		for (int i = 0; i < PERF_EVENT_COUNT; ++i)
+		{
+			mFds[i] = OpenEvent(PERF_TYPE_HARDWARE, Configs[i], mGroup);
+
+			if (mFds[i] < 0)
+			{
+				// Without a leader nothing else can join; a missing member is just skipped.
+				if (i == 0)
+				{
+					return;
+				}
+				continue;
+			}
+
+			if (mGroup < 0)
+			{
+				mGroup = mFds[i];
+			}
+			ioctl(mFds[i], PERF_EVENT_IOC_ID, &mIds[i]);
+		}
+#endif
+	}
+
+	PerfCounters::~PerfCounters()
+	{
+#if defined(__linux__)
+		for (int Fd : mFds)
+		{
+			if (Fd >= 0)
+			{
+				close(Fd);
+			}
+		}
+#endif
+	}
+
+	void PerfCounters::Start()
+	{
+#if defined(__linux__)
+		if (mGroup >= 0)
+		{
+			ioctl(mGroup, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(mGroup, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		}
+#endif
+	}
+
+	void PerfCounters::Stop()
+	{
+#if defined(__linux__)
+		if (mGroup < 0)
+		{
+			return;
+		}
+
+		ioctl(mGroup, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+		// Layout: nr, then { value, id } per member.
+		std::uint64_t Buffer[1 + 2 * PERF_EVENT_COUNT];
+
+		if (read(mGroup, Buffer, sizeof(Buffer)) < static_cast<ssize_t>(sizeof(std::uint64_t)))
+		{
+			return;
+		}
+
+		for (std::uint64_t n = 0; n < Buffer[0] && n < PERF_EVENT_COUNT; ++n)
+		{
+			for (int i = 0; i < PERF_EVENT_COUNT; ++i)
+			{
+				if (mFds[i] >= 0 && mIds[i] == Buffer[2 + 2 * n])
+				{
+					mValues[i] = Buffer[1 + 2 * n];
+				}
+			}
+		}
+#endif
+	}
+
+	const char* PerfCounters::GetName(PerfEvent Event)
+	{
+		switch (Event)
+		{
+		case PERF_CYCLES: return "cycles";
+		case PERF_INSTRUCTIONS: return "instructions";
+		case PERF_CACHE_MISSES: return "cache_misses";
+		case PERF_BRANCH_MISSES: return "branch_misses";
+		default: return "unknown";
+		}
+	}
+}
@@ -0,0 +1,47 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+
+namespace Bench
+{
+	enum PerfEvent
+	{
+		PERF_CYCLES,
+		PERF_INSTRUCTIONS,
+		PERF_CACHE_MISSES,
+		PERF_BRANCH_MISSES,
+		PERF_EVENT_COUNT
+	};
+
+	// Hardware counters for the calling thread, read as one perf_event group so
+	// every value covers the same interval. Only Linux exposes them; elsewhere, or
+	// when the kernel refuses (containers, perf_event_paranoid), IsAvailable() is
+	// false and Stop() leaves the values at zero.
+	class PerfCounters
+	{
+	public:
+		PerfCounters();
+		~PerfCounters();
+
+		PerfCounters(const PerfCounters&) = delete;
+		PerfCounters& operator=(const PerfCounters&) = delete;
+
+		bool IsAvailable() const { return mGroup >= 0; }
+		bool IsAvailable(PerfEvent Event) const { return mFds[Event] >= 0; }
+
+		void Start();
+		void Stop();
+
+		std::uint64_t Get(PerfEvent Event) const { return mValues[Event]; }
+
+		static const char* GetName(PerfEvent Event);
+
+	private:
+		int mGroup;
+		int mFds[PERF_EVENT_COUNT];
+		std::uint64_t mIds[PERF_EVENT_COUNT];
+		std::uint64_t mValues[PERF_EVENT_COUNT];
+	};
+}
@@ -0,0 +1,499 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+// Checks BVH hits against brute force, measures primary / incoherent / shadow
+// ray throughput on a set of test meshes, then path traces a Cornell box and
+// writes the image as PPM.
+//
+//   RayTraceBench [--verify] [--obj Mesh.obj] [--size N] [--spp N] [--out Image.ppm]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../MIR/PathTracer.h"
+
+namespace
+{
+	struct Mesh
+	{
+		std::string Name;
+		std::vector<Vector3> Positions;
+		std::vector<std::uint32_t> Indices;
+
+		std::size_t GetTriangleCount() const { return Indices.size() / 3; }
+
+		void AddQuad(const Vector3& A, const Vector3& B, const Vector3& C, const Vector3& D)
+		{
+			std::uint32_t Base = static_cast<std::uint32_t>(Positions.size());
+			Positions.insert(Positions.end(), { A, B, C, D });
+			Indices.insert(Indices.end(), { Base, Base + 1, Base + 2, Base, Base + 2, Base + 3 });
+		}
+
+		void AddBox(const Vector3& Center, const Vector3& Half, float RotY)
+		{
+			Quaternion Rot(Vector3::UnitY, RotY);
+			Vector3 C[8];
+
+			for (int i = 0; i < 8; ++i)
+			{
+				Vector3 Local((i & 1) ? Half.X : -Half.X, (i & 2) ? Half.Y : -Half.Y, (i & 4) ? Half.Z : -Half.Z);
+				C[i] = Center + Vector3::Transform(Local, Rot);
+			}
+
+			AddQuad(C[0], C[1], C[3], C[2]);
+			AddQuad(C[4], C[6], C[7], C[5]);
+			AddQuad(C[0], C[4], C[5], C[1]);
+			AddQuad(C[2], C[3], C[7], C[6]);
+			AddQuad(C[0], C[2], C[6], C[4]);
+			AddQuad(C[1], C[5], C[7], C[3]);
+		}
+	};
+
+	Mesh MakeIcosphere(int Subdivisions, const Vector3& Center, float Radius)
+	{
+		const float T = (1.f + Math::Sqrt(5.f)) / 2.f;
+
+		Mesh Temp;
+		Temp.Name = "icosphere-" + std::to_string(Subdivisions);
+		Temp.Positions =
+		{
+			Vector3(-1, T, 0), Vector3(1, T, 0), Vector3(-1, -T, 0), Vector3(1, -T, 0),
+			Vector3(0, -1, T), Vector3(0, 1, T), Vector3(0, -1, -T), Vector3(0, 1, -T),
+			Vector3(T, 0, -1), Vector3(T, 0, 1), Vector3(-T, 0, -1), Vector3(-T, 0, 1)
+		};
+		Temp.Indices =
+		{
+			0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+			3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1
+		};
+
+		for (int Level = 0; Level < Subdivisions; ++Level)
+		{
+			std::vector<std::uint32_t> Next;
+			Next.reserve(Temp.Indices.size() * 4);
+
+			// Edges are not shared, which costs duplicate vertices but no lookup.
+			for (std::size_t i = 0; i < Temp.Indices.size(); i += 3)
+			{
+				std::uint32_t A = Temp.Indices[i], B = Temp.Indices[i + 1], C = Temp.Indices[i + 2];
+				std::uint32_t Ab = static_cast<std::uint32_t>(Temp.Positions.size());
+
+				Temp.Positions.push_back(0.5f * (Temp.Positions[A] + Temp.Positions[B]));
+				Temp.Positions.push_back(0.5f * (Temp.Positions[B] + Temp.Positions[C]));
+				Temp.Positions.push_back(0.5f * (Temp.Positions[C] + Temp.Positions[A]));
+
+				Next.insert(Next.end(), { A, Ab, Ab + 2, B, Ab + 1, Ab, C, Ab + 2, Ab + 1, Ab, Ab + 1, Ab + 2 });
+			}
+			Temp.Indices.swap(Next);
+		}
+
+		for (Vector3& Iter : Temp.Positions)
+		{
+			Iter = Center + Radius * Vector3::Norm(Iter);
+		}
+		return Temp;
+	}
+
+	Mesh MakeTerrain(std::uint32_t Cells)
+	{
+		Mesh Temp;
+		Temp.Name = "terrain-" + std::to_string(Cells);
+
+		for (std::uint32_t Z = 0; Z <= Cells; ++Z)
+		{
+			for (std::uint32_t X = 0; X <= Cells; ++X)
+			{
+				float U = static_cast<float>(X) / Cells, V = static_cast<float>(Z) / Cells;
+				float Height = 0.08f * Math::Sin(11.f * U) * Math::Cos(13.f * V) + 0.03f * Math::Sin(47.f * U + 29.f * V);
+				Temp.Positions.push_back(Vector3(U - 0.5f, Height, V - 0.5f));
+			}
+		}
+
+		for (std::uint32_t Z = 0; Z < Cells; ++Z)
+		{
+			for (std::uint32_t X = 0; X < Cells; ++X)
+			{
+				std::uint32_t I = Z * (Cells + 1) + X;
+				Temp.Indices.insert(Temp.Indices.end(), { I, I + Cells + 1, I + 1, I + 1, I + Cells + 1, I + Cells + 2 });
+			}
+		}
+		return Temp;
+	}
+
+	// Positions and faces only; polygons are fan triangulated.
+	bool LoadObj(const char* Path, Mesh& Out)
+	{
+		std::ifstream File(Path);
+
+		if (!File)
+		{
+			return false;
+		}
+
+		Out.Name = Path;
+		std::string Line;
+
+		while (std::getline(File, Line))
+		{
+			std::istringstream Stream(Line);
+			std::string Tag;
+			Stream >> Tag;
+
+			if (Tag == "v")
+			{
+				Vector3 P;
+				Stream >> P.X >> P.Y >> P.Z;
+				Out.Positions.push_back(P);
+			}
+			else if (Tag == "f")
+			{
+				std::vector<std::uint32_t> Face;
+				std::string Vertex;
+
+				while (Stream >> Vertex)
+				{
+					long Index = std::strtol(Vertex.c_str(), nullptr, 10);
+					Face.push_back(static_cast<std::uint32_t>(Index < 0 ? static_cast<long>(Out.Positions.size()) + Index : Index - 1));
+				}
+
+				for (std::size_t i = 2; i < Face.size(); ++i)
+				{
+					Out.Indices.insert(Out.Indices.end(), { Face[0], Face[i - 1], Face[i] });
+				}
+			}
+		}
+		return !Out.Indices.empty();
+	}
+
+	// Standard Cornell box dimensions, scaled from 555 units to 1.
+	void MakeCornellBox(RayTrace::Scene& Out, bool WithSphere)
+	{
+		const float S = 1.f / 555.f;
+
+		RayTrace::Material White, Red, Green, Light, Mirror;
+		White.Albedo = 0.73f * Color::White;
+		Red.Albedo = 0.65f * Color::Red + 0.05f * Color::White;
+		Green.Albedo = 0.45f * Color::Green + 0.12f * Color::White;
+		Light.Albedo = 0.78f * Color::White;
+		Light.Emission = 15.f * (Color::White - 0.25f * Color::Blue);
+		Mirror.Albedo = 0.95f * Color::White;
+		Mirror.Specular = 1.f;
+
+		std::uint32_t WhiteId = Out.AddMaterial(White), RedId = Out.AddMaterial(Red), GreenId = Out.AddMaterial(Green);
+		std::uint32_t LightId = Out.AddMaterial(Light), MirrorId = Out.AddMaterial(Mirror);
+
+		auto Add = [&Out](const Mesh& Source, std::uint32_t Material)
+		{
+			Out.AddMesh(Source.Positions.data(), Source.Positions.size(), Source.Indices.data(), Source.GetTriangleCount(), Material);
+		};
+
+		Mesh Walls, Left, Right, Lamp, Blocks;
+		Walls.AddQuad(Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(1, 0, 1), Vector3(0, 0, 1));
+		Walls.AddQuad(Vector3(0, 1, 0), Vector3(0, 1, 1), Vector3(1, 1, 1), Vector3(1, 1, 0));
+		Walls.AddQuad(Vector3(0, 0, 1), Vector3(1, 0, 1), Vector3(1, 1, 1), Vector3(0, 1, 1));
+		Left.AddQuad(Vector3(1, 0, 0), Vector3(1, 1, 0), Vector3(1, 1, 1), Vector3(1, 0, 1));
+		Right.AddQuad(Vector3(0, 0, 0), Vector3(0, 0, 1), Vector3(0, 1, 1), Vector3(0, 1, 0));
+		Lamp.AddQuad(Vector3(343 * S, 0.999f, 227 * S), Vector3(343 * S, 0.999f, 332 * S), Vector3(213 * S, 0.999f, 332 * S), Vector3(213 * S, 0.999f, 227 * S));
+		Blocks.AddBox(Vector3(185 * S, 82.5f * S, 169 * S), Vector3(82.5f * S, 82.5f * S, 82.5f * S), -0.314f);
+
+		Add(Walls, WhiteId);
+		Add(Left, RedId);
+		Add(Right, GreenId);
+		Add(Lamp, LightId);
+
+		if (WithSphere)
+		{
+			Add(MakeIcosphere(5, Vector3(370 * S, 100 * S, 350 * S), 100 * S), MirrorId);
+		}
+		else
+		{
+			Blocks.AddBox(Vector3(368 * S, 165 * S, 351 * S), Vector3(82.5f * S, 165 * S, 82.5f * S), 0.29f);
+		}
+		Add(Blocks, WhiteId);
+	}
+
+	RayTrace::Camera GetCornellCamera()
+	{
+		RayTrace::Camera View;
+		View.Eye.Set(0.5f, 0.5f, -1.4f);
+		View.Target.Set(0.5f, 0.5f, 0.f);
+		View.FovY = Math::ToRad(39.3f);
+		return View;
+	}
+
+	double Seconds(std::chrono::steady_clock::time_point Start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+	bool ReferenceHit(const Mesh& Source, const RayTrace::Ray& R, float& OutT)
+	{
+		bool Found = false;
+		OutT = Math::INF;
+
+		for (std::size_t i = 0; i < Source.GetTriangleCount(); ++i)
+		{
+			const Vector3& V0 = Source.Positions[Source.Indices[3 * i]];
+			Vector3 E1 = Source.Positions[Source.Indices[3 * i + 1]] - V0;
+			Vector3 E2 = Source.Positions[Source.Indices[3 * i + 2]] - V0;
+
+			Vector3 P = Vector3::Cross(R.Dir, E2);
+			float InvDet = 1.f / Vector3::Dot(E1, P);
+			Vector3 S = R.Origin - V0;
+			Vector3 Q = Vector3::Cross(S, E1);
+
+			float U = Vector3::Dot(S, P) * InvDet, V = Vector3::Dot(R.Dir, Q) * InvDet, T = Vector3::Dot(E2, Q) * InvDet;
+
+			if (U >= 0.f && V >= 0.f && U + V <= 1.f && T > 0.f && T < OutT)
+			{
+				OutT = T;
+				Found = true;
+			}
+		}
+		return Found;
+	}
+
+	int Verify()
+	{
+		Mesh Soup;
+
+		for (int i = 0; i < 3000; ++i)
+		{
+			Vector3 Center(Math::Random(-1.f, 1.f), Math::Random(-1.f, 1.f), Math::Random(-1.f, 1.f));
+			std::uint32_t Base = static_cast<std::uint32_t>(Soup.Positions.size());
+
+			for (int k = 0; k < 3; ++k)
+			{
+				Soup.Positions.push_back(Center + Vector3(Math::Random(-0.1f, 0.1f), Math::Random(-0.1f, 0.1f), Math::Random(-0.1f, 0.1f)));
+			}
+			Soup.Indices.insert(Soup.Indices.end(), { Base, Base + 1, Base + 2 });
+		}
+
+		// Many identical centres force the fallback split.
+		Mesh Stack = MakeIcosphere(0, Vector3::Zero, 1.f);
+
+		for (int i = 0; i < 40; ++i)
+		{
+			std::uint32_t Base = static_cast<std::uint32_t>(Stack.Positions.size());
+			Stack.Positions.insert(Stack.Positions.end(), { Vector3(-1, -1, 0.f), Vector3(1, -1, 0.f), Vector3(0, 1, 0.f) });
+			Stack.Indices.insert(Stack.Indices.end(), { Base, Base + 1, Base + 2 });
+		}
+
+		int Failures = 0;
+
+		for (const Mesh* Source : { &Soup, &Stack })
+		{
+			RayTrace::Bvh Built;
+			Built.Build(Source->Positions.data(), Source->Indices.data(), Source->GetTriangleCount());
+
+			// Growing the vector moves the tree; it must keep its storage.
+			const RayTrace::Bvh::Node* Storage = Built.GetNodes();
+			std::vector<RayTrace::Bvh> Trees;
+			Trees.push_back(std::move(Built));
+			Trees.emplace_back();
+
+			const RayTrace::Bvh& Tree = Trees[0];
+			Failures += Tree.GetNodes() == Storage && Built.IsEmpty() ? 0 : 1;
+			Failures += RayTrace::Bvh::MeasureDepth(Tree.GetNodes(), Tree.GetNodeCount()) <= RayTrace::Bvh::MAX_DEPTH ? 0 : 1;
+
+			for (int i = 0; i < 3000; ++i)
+			{
+				RayTrace::Ray R;
+				R.Origin.Set(Math::Random(-2.f, 2.f), Math::Random(-2.f, 2.f), Math::Random(-2.f, 2.f));
+				R.Dir = Vector3::Norm(Vector3(Math::Random(-1.f, 1.f), Math::Random(-1.f, 1.f), Math::Random(-1.f, 1.f)));
+
+				float Expected;
+				bool ExpectHit = ReferenceHit(*Source, R, Expected);
+
+				RayTrace::Hit Found;
+				bool GotHit = Tree.Intersect(R, Found);
+
+				if (GotHit != ExpectHit || (GotHit && Math::Abs(Found.T - Expected) > 1.0e-4f * (1.f + Expected)))
+				{
+					++Failures;
+				}
+
+				float Limit = Math::Random(0.1f, 3.f);
+				Failures += Tree.Occluded(R, Limit) == (ExpectHit && Expected < Limit) ? 0 : 1;
+			}
+		}
+
+		std::cout << "Reference checks : " << (Failures == 0 ? "passed" : "FAILED") << " (" << Failures << " failures)\n";
+		return Failures;
+	}
+
+	// Best of three runs, so the first cold pass over the tree does not count.
+	template <typename Fn>
+	double RayRate(std::size_t Count, Parallel::ThreadPool& Pool, Fn&& Trace)
+	{
+		double Best = 0.0;
+
+		for (int Run = 0; Run < 3; ++Run)
+		{
+			auto Start = std::chrono::steady_clock::now();
+
+			Pool.ForDynamic(Count, 1024, [&](std::size_t Begin, std::size_t End, unsigned)
+			{
+				for (std::size_t i = Begin; i < End; ++i)
+				{
+					Trace(i);
+				}
+			});
+			Best = std::max(Best, Count / Seconds(Start) * 1.0e-6);
+		}
+		return Best;
+	}
+
+	void BenchMesh(const Mesh& Source, std::uint32_t Size, Parallel::ThreadPool& Pool)
+	{
+		auto Start = std::chrono::steady_clock::now();
+		RayTrace::Bvh Tree;
+		Tree.Build(Source.Positions.data(), Source.Indices.data(), Source.GetTriangleCount());
+		double Build = Seconds(Start);
+
+		const RayTrace::Aabb& Bounds = Tree.GetBounds();
+		Vector3 Center = Bounds.GetCenter();
+		float Radius = 0.5f * (Bounds.Max - Bounds.Min).Length();
+
+		RayTrace::Scene Empty;
+		RayTrace::Framebuffer Frame(Size, Size);
+		RayTrace::Camera View;
+		View.Eye = Center + Radius * Vector3(0.9f, 0.9f, 1.6f);
+		View.Target = Center;
+		RayTrace::PathTracer Camera(Empty, View, Frame);
+
+		const std::size_t Count = static_cast<std::size_t>(Size) * Size;
+		std::vector<RayTrace::Ray> Primary(Count), Bounce(Count);
+		std::vector<RayTrace::Hit> Hits(Count);
+		std::vector<std::uint8_t> Valid(Count, 0);
+
+		for (std::size_t i = 0; i < Count; ++i)
+		{
+			Primary[i] = Camera.GetCameraRay(static_cast<float>(i % Size) + 0.5f, static_cast<float>(i / Size) + 0.5f);
+		}
+
+		double PrimaryRate = RayRate(Count, Pool, [&](std::size_t i) { Hits[i] = RayTrace::Hit(); Tree.Intersect(Primary[i], Hits[i]); });
+
+		// Incoherent rays: random directions leaving the primary hit points.
+		std::size_t NumBounce = 0;
+
+		for (std::size_t i = 0; i < Count; ++i)
+		{
+			if (Hits[i].IsHit())
+			{
+				Vector3 Dir(Math::Random(-1.f, 1.f), Math::Random(-1.f, 1.f), Math::Random(-1.f, 1.f));
+				Bounce[NumBounce].Origin = Primary[i].Origin + (Hits[i].T * 0.999f) * Primary[i].Dir;
+				Bounce[NumBounce].Dir = Vector3::Norm(Dir.Square() > 1.0e-6f ? Dir : Vector3::UnitY);
+				++NumBounce;
+			}
+		}
+
+		std::vector<RayTrace::Hit> BounceHits(NumBounce);
+		double BounceRate = NumBounce == 0 ? 0.0 : RayRate(NumBounce, Pool, [&](std::size_t i) { BounceHits[i] = RayTrace::Hit(); Tree.Intersect(Bounce[i], BounceHits[i]); });
+
+		Vector3 LightPos = Center + Vector3(0.f, 2.f * Radius, 0.f);
+		double ShadowRate = NumBounce == 0 ? 0.0 : RayRate(NumBounce, Pool, [&](std::size_t i)
+		{
+			Vector3 ToLight = LightPos - Bounce[i].Origin;
+			float Dist = ToLight.Length();
+			RayTrace::Ray Shadow = { Bounce[i].Origin, (1.f / Dist) * ToLight };
+			Valid[i] = Tree.Occluded(Shadow, Dist) ? 1 : 0;
+		});
+
+		std::printf("%-20s %9zu %9.1f %10.2f %10.2f %10.2f\n", Source.Name.c_str(), Source.GetTriangleCount(),
+			Build * 1.0e3, PrimaryRate, BounceRate, ShadowRate);
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	bool VerifyOnly = false;
+	const char* ObjPath = nullptr;
+	const char* OutPath = "pathtrace.ppm";
+	std::uint32_t Size = 256, Spp = 16;
+
+	for (int i = 1; i < Argc; ++i)
+	{
+		bool HasValue = i + 1 < Argc;
+
+		if (std::strcmp(Argv[i], "--verify") == 0) VerifyOnly = true;
+		else if (std::strcmp(Argv[i], "--obj") == 0 && HasValue) ObjPath = Argv[++i];
+		else if (std::strcmp(Argv[i], "--out") == 0 && HasValue) OutPath = Argv[++i];
+		else if (std::strcmp(Argv[i], "--size") == 0 && HasValue) Size = static_cast<std::uint32_t>(std::atoi(Argv[++i]));
+		else if (std::strcmp(Argv[i], "--spp") == 0 && HasValue) Spp = static_cast<std::uint32_t>(std::atoi(Argv[++i]));
+		else
+		{
+			std::cerr << "usage: RayTraceBench [--verify] [--obj Mesh.obj] [--size N] [--spp N] [--out Image.ppm]\n";
+			return 1;
+		}
+	}
+
+	Math::SeedRandom(42);
+
+	if (Verify() != 0)
+	{
+		return 1;
+	}
+
+	if (VerifyOnly)
+	{
+		return 0;
+	}
+
+	Parallel::ThreadPool& Pool = Parallel::ThreadPool::GetDefault();
+	std::printf("\n%ux%u rays per mesh, %u threads, Mrays/s\n", Size, Size, Pool.GetThreadCount());
+	std::printf("%-20s %9s %9s %10s %10s %10s\n", "mesh", "tris", "build ms", "primary", "diffuse", "shadow");
+
+	std::vector<Mesh> Meshes;
+	Meshes.push_back(MakeIcosphere(6, Vector3::Zero, 1.f));
+	Meshes.push_back(MakeTerrain(512));
+
+	if (ObjPath != nullptr)
+	{
+		Mesh Loaded;
+
+		if (!LoadObj(ObjPath, Loaded))
+		{
+			std::cerr << "cannot load " << ObjPath << '\n';
+			return 1;
+		}
+		Meshes.push_back(Loaded);
+	}
+
+	for (const Mesh& Iter : Meshes)
+	{
+		BenchMesh(Iter, Size, Pool);
+	}
+
+	RayTrace::Scene Cornell;
+	MakeCornellBox(Cornell, true);
+	Cornell.Build();
+
+	RayTrace::Framebuffer Frame(Size, Size);
+	RayTrace::PathTracer Tracer(Cornell, GetCornellCamera(), Frame);
+
+	auto Start = std::chrono::steady_clock::now();
+
+	for (std::uint32_t Pass = 0; Pass < Spp; ++Pass)
+	{
+		Tracer.RenderPass(Pool);
+	}
+
+	double Elapsed = Seconds(Start);
+
+	std::printf("\ncornell box (%zu tris) %ux%u, %u spp : %.2f s, %.2f Mrays/s (paths + shadow rays)\n",
+		Cornell.GetTriangleCount(), Size, Size, Spp, Elapsed, Tracer.GetRayCount() / Elapsed * 1.0e-6);
+
+	if (Frame.WritePpm(OutPath))
+	{
+		std::printf("wrote %s\n", OutPath);
+	}
+	return 0;
+}
@@ -0,0 +1,223 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+// Checks hash-grid neighbour queries against brute force, then runs 1M particles
+// through integrate -> rebuild -> neighbour density every frame.
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../MIR/SpatialHash.h"
+
+namespace
+{
+	double Millis(std::chrono::steady_clock::time_point Start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+	int Verify(Parallel::ThreadPool& Pool)
+	{
+		const std::size_t Count = 4000;
+		const float Radius = 0.7f;
+
+		std::vector<Vector3> Original(Count);
+
+		for (Vector3& Iter : Original)
+		{
+			Iter.Set(Math::Random(-8.f, 8.f), Math::Random(-8.f, 8.f), Math::Random(-8.f, 8.f));
+		}
+
+		// A tiny table forces many cells into each bucket, exercising the dedupe path.
+		Spatial::HashGrid Grid(1.f, 64);
+		std::vector<Vector3> Positions = Original;
+		Grid.Build(Positions.data(), Count, Pool);
+
+		int Failures = 0;
+
+		for (std::size_t i = 0; i < Count; ++i)
+		{
+			if ((Positions[i] - Original[Grid.GetOrder()[i]]).Square() != 0.f)
+			{
+				++Failures;
+			}
+
+			std::size_t Expected = 0, Found = 0;
+
+			for (std::size_t j = 0; j < Count; ++j)
+			{
+				Expected += (Positions[j] - Positions[i]).Square() <= Radius * Radius ? 1 : 0;
+			}
+
+			Grid.QueryRadius(Positions[i], Radius, [&](std::uint32_t, float) { ++Found; });
+			Failures += Found == Expected ? 0 : 1;
+		}
+
+		// Radii beyond three cells: the heap bucket list (many buckets) and the
+		// full scan (cells outnumber buckets).
+		Spatial::HashGrid Wide(1.f, 1 << 16);
+		Wide.Build(Positions.data(), Count, Pool);
+
+		for (float Large : { 4.5f, 30.f })
+		{
+			for (std::size_t i = 0; i < Count; i += 97)
+			{
+				std::size_t Expected = 0, Found = 0, FoundTiny = 0;
+
+				for (std::size_t j = 0; j < Count; ++j)
+				{
+					Expected += (Positions[j] - Positions[i]).Square() <= Large * Large ? 1 : 0;
+				}
+
+				Wide.QueryRadius(Positions[i], Large, [&](std::uint32_t, float) { ++Found; });
+				Grid.QueryRadius(Positions[i], Large, [&](std::uint32_t, float) { ++FoundTiny; });
+				Failures += Found == Expected && FoundTiny == Expected ? 0 : 1;
+			}
+		}
+
+		// Several threads sharing one pool; dispatches must not trample each other.
+		{
+			Parallel::ThreadPool Shared(3);
+			std::vector<std::thread> Callers;
+			std::atomic<int> Wrong(0);
+
+			for (int t = 0; t < 4; ++t)
+			{
+				Callers.emplace_back([&Shared, &Wrong, t]()
+				{
+					for (int Round = 0; Round < 200; ++Round)
+					{
+						std::vector<int> Marks(1000 + t, 0);
+						Shared.For(Marks.size(), [&](std::size_t Begin, std::size_t End, unsigned)
+						{
+							for (std::size_t i = Begin; i < End; ++i)
+							{
+								++Marks[i];
+							}
+						});
+
+						for (int Iter : Marks)
+						{
+							Wrong += Iter == 1 ? 0 : 1;
+						}
+					}
+				});
+			}
+
+			for (std::thread& Iter : Callers)
+			{
+				Iter.join();
+			}
+			Failures += Wrong.load() == 0 ? 0 : 1;
+		}
+
+		std::cout << "Reference checks : " << (Failures == 0 ? "passed" : "FAILED") << " (" << Failures << " failures)\n\n";
+		return Failures;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	bool VerifyOnly = Argc > 1 && std::strcmp(Argv[1], "--verify") == 0;
+
+	Math::SeedRandom(42);
+	Parallel::ThreadPool& Pool = Parallel::ThreadPool::GetDefault();
+
+	if (Verify(Pool) != 0)
+	{
+		return 1;
+	}
+
+	if (VerifyOnly)
+	{
+		return 0;
+	}
+
+	const std::size_t Count = 1000000;
+	const float Extent = 50.f;
+	const float Radius = 1.f;
+	const float Dt = 0.016f;
+	const int Frames = 10;
+
+	std::vector<Vector3> Positions(Count), Velocities(Count);
+	std::vector<float> Density(Count);
+
+	for (std::size_t i = 0; i < Count; ++i)
+	{
+		Positions[i].Set(Math::Random(0.f, Extent), Math::Random(0.f, Extent), Math::Random(0.f, Extent));
+		Velocities[i].Set(Math::Random(-1.f, 1.f), Math::Random(-1.f, 1.f), Math::Random(-1.f, 1.f));
+	}
+
+	Spatial::HashGrid Grid(Radius);
+
+	double Integrate = 0.0, Build = 0.0, Query = 0.0;
+	std::size_t Neighbours = 0;
+
+	std::cout << "Particles : " << Count << ", threads : " << Pool.GetThreadCount() << '\n';
+
+	for (int Frame = 0; Frame < Frames; ++Frame)
+	{
+		auto Start = std::chrono::steady_clock::now();
+
+		Pool.For(Count, [&](std::size_t Begin, std::size_t End, unsigned)
+		{
+			for (std::size_t i = Begin; i < End; ++i)
+			{
+				Vector3& P = Positions[i];
+				Vector3& V = Velocities[i];
+				P += Dt * V;
+
+				if (P.X < 0.f || P.X > Extent) V.X = -V.X;
+				if (P.Y < 0.f || P.Y > Extent) V.Y = -V.Y;
+				if (P.Z < 0.f || P.Z > Extent) V.Z = -V.Z;
+			}
+		});
+
+		Integrate += Millis(Start);
+		Start = std::chrono::steady_clock::now();
+
+		Grid.Build(Positions.data(), Count, Pool);
+		Grid.Reorder(Velocities.data(), Pool);
+
+		Build += Millis(Start);
+		Start = std::chrono::steady_clock::now();
+
+		std::vector<std::size_t> PerWorker(Pool.GetThreadCount(), 0);
+
+		Pool.ForDynamic(Count, 4096, [&](std::size_t Begin, std::size_t End, unsigned Worker)
+		{
+			std::size_t Local = 0;
+
+			for (std::size_t i = Begin; i < End; ++i)
+			{
+				float Sum = 0.f;
+
+				// Poly6-style kernel, the density term of an SPH step.
+				Grid.QueryRadius(Positions[i], Radius, [&](std::uint32_t, float DistSq)
+				{
+					float W = Radius * Radius - DistSq;
+					Sum += W * W * W;
+					++Local;
+				});
+				Density[i] = Sum;
+			}
+			PerWorker[Worker] += Local;
+		});
+
+		Query += Millis(Start);
+
+		for (std::size_t Iter : PerWorker)
+		{
+			Neighbours += Iter;
+		}
+	}
+
+	std::cout << "integrate : " << Integrate / Frames << " ms/frame\n";
+	std::cout << "rebuild   : " << Build / Frames << " ms/frame (" << Count * Frames / (Build * 1.0e3) << " Mparticles/s)\n";
+	std::cout << "neighbour : " << Query / Frames << " ms/frame (" << static_cast<double>(Neighbours) / (Count * Frames) << " avg neighbours)\n";
+	std::cout << "frame     : " << (Integrate + Build + Query) / Frames << " ms\n";
+	return 0;
+}
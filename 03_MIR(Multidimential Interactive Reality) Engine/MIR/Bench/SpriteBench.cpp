@@ -0,0 +1,523 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+// Checks the 2D transform path, the radix sort, the vertex ring and the
+// rasterizer's coverage, then measures sprites/ms of the batched pipeline
+// against a per-sprite Matrix3 / Vector2::Transform loop, and rasterizes one
+// frame to PPM.
+//
+//   SpriteBench [--verify] [--count N] [--frames N] [--out Image.ppm] [--dump Frame.bin]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../MIR/Sprite.h"
+
+namespace
+{
+	const std::uint32_t WIDTH = 1280;
+	const std::uint32_t HEIGHT = 720;
+	const std::uint16_t TEXTURES = 64;
+	const std::uint16_t LAYERS = 8;
+
+	double Millis(std::chrono::steady_clock::time_point Start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+	bool IsNear(const Vector2& Left, const Vector2& Right, float Tolerance = 1e-3f)
+	{
+		return Math::Abs(Left.X - Right.X) <= Tolerance && Math::Abs(Left.Y - Right.Y) <= Tolerance;
+	}
+
+	// Game-side sprite state, as an entity system would hold it.
+	struct SpriteState
+	{
+		Vector2 Position;
+		Vector2 Velocity;
+		Vector2 Size;
+		float Rotation;
+		float Spin;
+		std::uint16_t Texture;
+		std::uint16_t Layer;
+		std::uint32_t Color;
+		Sprite::UvRect Uv;
+	};
+
+	std::vector<SpriteState> MakeSprites(std::size_t Count)
+	{
+		std::vector<SpriteState> Sprites(Count);
+
+		for (SpriteState& Iter : Sprites)
+		{
+			float Size = Math::Random(4.f, 24.f);
+			int Cell = static_cast<int>(Math::Random(0.f, 3.999f)) * 4 + static_cast<int>(Math::Random(0.f, 3.999f));
+
+			Iter.Position.Set(Math::Random(0.f, static_cast<float>(WIDTH)), Math::Random(0.f, static_cast<float>(HEIGHT)));
+			Iter.Velocity.Set(Math::Random(-2.f, 2.f), Math::Random(-2.f, 2.f));
+			Iter.Size.Set(Size, Size * Math::Random(0.75f, 1.25f));
+			Iter.Rotation = Math::Random(0.f, 2.f * Math::PI);
+			Iter.Spin = Math::Random(-0.05f, 0.05f);
+			Iter.Texture = static_cast<std::uint16_t>(Math::Random(0.f, TEXTURES - 0.001f));
+			Iter.Layer = static_cast<std::uint16_t>(Math::Random(0.f, LAYERS - 0.001f));
+			Iter.Color = Sprite::MakeColor(static_cast<std::uint8_t>(Math::Random(128.f, 255.f)),
+				static_cast<std::uint8_t>(Math::Random(128.f, 255.f)), static_cast<std::uint8_t>(Math::Random(128.f, 255.f)), 230);
+			Iter.Uv = { (Cell % 4) * 0.25f, (Cell / 4) * 0.25f, (Cell % 4 + 1) * 0.25f, (Cell / 4 + 1) * 0.25f };
+		}
+		return Sprites;
+	}
+
+	void Animate(std::vector<SpriteState>& Sprites)
+	{
+		for (SpriteState& Iter : Sprites)
+		{
+			Iter.Position += Iter.Velocity;
+			Iter.Rotation += Iter.Spin;
+
+			if (Iter.Position.X < 0.f || Iter.Position.X > WIDTH) Iter.Velocity.X = -Iter.Velocity.X;
+			if (Iter.Position.Y < 0.f || Iter.Position.Y > HEIGHT) Iter.Velocity.Y = -Iter.Velocity.Y;
+		}
+	}
+
+	// 4 x 4 atlas of 8 x 8 cells, each cell a disc on a transparent background.
+	Sprite::Texture MakeAtlas(std::uint32_t Seed)
+	{
+		Sprite::Texture Atlas;
+		Atlas.Width = 32;
+		Atlas.Height = 32;
+		Atlas.Texels.resize(32 * 32);
+
+		for (std::uint32_t Y = 0; Y < 32; ++Y)
+		{
+			for (std::uint32_t X = 0; X < 32; ++X)
+			{
+				float Dx = (X % 8) - 3.5f, Dy = (Y % 8) - 3.5f;
+				std::uint32_t Cell = (Y / 8) * 4 + X / 8 + Seed;
+				std::uint8_t Alpha = Dx * Dx + Dy * Dy < 16.f ? 255 : 0;
+
+				Atlas.Texels[Y * 32 + X] = Sprite::MakeColor(static_cast<std::uint8_t>(64 + (Cell * 37) % 192),
+					static_cast<std::uint8_t>(64 + (Cell * 91) % 192), static_cast<std::uint8_t>(64 + (Cell * 53) % 192), Alpha);
+			}
+		}
+		return Atlas;
+	}
+
+	// What a 2D renderer does without batching: three Matrix3 products and four
+	// Vector2::Transform calls per sprite, then a comparison sort of the quads.
+	struct NaiveQuad
+	{
+		std::uint32_t Key;
+		Sprite::Vertex Corners[4];
+	};
+
+	void BuildNaive(const std::vector<SpriteState>& Sprites, std::vector<NaiveQuad>& Quads, std::vector<Sprite::Vertex>& Out)
+	{
+		static const Vector2 Corners[4] = { Vector2(-0.5f, -0.5f), Vector2(0.5f, -0.5f), Vector2(0.5f, 0.5f), Vector2(-0.5f, 0.5f) };
+
+		Quads.resize(Sprites.size());
+
+		for (std::size_t i = 0; i < Sprites.size(); ++i)
+		{
+			const SpriteState& Source = Sprites[i];
+			Matrix3 World = Matrix3::CreateScale(Source.Size) * Matrix3::CreateRotation(Source.Rotation) * Matrix3::CreateTranslation(Source.Position);
+			float U[4] = { Source.Uv.U0, Source.Uv.U1, Source.Uv.U1, Source.Uv.U0 };
+			float V[4] = { Source.Uv.V0, Source.Uv.V0, Source.Uv.V1, Source.Uv.V1 };
+
+			Quads[i].Key = (static_cast<std::uint32_t>(Source.Layer) << 16) | Source.Texture;
+
+			for (int c = 0; c < 4; ++c)
+			{
+				Vector2 Corner = Vector2::Transform(Corners[c], World);
+				Quads[i].Corners[c] = { Corner.X, Corner.Y, U[c], V[c], Source.Color };
+			}
+		}
+
+		std::stable_sort(Quads.begin(), Quads.end(), [](const NaiveQuad& Left, const NaiveQuad& Right) { return Left.Key < Right.Key; });
+
+		Out.resize(4 * Quads.size());
+
+		for (std::size_t i = 0; i < Quads.size(); ++i)
+		{
+			std::memcpy(&Out[4 * i], Quads[i].Corners, sizeof(Quads[i].Corners));
+		}
+	}
+
+	void Fill(Sprite::Batch& Batch, const std::vector<SpriteState>& Sprites)
+	{
+		Batch.Clear();
+
+		for (const SpriteState& Iter : Sprites)
+		{
+			Batch.Add(Iter.Position, Iter.Size, Iter.Rotation, Iter.Texture, Iter.Layer, Iter.Color, Iter.Uv);
+		}
+	}
+
+	int Verify()
+	{
+		int Failures = 0;
+		auto Check = [&Failures](bool Condition, const char* What)
+		{
+			if (!Condition)
+			{
+				std::cout << "  failed : " << What << '\n';
+				++Failures;
+			}
+		};
+
+		// Vector2::Transform against the row-vector product written out.
+		Check(IsNear(Vector2::Transform(Vector2::UnitX, Matrix3::CreateRotation(Math::PI / 2.f)), Vector2::UnitY, 1e-6f), "Vector2::Transform rotation");
+
+		for (int i = 0; i < 100; ++i)
+		{
+			Vector2 Scale(Math::Random(-4.f, 4.f), Math::Random(-4.f, 4.f));
+			Vector2 Move(Math::Random(-100.f, 100.f), Math::Random(-100.f, 100.f));
+			Vector2 Point(Math::Random(-10.f, 10.f), Math::Random(-10.f, 10.f));
+			float Rad = Math::Random(-Math::PI, Math::PI);
+
+			Matrix3 Composed = Matrix3::CreateScale(Scale) * Matrix3::CreateRotation(Rad) * Matrix3::CreateTranslation(Move);
+			Matrix3 Direct = Matrix3::CreateAffine(Scale, Rad, Move);
+			bool IsSame = true;
+
+			for (int r = 0; r < 3; ++r)
+			{
+				for (int c = 0; c < 3; ++c)
+				{
+					IsSame = IsSame && Math::Abs(Composed.Mat[r][c] - Direct.Mat[r][c]) <= 1e-4f;
+				}
+			}
+			Check(IsSame, "Matrix3::CreateAffine");
+
+			const float (&M)[3][3] = Direct.Mat;
+			Vector2 Expected(Point.X * M[0][0] + Point.Y * M[1][0] + M[2][0], Point.X * M[0][1] + Point.Y * M[1][1] + M[2][1]);
+			Check(IsNear(Vector2::Transform(Point, Direct), Expected), "Vector2::Transform");
+		}
+
+		// Radix sort against std::stable_sort on the key, for full 32-bit keys,
+		// sprite-like keys and a single key (every pass skipped).
+		for (std::uint32_t Mask : { 0xFFFFFFFFu, 0x0007003Fu, 0u })
+		{
+			for (std::size_t Count : { std::size_t(1), std::size_t(7), std::size_t(5000) })
+			{
+				std::vector<std::uint64_t> Items(Count), Scratch(Count);
+
+				for (std::size_t i = 0; i < Count; ++i)
+				{
+					std::uint32_t Key = (static_cast<std::uint32_t>(std::rand()) * 2654435761u ^ static_cast<std::uint32_t>(std::rand())) & Mask;
+					Items[i] = (static_cast<std::uint64_t>(Key) << 32) | i;
+				}
+
+				std::vector<std::uint64_t> Expected = Items;
+				std::stable_sort(Expected.begin(), Expected.end(), [](std::uint64_t Left, std::uint64_t Right) { return (Left >> 32) < (Right >> 32); });
+
+				Sprite::RadixSort(Items.data(), Scratch.data(), Count);
+				Check(Items == Expected, "radix sort");
+			}
+		}
+
+		// Batched corners match a per-sprite Matrix3, through both Add() forms and
+		// with a count that leaves a scalar tail.
+		std::vector<SpriteState> Sprites = MakeSprites(1003);
+		Sprite::Batch Batch;
+		Fill(Batch, Sprites);
+
+		Matrix3 Extra = Matrix3::CreateScale(Vector2(3.f, -2.f)) * Matrix3::CreateRotation(0.3f) * Matrix3::CreateTranslation(Vector2(40.f, 50.f));
+		Batch.Add(Extra, 5, 0);
+		Batch.Sort();
+		Batch.Transform();
+
+		static const Vector2 Corners[4] = { Vector2(-0.5f, -0.5f), Vector2(0.5f, -0.5f), Vector2(0.5f, 0.5f), Vector2(-0.5f, 0.5f) };
+		bool IsCornerOk = true;
+
+		for (std::size_t i = 0; i <= Sprites.size(); ++i)
+		{
+			Matrix3 World = i < Sprites.size() ? Matrix3::CreateAffine(Sprites[i].Size, Sprites[i].Rotation, Sprites[i].Position) : Extra;
+
+			for (int c = 0; c < 4; ++c)
+			{
+				IsCornerOk = IsCornerOk && IsNear(Batch.GetCorner(i, c), Vector2::Transform(Corners[c], World));
+			}
+		}
+		Check(IsCornerOk, "batched corners");
+
+		// Emit: commands in (layer, texture) order, covering every sprite once.
+		Sprite::VertexRing Ring(4 * 4096);
+		Sprite::RingSpan Span;
+		std::vector<Sprite::DrawCommand> Commands;
+		Check(Batch.Emit(Ring, Span, Commands) && Span.Count == 4 * Batch.GetCount(), "emit");
+
+		std::size_t Covered = 0;
+		bool IsOrdered = true;
+
+		for (std::size_t i = 0; i < Commands.size(); ++i)
+		{
+			std::uint32_t Key = (static_cast<std::uint32_t>(Commands[i].Layer) << 16) | Commands[i].Texture;
+			std::uint32_t Prev = i > 0 ? (static_cast<std::uint32_t>(Commands[i - 1].Layer) << 16) | Commands[i - 1].Texture : 0;
+
+			IsOrdered = IsOrdered && (i == 0 || Prev < Key) && Commands[i].FirstVertex == Span.First + 4 * Covered;
+			Covered += Commands[i].SpriteCount;
+		}
+		Check(IsOrdered && Covered == Batch.GetCount(), "draw commands");
+
+		// Ring: frames never straddle the end and never overwrite unreleased ones.
+		{
+			Sprite::VertexRing Small(100);
+			Sprite::RingSpan A, B, C, D;
+
+			Check(Small.Acquire(40, A) != nullptr && A.First == 0, "ring first");
+			Check(Small.Acquire(40, B) != nullptr && B.First == 40, "ring second");
+			Check(Small.Acquire(40, C) == nullptr, "ring full");
+
+			Small.Release(A);
+			Check(Small.Acquire(40, C) != nullptr && C.First == 0 && Small.GetInFlight() == 100, "ring wrap");
+			Check(Small.Acquire(1, D) == nullptr, "ring full after wrap");
+
+			Small.Release(B);
+			Check(Small.Acquire(41, D) == nullptr && Small.Acquire(40, D) != nullptr && D.First == 40, "ring reuse");
+			Check(Small.Acquire(101, D) == nullptr, "ring oversize");
+		}
+
+		// Coverage: a pixel-aligned 16 x 16 sprite covers exactly 256 pixels, and
+		// two sprites sharing an edge cover 512 with no pixel drawn twice.
+		{
+			Sprite::Texture Quads;
+			Quads.Width = 2;
+			Quads.Height = 2;
+			Quads.Texels = { Sprite::MakeColor(255, 0, 0), Sprite::MakeColor(0, 255, 0), Sprite::MakeColor(0, 0, 255), Sprite::WHITE };
+
+			Sprite::Rasterizer Target(40, 32);
+			Target.SetTexture(1, Quads);
+			Target.Clear(0xFF000000u);
+
+			Sprite::Batch Pair;
+			Pair.Add(Vector2(10.f, 10.f), Vector2(16.f, 16.f), 0.f, 1, 0);
+			Pair.Add(Vector2(26.f, 10.f), Vector2(16.f, 16.f), 0.f, 0, 0, Sprite::MakeColor(255, 255, 255, 128));
+
+			Sprite::VertexRing PairRing(8);
+			Check(Pair.Build(PairRing, Span, Commands), "pair build");
+			Target.Draw(PairRing.GetData(), Commands.data(), Commands.size());
+
+			Check(Target.GetPixelsWritten() == 512, "shared edge coverage");
+			Check(Target.GetPixel(2, 2) == Sprite::MakeColor(255, 0, 0) && Target.GetPixel(17, 2) == Sprite::MakeColor(0, 255, 0)
+				&& Target.GetPixel(2, 17) == Sprite::MakeColor(0, 0, 255) && Target.GetPixel(17, 17) == Sprite::WHITE, "texel sampling");
+			Check(Target.GetPixel(1, 1) == 0xFF000000u && Target.GetPixel(18, 18) == 0xFF000000u, "coverage bounds");
+			Check((Target.GetPixel(20, 5) & 0xFF) == 128, "alpha blend");
+		}
+
+		// The image does not depend on the thread count.
+		{
+			std::vector<SpriteState> Many = MakeSprites(3000);
+			Sprite::Batch Frame;
+			Fill(Frame, Many);
+
+			Sprite::VertexRing FrameRing(4 * Many.size());
+			Check(Frame.Build(FrameRing, Span, Commands), "frame build");
+
+			Parallel::ThreadPool Single(1), Multi(4);
+			Sprite::Rasterizer One(320, 200), Four(320, 200);
+
+			for (Sprite::Rasterizer* Iter : { &One, &Four })
+			{
+				for (std::uint16_t t = 0; t < TEXTURES; ++t)
+				{
+					Iter->SetTexture(t, MakeAtlas(t));
+				}
+				Iter->Clear(0xFF202020u);
+			}
+
+			One.Draw(FrameRing.GetData(), Commands.data(), Commands.size(), Single);
+			Four.Draw(FrameRing.GetData(), Commands.data(), Commands.size(), Multi);
+
+			bool IsSame = One.GetPixelsWritten() == Four.GetPixelsWritten();
+
+			for (std::uint32_t Y = 0; IsSame && Y < 200; ++Y)
+			{
+				for (std::uint32_t X = 0; IsSame && X < 320; ++X)
+				{
+					IsSame = One.GetPixel(X, Y) == Four.GetPixel(X, Y);
+				}
+			}
+			Check(IsSame && One.GetPixelsWritten() > 0, "thread count independence");
+		}
+
+		std::cout << "Reference checks : " << (Failures == 0 ? "passed" : "FAILED") << " (" << Failures << " failures)\n\n";
+		return Failures;
+	}
+
+	void BenchCount(std::size_t Count, int Frames)
+	{
+		std::vector<SpriteState> Sprites = MakeSprites(Count);
+
+		std::vector<NaiveQuad> Quads;
+		std::vector<Sprite::Vertex> NaiveOut;
+		double NaiveMs = 0.0;
+
+		Sprite::Batch Batch;
+		Batch.Reserve(Count);
+
+		// Three frames in flight: frame N is written while N - 1 and N - 2 are
+		// still owned by the consumer.
+		const int IN_FLIGHT = 3;
+		Sprite::VertexRing Ring(IN_FLIGHT * 4 * Count);
+		std::vector<Sprite::RingSpan> Spans;
+		std::vector<Sprite::DrawCommand> Commands;
+
+		double AddMs = 0.0, SortMs = 0.0, TransformMs = 0.0, EmitMs = 0.0;
+
+		for (int Frame = -IN_FLIGHT; Frame < Frames; ++Frame)
+		{
+			Animate(Sprites);
+
+			auto Start = std::chrono::steady_clock::now();
+			BuildNaive(Sprites, Quads, NaiveOut);
+			double Naive = Millis(Start);
+
+			Start = std::chrono::steady_clock::now();
+			Fill(Batch, Sprites);
+			double Add = Millis(Start);
+
+			Start = std::chrono::steady_clock::now();
+			Batch.Sort();
+			double Sort = Millis(Start);
+
+			Start = std::chrono::steady_clock::now();
+			Batch.Transform();
+			double Transform = Millis(Start);
+
+			if (Spans.size() == IN_FLIGHT)
+			{
+				Ring.Release(Spans.front());
+				Spans.erase(Spans.begin());
+			}
+
+			Sprite::RingSpan Span;
+			Start = std::chrono::steady_clock::now();
+			bool IsEmitted = Batch.Emit(Ring, Span, Commands);
+			double Emit = Millis(Start);
+
+			if (!IsEmitted)
+			{
+				std::cout << "ring overflow\n";
+				return;
+			}
+			Spans.push_back(Span);
+
+			if (Frame >= 0)
+			{
+				NaiveMs += Naive;
+				AddMs += Add;
+				SortMs += Sort;
+				TransformMs += Transform;
+				EmitMs += Emit;
+			}
+		}
+
+		double BatchMs = (AddMs + SortMs + TransformMs + EmitMs) / Frames;
+		NaiveMs /= Frames;
+
+		std::printf("%9zu %9.3f %9.3f %9.3f %9.3f %9.3f %10.0f %10.0f %7.1fx %6zu\n", Count,
+			AddMs / Frames, SortMs / Frames, TransformMs / Frames, EmitMs / Frames, BatchMs,
+			Count / NaiveMs, Count / BatchMs, NaiveMs / BatchMs, Commands.size());
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	bool VerifyOnly = false;
+	std::size_t Count = 100000;
+	int Frames = 20;
+	const char* OutPath = "sprites.ppm";
+	const char* DumpPath = nullptr;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--verify"))
+		{
+			VerifyOnly = true;
+		}
+		else if (!std::strcmp(argv[i], "--count") && i + 1 < argc)
+		{
+			Count = static_cast<std::size_t>(Math::Max(1, std::atoi(argv[++i])));
+		}
+		else if (!std::strcmp(argv[i], "--frames") && i + 1 < argc)
+		{
+			Frames = Math::Max(1, std::atoi(argv[++i]));
+		}
+		else if (!std::strcmp(argv[i], "--out") && i + 1 < argc)
+		{
+			OutPath = argv[++i];
+		}
+		else if (!std::strcmp(argv[i], "--dump") && i + 1 < argc)
+		{
+			DumpPath = argv[++i];
+		}
+		else
+		{
+			std::cout << "Usage : SpriteBench [--verify] [--count N] [--frames N] [--out Image.ppm] [--dump Frame.bin]\n";
+			return 1;
+		}
+	}
+
+	Math::SeedRandom(11);
+
+	if (Verify() != 0)
+	{
+		return 1;
+	}
+
+	if (VerifyOnly)
+	{
+		return 0;
+	}
+
+	std::printf("per-frame ms (batched stages), %d frames, %u textures x %u layers\n", Frames, TEXTURES, LAYERS);
+	std::printf("%9s %9s %9s %9s %9s %9s %10s %10s %8s %6s\n",
+		"sprites", "add", "sort", "transform", "emit", "batched", "naive/ms", "batch/ms", "speedup", "draws");
+
+	for (std::size_t Iter : { Count / 10, Count, Count * 10 })
+	{
+		BenchCount(Math::Max<std::size_t>(Iter, 1), Iter > Count ? Math::Max(1, Frames / 4) : Frames);
+	}
+
+	// One frame through the ring into the rasterizer.
+	std::vector<SpriteState> Sprites = MakeSprites(Count);
+	Sprite::Batch Batch;
+	Fill(Batch, Sprites);
+
+	Sprite::VertexRing Ring(4 * Count);
+	Sprite::RingSpan Span;
+	std::vector<Sprite::DrawCommand> Commands;
+	Batch.Build(Ring, Span, Commands);
+
+	Parallel::ThreadPool& Pool = Parallel::ThreadPool::GetDefault();
+	Sprite::Rasterizer Target(WIDTH, HEIGHT);
+
+	for (std::uint16_t t = 0; t < TEXTURES; ++t)
+	{
+		Target.SetTexture(t, MakeAtlas(t));
+	}
+
+	Target.Clear(0xFF201810u);
+	auto Start = std::chrono::steady_clock::now();
+	Target.Draw(Ring.GetData(), Commands.data(), Commands.size(), Pool);
+	double DrawMs = Millis(Start);
+
+	std::printf("\nrasterize %zu sprites %ux%u, %u threads : %.1f ms, %.1f Mpixels/s, %.0f sprites/ms\n",
+		Count, WIDTH, HEIGHT, Pool.GetThreadCount(), DrawMs, Target.GetPixelsWritten() / DrawMs * 1.0e-3, Count / DrawMs);
+
+	if (Target.WritePpm(OutPath))
+	{
+		std::printf("wrote %s\n", OutPath);
+	}
+
+	if (DumpPath != nullptr && Sprite::DumpFrame(DumpPath, Ring, Span, Commands))
+	{
+		std::printf("wrote %s (%zu commands, %u vertices)\n", DumpPath, Commands.size(), Span.Count);
+	}
+	Ring.Release(Span);
+	return 0;
+}
@@ -0,0 +1,687 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#include "Asset.h"
+#include "Memory.h"
+#include "Profiler.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Asset
+{
+	namespace
+	{
+		template <typename T>
+		bool FixRef(Ref<T>& Field, std::size_t Count, const std::uint8_t* Base, std::uint64_t Size)
+		{
+			std::uint64_t Offset = Field.Offset;
+
+			if (Offset % alignof(T) != 0 || Offset > Size || Count > (Size - Offset) / sizeof(T))
+			{
+				return false;
+			}
+
+			Field.Ptr = reinterpret_cast<const T*>(Base + Offset);
+			return true;
+		}
+
+		bool IsValidIndices(const MeshRecord& Mesh)
+		{
+			std::size_t Count = 3 * static_cast<std::size_t>(Mesh.TriangleCount);
+
+			for (std::size_t i = 0; i < Count; ++i)
+			{
+				if (Mesh.Indices.Ptr[i] >= Mesh.VertexCount)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// The builder emits every node before its children, so requiring child
+		// indices to grow also rules out cycles. Depth is checked last, as
+		// traversal only has stack room for Bvh::MAX_DEPTH levels.
+		bool IsValidBvh(const MeshRecord& Mesh)
+		{
+			using RayTrace::Bvh;
+
+			for (std::uint32_t n = 0; n < Mesh.BvhNodeCount; ++n)
+			{
+				const Bvh::Node& Node = Mesh.BvhNodes.Ptr[n];
+
+				for (std::uint32_t i = 0; i < Bvh::WIDTH; ++i)
+				{
+					std::uint32_t Child = Node.Child[i];
+
+					if (Child == Bvh::EMPTY)
+					{
+						continue;
+					}
+
+					if ((Child & Bvh::LEAF) != 0)
+					{
+						std::uint64_t End = static_cast<std::uint64_t>(Child & ~Bvh::LEAF) + Node.Count[i];
+
+						if (End > Mesh.BvhBlockCount)
+						{
+							return false;
+						}
+					}
+					else if (Child <= n || Child >= Mesh.BvhNodeCount)
+					{
+						return false;
+					}
+				}
+			}
+
+			for (std::uint32_t b = 0; b < Mesh.BvhBlockCount; ++b)
+			{
+				for (std::uint32_t Lane = 0; Lane < Bvh::WIDTH; ++Lane)
+				{
+					if (Mesh.BvhBlocks.Ptr[b].Id[Lane] >= Mesh.TriangleCount)
+					{
+						return false;
+					}
+				}
+			}
+			return Bvh::MeasureDepth(Mesh.BvhNodes.Ptr, Mesh.BvhNodeCount) <= Bvh::MAX_DEPTH;
+		}
+
+		RayTrace::Aabb TransformBounds(const RayTrace::Aabb& Box, const Matrix4& World)
+		{
+			RayTrace::Aabb Temp;
+
+			if (Box.IsEmpty())
+			{
+				return Temp;
+			}
+
+			for (int i = 0; i < 8; ++i)
+			{
+				Vector3 Corner((i & 1) ? Box.Max.X : Box.Min.X, (i & 2) ? Box.Max.Y : Box.Min.Y, (i & 4) ? Box.Max.Z : Box.Min.Z);
+				Temp.Grow(Vector3::Transform(Corner, World));
+			}
+			return Temp;
+		}
+
+		// Places one array in a chunk under construction and returns its offset.
+		template <typename T>
+		std::uint64_t Place(std::uint64_t& Cursor, std::size_t Count)
+		{
+			std::uint64_t Offset = Memory::AlignUp(static_cast<std::size_t>(Cursor), STREAM_ALIGN);
+			Cursor = Offset + sizeof(T) * Count;
+			return Offset;
+		}
+
+		bool WritePadding(std::FILE* File, std::uint64_t& Written, std::uint64_t Target)
+		{
+			static const std::uint8_t Zero[CHUNK_ALIGN] = {};
+
+			while (Written < Target)
+			{
+				std::size_t Size = static_cast<std::size_t>(Math::Min<std::uint64_t>(Target - Written, CHUNK_ALIGN));
+
+				if (std::fwrite(Zero, 1, Size, File) != Size)
+				{
+					return false;
+				}
+				Written += Size;
+			}
+			return true;
+		}
+	}
+
+	bool Fixup(MeshRecord& Mesh, const std::uint8_t* ChunkBase, std::uint64_t ChunkSize)
+	{
+		if (reinterpret_cast<std::uintptr_t>(ChunkBase) % STREAM_ALIGN != 0)
+		{
+			return false;
+		}
+
+		std::size_t Vertices = Mesh.VertexCount;
+
+		return FixRef(Mesh.PositionX, Vertices, ChunkBase, ChunkSize)
+			&& FixRef(Mesh.PositionY, Vertices, ChunkBase, ChunkSize)
+			&& FixRef(Mesh.PositionZ, Vertices, ChunkBase, ChunkSize)
+			&& FixRef(Mesh.NormalX, Vertices, ChunkBase, ChunkSize)
+			&& FixRef(Mesh.NormalY, Vertices, ChunkBase, ChunkSize)
+			&& FixRef(Mesh.NormalZ, Vertices, ChunkBase, ChunkSize)
+			&& FixRef(Mesh.Indices, 3 * static_cast<std::size_t>(Mesh.TriangleCount), ChunkBase, ChunkSize)
+			&& FixRef(Mesh.BvhNodes, Mesh.BvhNodeCount, ChunkBase, ChunkSize)
+			&& FixRef(Mesh.BvhBlocks, Mesh.BvhBlockCount, ChunkBase, ChunkSize)
+			&& IsValidIndices(Mesh)
+			&& IsValidBvh(Mesh);
+	}
+
+	bool IsValidLayout(const FileHeader& Header, const MeshRecord* Meshes, std::uint64_t FileSize)
+	{
+		std::uint64_t MeshEnd = Header.Meshes.Offset + sizeof(MeshRecord) * static_cast<std::uint64_t>(Header.MeshCount);
+		std::uint64_t End = Header.Nodes.Offset + sizeof(NodeRecord) * static_cast<std::uint64_t>(Header.NodeCount);
+
+		if (Header.Meshes.Offset < sizeof(FileHeader) || Header.Nodes.Offset < MeshEnd)
+		{
+			return false;
+		}
+
+		for (std::uint32_t i = 0; i < Header.MeshCount; ++i)
+		{
+			const MeshRecord& Mesh = Meshes[i];
+
+			if (Mesh.ChunkOffset % CHUNK_ALIGN != 0 || Mesh.ChunkOffset < End
+				|| Mesh.ChunkOffset > FileSize || Mesh.ChunkSize > FileSize - Mesh.ChunkOffset)
+			{
+				return false;
+			}
+			End = Mesh.ChunkOffset + Mesh.ChunkSize;
+		}
+		return true;
+	}
+
+	bool IsValidHeader(const FileHeader& Header, std::uint64_t FileSize)
+	{
+		return Header.Magic == MAGIC
+			&& Header.Version == VERSION
+			&& Header.ByteOrder == ENDIAN_TAG
+			&& Header.NodeSize == sizeof(RayTrace::Bvh::Node)
+			&& Header.BlockSize == sizeof(RayTrace::Bvh::TriangleBlock)
+			&& Header.FileSize == FileSize;
+	}
+
+	bool MappedFile::Open(const char* Path)
+	{
+		Close();
+
+#ifdef _WIN32
+		HANDLE File = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (File == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER Size;
+		HANDLE Mapping = nullptr;
+
+		if (GetFileSizeEx(File, &Size) && Size.QuadPart > 0)
+		{
+			Mapping = CreateFileMappingA(File, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		}
+		CloseHandle(File);
+
+		if (Mapping == nullptr)
+		{
+			return false;
+		}
+
+		void* View = MapViewOfFile(Mapping, FILE_MAP_COPY, 0, 0, 0);
+
+		if (View == nullptr)
+		{
+			CloseHandle(Mapping);
+			return false;
+		}
+
+		mMapping = Mapping;
+		mData = static_cast<std::uint8_t*>(View);
+		mSize = static_cast<std::size_t>(Size.QuadPart);
+#else
+		int File = ::open(Path, O_RDONLY);
+
+		if (File < 0)
+		{
+			return false;
+		}
+
+		struct stat Info;
+		void* View = MAP_FAILED;
+
+		if (::fstat(File, &Info) == 0 && Info.st_size > 0)
+		{
+			View = ::mmap(nullptr, static_cast<std::size_t>(Info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, File, 0);
+		}
+		::close(File);
+
+		if (View == MAP_FAILED)
+		{
+			return false;
+		}
+
+		mData = static_cast<std::uint8_t*>(View);
+		mSize = static_cast<std::size_t>(Info.st_size);
+#endif
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (mData == nullptr)
+		{
+			return;
+		}
+
+#ifdef _WIN32
+		UnmapViewOfFile(mData);
+		CloseHandle(mMapping);
+		mMapping = nullptr;
+#else
+		::munmap(mData, mSize);
+#endif
+		mData = nullptr;
+		mSize = 0;
+	}
+
+	bool SceneFile::Open(const char* Path)
+	{
+		MIR_PROFILE_SCOPE("Asset::SceneFile::Open");
+
+		Close();
+
+		if (!mFile.Open(Path) || mFile.GetSize() < sizeof(FileHeader))
+		{
+			mFile.Close();
+			return false;
+		}
+
+		std::uint8_t* Base = mFile.GetData();
+		std::uint64_t Size = mFile.GetSize();
+		FileHeader* Header = reinterpret_cast<FileHeader*>(Base);
+		const FileHeader Raw = *Header;
+
+		bool IsValid = IsValidHeader(*Header, Size)
+			&& FixRef(Header->Meshes, Header->MeshCount, Base, Size)
+			&& FixRef(Header->Nodes, Header->NodeCount, Base, Size)
+			&& IsValidLayout(Raw, Header->Meshes.Ptr, Size);
+
+		// The tables are part of our private mapping, so they are patched in place.
+		for (std::uint32_t i = 0; IsValid && i < Header->MeshCount; ++i)
+		{
+			MeshRecord& Mesh = const_cast<MeshRecord&>(Header->Meshes.Ptr[i]);
+			IsValid = Fixup(Mesh, Base + Mesh.ChunkOffset, Mesh.ChunkSize);
+		}
+
+		for (std::uint32_t i = 0; IsValid && i < Header->NodeCount; ++i)
+		{
+			std::uint32_t Mesh = Header->Nodes.Ptr[i].Mesh;
+			IsValid = Mesh == NO_MESH || Mesh < Header->MeshCount;
+		}
+
+		if (!IsValid)
+		{
+			mFile.Close();
+			return false;
+		}
+
+		mHeader = Header;
+		return true;
+	}
+
+	void SceneFile::Close()
+	{
+		mFile.Close();
+		mHeader = nullptr;
+	}
+
+	std::uint32_t SceneWriter::AddMesh(const Vector3* Positions, const Vector3* Normals, std::size_t VertexCount,
+		const std::uint32_t* Indices, std::size_t TriangleCount)
+	{
+		mMeshes.emplace_back();
+		PendingMesh& Mesh = mMeshes.back();
+
+		Mesh.Positions.assign(Positions, Positions + VertexCount);
+		Mesh.Indices.assign(Indices, Indices + 3 * TriangleCount);
+
+		if (Normals != nullptr)
+		{
+			Mesh.Normals.assign(Normals, Normals + VertexCount);
+		}
+		else
+		{
+			Mesh.Normals.assign(VertexCount, Vector3::Zero);
+
+			for (std::size_t i = 0; i < TriangleCount; ++i)
+			{
+				const std::uint32_t* Tri = Indices + 3 * i;
+				Vector3 Face = Vector3::Cross(Positions[Tri[1]] - Positions[Tri[0]], Positions[Tri[2]] - Positions[Tri[0]]);
+
+				Mesh.Normals[Tri[0]] += Face;
+				Mesh.Normals[Tri[1]] += Face;
+				Mesh.Normals[Tri[2]] += Face;
+			}
+
+			for (Vector3& Iter : Mesh.Normals)
+			{
+				Iter = Iter.Square() > 0.f ? Vector3::Norm(Iter) : Vector3::UnitY;
+			}
+		}
+
+		Mesh.Tree.Build(Mesh.Positions.data(), Mesh.Indices.data(), TriangleCount);
+		return static_cast<std::uint32_t>(mMeshes.size() - 1);
+	}
+
+	std::uint32_t SceneWriter::AddNode(const Matrix4& Local, std::uint32_t Mesh, std::uint32_t Parent)
+	{
+		NodeRecord Node;
+		Node.Local = Local;
+		Node.World = Parent != NO_PARENT ? Local * mNodes[Parent].World : Local;
+		Node.Mesh = Mesh;
+		Node.Parent = Parent;
+
+		if (Mesh != NO_MESH)
+		{
+			Node.Bounds = TransformBounds(mMeshes[Mesh].Tree.GetBounds(), Node.World);
+		}
+
+		mNodes.push_back(Node);
+		return static_cast<std::uint32_t>(mNodes.size() - 1);
+	}
+
+	bool SceneWriter::Write(const char* Path) const
+	{
+		MIR_PROFILE_SCOPE("Asset::SceneWriter::Write");
+
+		FileHeader Header;
+		std::memset(static_cast<void*>(&Header), 0, sizeof(Header));
+		Header.Magic = MAGIC;
+		Header.Version = VERSION;
+		Header.ByteOrder = ENDIAN_TAG;
+		Header.NodeSize = sizeof(RayTrace::Bvh::Node);
+		Header.BlockSize = sizeof(RayTrace::Bvh::TriangleBlock);
+		Header.MeshCount = static_cast<std::uint32_t>(mMeshes.size());
+		Header.NodeCount = static_cast<std::uint32_t>(mNodes.size());
+		Header.Bounds = RayTrace::Aabb();
+
+		std::uint64_t Cursor = sizeof(FileHeader);
+		Header.Meshes.Offset = Place<MeshRecord>(Cursor, mMeshes.size());
+		Header.Nodes.Offset = Place<NodeRecord>(Cursor, mNodes.size());
+
+		std::vector<MeshRecord> Records(mMeshes.size());
+
+		for (std::size_t i = 0; i < mMeshes.size(); ++i)
+		{
+			const PendingMesh& Mesh = mMeshes[i];
+			MeshRecord& Record = Records[i];
+			std::memset(static_cast<void*>(&Record), 0, sizeof(Record));
+
+			std::size_t Vertices = Mesh.Positions.size();
+			std::uint64_t Local = 0;
+
+			Record.VertexCount = static_cast<std::uint32_t>(Vertices);
+			Record.TriangleCount = static_cast<std::uint32_t>(Mesh.Indices.size() / 3);
+			Record.BvhNodeCount = static_cast<std::uint32_t>(Mesh.Tree.GetNodeCount());
+			Record.BvhBlockCount = static_cast<std::uint32_t>(Mesh.Tree.GetBlockCount());
+			Record.Bounds = Mesh.Tree.GetBounds();
+
+			Record.PositionX.Offset = Place<float>(Local, Vertices);
+			Record.PositionY.Offset = Place<float>(Local, Vertices);
+			Record.PositionZ.Offset = Place<float>(Local, Vertices);
+			Record.NormalX.Offset = Place<float>(Local, Vertices);
+			Record.NormalY.Offset = Place<float>(Local, Vertices);
+			Record.NormalZ.Offset = Place<float>(Local, Vertices);
+			Record.Indices.Offset = Place<std::uint32_t>(Local, Mesh.Indices.size());
+			Record.BvhNodes.Offset = Place<RayTrace::Bvh::Node>(Local, Record.BvhNodeCount);
+			Record.BvhBlocks.Offset = Place<RayTrace::Bvh::TriangleBlock>(Local, Record.BvhBlockCount);
+
+			Record.ChunkOffset = Memory::AlignUp(static_cast<std::size_t>(Cursor), CHUNK_ALIGN);
+			Record.ChunkSize = Local;
+			Cursor = Record.ChunkOffset + Local;
+		}
+
+		for (const NodeRecord& Node : mNodes)
+		{
+			Header.Bounds.Grow(Node.Bounds);
+		}
+
+		Header.FileSize = Memory::AlignUp(static_cast<std::size_t>(Cursor), CHUNK_ALIGN);
+
+		std::FILE* File = std::fopen(Path, "wb");
+
+		if (File == nullptr)
+		{
+			return false;
+		}
+
+		std::uint64_t Written = 0;
+		bool IsOk = std::fwrite(&Header, sizeof(Header), 1, File) == 1;
+		Written += sizeof(Header);
+
+		IsOk = IsOk && WritePadding(File, Written, Header.Meshes.Offset)
+			&& (Records.empty() || std::fwrite(Records.data(), sizeof(MeshRecord), Records.size(), File) == Records.size());
+		Written += sizeof(MeshRecord) * Records.size();
+
+		IsOk = IsOk && WritePadding(File, Written, Header.Nodes.Offset)
+			&& (mNodes.empty() || std::fwrite(mNodes.data(), sizeof(NodeRecord), mNodes.size(), File) == mNodes.size());
+		Written += sizeof(NodeRecord) * mNodes.size();
+
+		std::vector<std::uint8_t> Chunk;
+
+		for (std::size_t i = 0; IsOk && i < mMeshes.size(); ++i)
+		{
+			const PendingMesh& Mesh = mMeshes[i];
+			const MeshRecord& Record = Records[i];
+
+			Chunk.assign(static_cast<std::size_t>(Record.ChunkSize), 0);
+
+			float* Streams[6] =
+			{
+				reinterpret_cast<float*>(&Chunk[Record.PositionX.Offset]), reinterpret_cast<float*>(&Chunk[Record.PositionY.Offset]),
+				reinterpret_cast<float*>(&Chunk[Record.PositionZ.Offset]), reinterpret_cast<float*>(&Chunk[Record.NormalX.Offset]),
+				reinterpret_cast<float*>(&Chunk[Record.NormalY.Offset]), reinterpret_cast<float*>(&Chunk[Record.NormalZ.Offset])
+			};
+
+			for (std::size_t v = 0; v < Mesh.Positions.size(); ++v)
+			{
+				Streams[0][v] = Mesh.Positions[v].X, Streams[1][v] = Mesh.Positions[v].Y, Streams[2][v] = Mesh.Positions[v].Z;
+				Streams[3][v] = Mesh.Normals[v].X, Streams[4][v] = Mesh.Normals[v].Y, Streams[5][v] = Mesh.Normals[v].Z;
+			}
+
+			std::memcpy(&Chunk[Record.Indices.Offset], Mesh.Indices.data(), sizeof(std::uint32_t) * Mesh.Indices.size());
+			std::memcpy(&Chunk[Record.BvhNodes.Offset], Mesh.Tree.GetNodes(), sizeof(RayTrace::Bvh::Node) * Record.BvhNodeCount);
+			std::memcpy(&Chunk[Record.BvhBlocks.Offset], Mesh.Tree.GetBlocks(), sizeof(RayTrace::Bvh::TriangleBlock) * Record.BvhBlockCount);
+
+			IsOk = WritePadding(File, Written, Record.ChunkOffset)
+				&& (Chunk.empty() || std::fwrite(Chunk.data(), 1, Chunk.size(), File) == Chunk.size());
+			Written += Chunk.size();
+		}
+
+		IsOk = IsOk && WritePadding(File, Written, Header.FileSize);
+		return (std::fclose(File) == 0) && IsOk;
+	}
+
+	bool LoadObj(const char* Path, std::vector<ObjMesh>& Out)
+	{
+		MIR_PROFILE_SCOPE("Asset::LoadObj");
+
+		std::FILE* File = std::fopen(Path, "rb");
+
+		if (File == nullptr)
+		{
+			return false;
+		}
+
+		std::string Text;
+		char Buffer[1 << 16];
+		std::size_t Read;
+
+		while ((Read = std::fread(Buffer, 1, sizeof(Buffer), File)) > 0)
+		{
+			Text.append(Buffer, Read);
+		}
+		std::fclose(File);
+
+		std::vector<Vector3> Positions, Normals;
+		std::unordered_map<std::uint64_t, std::uint32_t> Remap;
+		std::vector<std::uint32_t> Face;
+		bool HasAllNormals = true;
+
+		Out.clear();
+		Out.emplace_back();
+
+		auto Finish = [&]()
+		{
+			if (!HasAllNormals)
+			{
+				Out.back().Normals.clear();
+			}
+		};
+
+		auto Resolve = [](long Index, std::size_t Count) -> long
+		{
+			return Index < 0 ? static_cast<long>(Count) + Index : Index - 1;
+		};
+
+		const char* Cursor = Text.c_str();
+		const char* End = Cursor + Text.size();
+
+		while (Cursor < End)
+		{
+			const char* LineEnd = static_cast<const char*>(std::memchr(Cursor, '\n', End - Cursor));
+			LineEnd = LineEnd != nullptr ? LineEnd : End;
+
+			while (Cursor < LineEnd && (*Cursor == ' ' || *Cursor == '\t'))
+			{
+				++Cursor;
+			}
+
+			if (Cursor[0] == 'v' && (Cursor[1] == ' ' || Cursor[1] == 'n'))
+			{
+				char* Next;
+				Vector3 Value;
+				Value.X = std::strtof(Cursor + 2, &Next);
+				Value.Y = std::strtof(Next, &Next);
+				Value.Z = std::strtof(Next, &Next);
+				(Cursor[1] == ' ' ? Positions : Normals).push_back(Value);
+			}
+			else if (Cursor[0] == 'f' && Cursor[1] == ' ')
+			{
+				ObjMesh& Mesh = Out.back();
+				const char* Token = Cursor + 2;
+				Face.clear();
+
+				while (Token < LineEnd)
+				{
+					char* Next;
+					long V = Resolve(std::strtol(Token, &Next, 10), Positions.size());
+
+					if (Next == Token)
+					{
+						break;
+					}
+
+					long N = -1;
+
+					if (*Next == '/')
+					{
+						if (Next[1] != '/')
+						{
+							std::strtol(Next + 1, &Next, 10);
+						}
+						else
+						{
+							++Next;
+						}
+
+						if (*Next == '/')
+						{
+							N = Resolve(std::strtol(Next + 1, &Next, 10), Normals.size());
+						}
+					}
+					Token = Next;
+
+					if (V < 0 || static_cast<std::size_t>(V) >= Positions.size())
+					{
+						return false;
+					}
+
+					bool HasNormal = N >= 0 && static_cast<std::size_t>(N) < Normals.size();
+					HasAllNormals = HasAllNormals && HasNormal;
+
+					std::uint64_t Key = (static_cast<std::uint64_t>(V) << 32) | static_cast<std::uint32_t>(HasNormal ? N : -1);
+					auto Found = Remap.emplace(Key, static_cast<std::uint32_t>(Mesh.Positions.size()));
+
+					if (Found.second)
+					{
+						Mesh.Positions.push_back(Positions[V]);
+						Mesh.Normals.push_back(HasNormal ? Normals[N] : Vector3::Zero);
+					}
+					Face.push_back(Found.first->second);
+
+					while (Token < LineEnd && (*Token == ' ' || *Token == '\t' || *Token == '\r'))
+					{
+						++Token;
+					}
+				}
+
+				for (std::size_t i = 2; i < Face.size(); ++i)
+				{
+					Mesh.Indices.insert(Mesh.Indices.end(), { Face[0], Face[i - 1], Face[i] });
+				}
+			}
+			else if ((Cursor[0] == 'o' || Cursor[0] == 'g') && Cursor[1] == ' ')
+			{
+				if (!Out.back().Indices.empty())
+				{
+					Finish();
+					Out.emplace_back();
+					Remap.clear();
+					HasAllNormals = true;
+				}
+
+				const char* NameEnd = LineEnd;
+
+				while (NameEnd > Cursor + 2 && (NameEnd[-1] == '\r' || NameEnd[-1] == ' '))
+				{
+					--NameEnd;
+				}
+				Out.back().Name.assign(Cursor + 2, NameEnd);
+			}
+
+			Cursor = LineEnd + 1;
+		}
+
+		Finish();
+
+		if (Out.back().Indices.empty())
+		{
+			Out.pop_back();
+		}
+		return !Out.empty();
+	}
+
+	bool ConvertObj(const char* ObjPath, const char* AssetPath)
+	{
+		std::vector<ObjMesh> Meshes;
+
+		if (!LoadObj(ObjPath, Meshes))
+		{
+			return false;
+		}
+
+		SceneWriter Writer;
+
+		for (const ObjMesh& Mesh : Meshes)
+		{
+			std::uint32_t Id = Writer.AddMesh(Mesh.Positions.data(), Mesh.Normals.empty() ? nullptr : Mesh.Normals.data(),
+				Mesh.Positions.size(), Mesh.Indices.data(), Mesh.Indices.size() / 3);
+			Writer.AddNode(Matrix4::Identity, Id);
+		}
+		return Writer.Write(AssetPath);
+	}
+}
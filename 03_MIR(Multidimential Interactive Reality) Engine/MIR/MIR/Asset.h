@@ -0,0 +1,215 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Bvh.h"
+#include "Math.h"
+
+// Binary scene asset (.mira). The file is laid out exactly as it is used in
+// memory, so loading is a mapping plus pointer fixups and nothing is parsed:
+//
+//   FileHeader | MeshRecord[] | NodeRecord[] | chunk | chunk | ...
+//
+// Every mesh owns one page-aligned chunk holding its SoA vertex streams,
+// indices and prebuilt BVH, each aligned to a cache line. Offsets inside a
+// chunk are relative to the chunk, so a chunk can also be read on its own
+// into any aligned buffer (see Asset::Streamer). Little-endian only; the
+// header records the BVH node sizes so a build with another layout rejects
+// the file instead of misreading it.
+namespace Asset
+{
+	const std::uint32_t MAGIC = 0x4152494Du; // "MIRA"
+	const std::uint32_t VERSION = 1;
+	const std::uint32_t ENDIAN_TAG = 0x01020304u;
+
+	const std::uint32_t NO_MESH = 0xFFFFFFFFu;
+	const std::uint32_t NO_PARENT = 0xFFFFFFFFu;
+
+	const std::size_t CHUNK_ALIGN = 4096;
+	const std::size_t STREAM_ALIGN = 64;
+
+	// File offset that is replaced by a pointer in place once loaded.
+	template <typename T>
+	union Ref
+	{
+		std::uint64_t Offset;
+		const T* Ptr;
+	};
+
+	struct MeshRecord
+	{
+		std::uint64_t ChunkOffset;
+		std::uint64_t ChunkSize;
+
+		std::uint32_t VertexCount;
+		std::uint32_t TriangleCount;
+		std::uint32_t BvhNodeCount;
+		std::uint32_t BvhBlockCount;
+
+		RayTrace::Aabb Bounds;
+
+		Ref<float> PositionX, PositionY, PositionZ;
+		Ref<float> NormalX, NormalY, NormalZ;
+		Ref<std::uint32_t> Indices;
+		Ref<RayTrace::Bvh::Node> BvhNodes;
+		Ref<RayTrace::Bvh::TriangleBlock> BvhBlocks;
+
+		// Only valid after fixup.
+		Vector3 GetPosition(std::uint32_t Index) const { return Vector3(PositionX.Ptr[Index], PositionY.Ptr[Index], PositionZ.Ptr[Index]); }
+		Vector3 GetNormal(std::uint32_t Index) const { return Vector3(NormalX.Ptr[Index], NormalY.Ptr[Index], NormalZ.Ptr[Index]); }
+
+		// Points Out at the stored tree without copying it.
+		void AttachBvh(RayTrace::Bvh& Out) const
+		{
+			Out.Attach(BvhNodes.Ptr, BvhNodeCount, BvhBlocks.Ptr, BvhBlockCount, Bounds);
+		}
+	};
+
+	// Scene graph node. World is precomputed (Local * parent's World), and
+	// Bounds is the mesh bounds in world space.
+	struct NodeRecord
+	{
+		Matrix4 Local;
+		Matrix4 World;
+		RayTrace::Aabb Bounds;
+		std::uint32_t Mesh;
+		std::uint32_t Parent;
+	};
+
+	struct FileHeader
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint32_t ByteOrder;
+		std::uint32_t NodeSize;
+		std::uint32_t BlockSize;
+		std::uint32_t MeshCount;
+		std::uint32_t NodeCount;
+		std::uint32_t Reserved;
+		std::uint64_t FileSize;
+
+		Ref<MeshRecord> Meshes;
+		Ref<NodeRecord> Nodes;
+
+		RayTrace::Aabb Bounds;
+	};
+
+	static_assert(sizeof(Ref<float>) == 8, "Ref must hold a 64-bit offset");
+	static_assert(std::is_trivially_copyable<RayTrace::Aabb>::value && sizeof(RayTrace::Aabb) == 24, "Aabb is stored raw");
+	static_assert(std::is_trivially_copyable<Matrix4>::value && sizeof(Matrix4) == 64, "Matrix4 is stored raw");
+
+	// Checks every range of Mesh against its chunk and turns the offsets into
+	// pointers into ChunkBase, then checks every vertex index, BVH link and
+	// triangle id against the record's counts so traversal stays in bounds.
+	// False if the record does not fit the chunk or refers outside it.
+	bool Fixup(MeshRecord& Mesh, const std::uint8_t* ChunkBase, std::uint64_t ChunkSize);
+
+	// Checks the header against this build's layout and the file size.
+	bool IsValidHeader(const FileHeader& Header, std::uint64_t FileSize);
+
+	// Checks the order of the file: header, mesh table, node table, then the
+	// chunks in mesh order, each aligned and overlapping nothing before it, so
+	// fixing up one record can never write into data another has validated.
+	// Header holds file offsets; its tables must already be known to fit.
+	bool IsValidLayout(const FileHeader& Header, const MeshRecord* Meshes, std::uint64_t FileSize);
+
+	// Read-only view of a whole file. The mapping is private and copy on
+	// write: fixups dirty only the header and table pages and read indices and
+	// BVH once to check them; vertex streams are paged in by the OS on first
+	// touch.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile() { Close(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const char* Path);
+		void Close();
+
+		std::uint8_t* GetData() const { return mData; }
+		std::size_t GetSize() const { return mSize; }
+
+	private:
+		std::uint8_t* mData = nullptr;
+		std::size_t mSize = 0;
+#ifdef _WIN32
+		void* mMapping = nullptr;
+#endif
+	};
+
+	// A .mira file mapped as a whole.
+	class SceneFile
+	{
+	public:
+		bool Open(const char* Path);
+		void Close();
+
+		bool IsOpen() const { return mHeader != nullptr; }
+
+		std::uint32_t GetMeshCount() const { return mHeader->MeshCount; }
+		std::uint32_t GetNodeCount() const { return mHeader->NodeCount; }
+
+		const MeshRecord& GetMesh(std::uint32_t Index) const { return mHeader->Meshes.Ptr[Index]; }
+		const NodeRecord& GetNode(std::uint32_t Index) const { return mHeader->Nodes.Ptr[Index]; }
+		const RayTrace::Aabb& GetBounds() const { return mHeader->Bounds; }
+
+		std::size_t GetFileSize() const { return mFile.GetSize(); }
+
+	private:
+		MappedFile mFile;
+		FileHeader* mHeader = nullptr;
+	};
+
+	// Collects meshes and nodes and writes them as one .mira file. Each mesh's
+	// BVH is built here so loading never builds one.
+	class SceneWriter
+	{
+	public:
+		// Normals may be null, in which case area-weighted vertex normals are
+		// computed.
+		std::uint32_t AddMesh(const Vector3* Positions, const Vector3* Normals, std::size_t VertexCount,
+			const std::uint32_t* Indices, std::size_t TriangleCount);
+
+		// Parent must have been added before its children.
+		std::uint32_t AddNode(const Matrix4& Local, std::uint32_t Mesh, std::uint32_t Parent = NO_PARENT);
+
+		bool Write(const char* Path) const;
+
+	private:
+		struct PendingMesh
+		{
+			std::vector<Vector3> Positions;
+			std::vector<Vector3> Normals;
+			std::vector<std::uint32_t> Indices;
+			RayTrace::Bvh Tree;
+		};
+
+		std::vector<PendingMesh> mMeshes;
+		std::vector<NodeRecord> mNodes;
+	};
+
+	// One "o" / "g" group of an OBJ file, re-indexed so every distinct
+	// position / normal pair is one vertex.
+	struct ObjMesh
+	{
+		std::string Name;
+		std::vector<Vector3> Positions;
+		std::vector<Vector3> Normals;
+		std::vector<std::uint32_t> Indices;
+	};
+
+	// Positions, normals and faces only; polygons are fan triangulated.
+	bool LoadObj(const char* Path, std::vector<ObjMesh>& Out);
+
+	// Every OBJ group becomes one mesh with its own node at the origin.
+	bool ConvertObj(const char* ObjPath, const char* AssetPath);
+}
@@ -0,0 +1,324 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#include "AssetStreamer.h"
+#include "Memory.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace Asset
+{
+	namespace
+	{
+		bool SeekTo(std::FILE* File, std::uint64_t Offset)
+		{
+#ifdef _WIN32
+			return _fseeki64(File, static_cast<__int64>(Offset), SEEK_SET) == 0;
+#else
+			return fseeko(File, static_cast<off_t>(Offset), SEEK_SET) == 0;
+#endif
+		}
+
+		std::uint64_t GetFileSize(std::FILE* File)
+		{
+#ifdef _WIN32
+			_fseeki64(File, 0, SEEK_END);
+			return static_cast<std::uint64_t>(_ftelli64(File));
+#else
+			fseeko(File, 0, SEEK_END);
+			return static_cast<std::uint64_t>(ftello(File));
+#endif
+		}
+
+		template <typename T>
+		bool ReadArray(std::FILE* File, std::uint64_t Offset, std::vector<T>& Out, std::size_t Count)
+		{
+			Out.resize(Count);
+			return Count == 0 || (SeekTo(File, Offset) && std::fread(Out.data(), sizeof(T), Count, File) == Count);
+		}
+
+		float GetDistance(const Vector3& Point, const RayTrace::Aabb& Box)
+		{
+			float X = Math::Max(0.f, Math::Max(Box.Min.X - Point.X, Point.X - Box.Max.X));
+			float Y = Math::Max(0.f, Math::Max(Box.Min.Y - Point.Y, Point.Y - Box.Max.Y));
+			float Z = Math::Max(0.f, Math::Max(Box.Min.Z - Point.Z, Point.Z - Box.Max.Z));
+			return Math::Sqrt(X * X + Y * Y + Z * Z);
+		}
+	}
+
+	Streamer::Streamer(const StreamConfig& Config)
+		: mConfig(Config), mBusy(0), mExit(false), mEvictions(0), mCancels(0),
+		mLoads(0), mFailures(0), mBytesRead(0), mLoadNs(0), mMaxLoadNs(0)
+	{
+		std::memset(static_cast<void*>(&mHeader), 0, sizeof(mHeader));
+	}
+
+	Streamer::~Streamer()
+	{
+		Close();
+	}
+
+	bool Streamer::Open(const char* Path)
+	{
+		Close();
+
+		std::FILE* File = std::fopen(Path, "rb");
+
+		if (File == nullptr)
+		{
+			return false;
+		}
+
+		std::uint64_t Size = GetFileSize(File);
+
+		bool IsValid = Size >= sizeof(FileHeader) && SeekTo(File, 0)
+			&& std::fread(&mHeader, sizeof(FileHeader), 1, File) == 1
+			&& IsValidHeader(mHeader, Size)
+			&& ReadArray(File, mHeader.Meshes.Offset, mMeshes, mHeader.MeshCount)
+			&& ReadArray(File, mHeader.Nodes.Offset, mNodes, mHeader.NodeCount)
+			&& IsValidLayout(mHeader, mMeshes.data(), Size);
+		std::fclose(File);
+
+		for (std::size_t i = 0; IsValid && i < mNodes.size(); ++i)
+		{
+			IsValid = mNodes[i].Mesh == NO_MESH || mNodes[i].Mesh < mHeader.MeshCount;
+		}
+
+		if (!IsValid)
+		{
+			mMeshes.clear();
+			mNodes.clear();
+			return false;
+		}
+
+		mPath = Path;
+		mSlots.reset(new Slot[mMeshes.size()]);
+		mDistance.assign(mMeshes.size(), Math::INF);
+		mExit = false;
+
+		for (std::uint32_t i = 0; i < Math::Max(1u, mConfig.Threads); ++i)
+		{
+			mThreads.emplace_back(&Streamer::WorkerLoop, this);
+		}
+		return true;
+	}
+
+	void Streamer::Close()
+	{
+		{
+			std::lock_guard<std::mutex> Lock(mMutex);
+			mExit = true;
+			mPending.clear();
+		}
+		mWake.notify_all();
+
+		for (std::thread& Iter : mThreads)
+		{
+			Iter.join();
+		}
+		mThreads.clear();
+
+		for (std::size_t i = 0; mSlots && i < mMeshes.size(); ++i)
+		{
+			Evict(mSlots[i]);
+		}
+
+		mSlots.reset();
+		mMeshes.clear();
+		mNodes.clear();
+		mDistance.clear();
+	}
+
+	void Streamer::Update(const Vector3& Viewer)
+	{
+		MIR_PROFILE_SCOPE("Asset::Streamer::Update");
+
+		std::fill(mDistance.begin(), mDistance.end(), Math::INF);
+
+		for (const NodeRecord& Node : mNodes)
+		{
+			if (Node.Mesh != NO_MESH)
+			{
+				mDistance[Node.Mesh] = Math::Min(mDistance[Node.Mesh], GetDistance(Viewer, Node.Bounds));
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> Lock(mMutex);
+			mPending.clear();
+
+			for (std::uint32_t i = 0; i < mMeshes.size(); ++i)
+			{
+				Slot& Target = mSlots[i];
+				std::uint32_t State = Target.State.load(std::memory_order_acquire);
+
+				if (mDistance[i] <= mConfig.LoadRadius)
+				{
+					if (State == UNLOADED)
+					{
+						Target.State.store(QUEUED, std::memory_order_relaxed);
+						State = QUEUED;
+					}
+				}
+				else if (mDistance[i] > mConfig.UnloadRadius)
+				{
+					if (State == RESIDENT)
+					{
+						Evict(Target);
+						++mEvictions;
+					}
+					else if (State == QUEUED)
+					{
+						Target.State.store(UNLOADED, std::memory_order_relaxed);
+						++mCancels;
+					}
+					continue;
+				}
+
+				if (State == QUEUED)
+				{
+					mPending.push_back(i);
+				}
+			}
+
+			std::sort(mPending.begin(), mPending.end(), [this](std::uint32_t Left, std::uint32_t Right)
+			{
+				return mDistance[Left] > mDistance[Right];
+			});
+		}
+		mWake.notify_all();
+	}
+
+	const MeshRecord* Streamer::GetMesh(std::uint32_t Index) const
+	{
+		const Slot& Target = mSlots[Index];
+		return Target.State.load(std::memory_order_acquire) == RESIDENT ? &Target.Record : nullptr;
+	}
+
+	void Streamer::WaitIdle()
+	{
+		std::unique_lock<std::mutex> Lock(mMutex);
+		mIdle.wait(Lock, [this]() { return mPending.empty() && mBusy == 0; });
+	}
+
+	StreamStats Streamer::GetStats() const
+	{
+		StreamStats Stats;
+		Stats.Loads = mLoads.load(std::memory_order_relaxed);
+		Stats.Evictions = mEvictions;
+		Stats.Cancels = mCancels;
+		Stats.Failures = mFailures.load(std::memory_order_relaxed);
+		Stats.BytesRead = mBytesRead.load(std::memory_order_relaxed);
+		Stats.TotalLoadMs = mLoadNs.load(std::memory_order_relaxed) * 1.0e-6;
+		Stats.MaxLoadMs = mMaxLoadNs.load(std::memory_order_relaxed) * 1.0e-6;
+
+		for (std::size_t i = 0; i < mMeshes.size(); ++i)
+		{
+			if (mSlots[i].State.load(std::memory_order_acquire) == RESIDENT)
+			{
+				++Stats.ResidentMeshes;
+				Stats.ResidentBytes += mMeshes[i].ChunkSize;
+			}
+		}
+		return Stats;
+	}
+
+	void Streamer::WorkerLoop()
+	{
+		MIR_PROFILE_THREAD("Asset::Streamer");
+
+		std::FILE* File = std::fopen(mPath.c_str(), "rb");
+
+		while (true)
+		{
+			std::uint32_t Mesh;
+			{
+				std::unique_lock<std::mutex> Lock(mMutex);
+				mWake.wait(Lock, [this]() { return mExit || !mPending.empty(); });
+
+				if (mExit)
+				{
+					break;
+				}
+
+				Mesh = mPending.back();
+				mPending.pop_back();
+
+				std::uint32_t Expected = QUEUED;
+
+				if (!mSlots[Mesh].State.compare_exchange_strong(Expected, LOADING, std::memory_order_acq_rel))
+				{
+					continue;
+				}
+				++mBusy;
+			}
+
+			Load(File, Mesh);
+
+			std::lock_guard<std::mutex> Lock(mMutex);
+
+			if (--mBusy == 0 && mPending.empty())
+			{
+				mIdle.notify_all();
+			}
+		}
+
+		if (File != nullptr)
+		{
+			std::fclose(File);
+		}
+	}
+
+	void Streamer::Load(std::FILE* File, std::uint32_t Mesh)
+	{
+		MIR_PROFILE_SCOPE("Asset::Streamer::Load");
+
+		auto Start = std::chrono::steady_clock::now();
+
+		Slot& Target = mSlots[Mesh];
+		MeshRecord Record = mMeshes[Mesh];
+		std::size_t Size = static_cast<std::size_t>(Record.ChunkSize);
+		std::uint8_t* Buffer = static_cast<std::uint8_t*>(Memory::HeapAlloc(Memory::AlignUp(Size, STREAM_ALIGN) + STREAM_ALIGN, STREAM_ALIGN));
+
+		bool IsOk = File != nullptr
+			&& SeekTo(File, Record.ChunkOffset)
+			&& std::fread(Buffer, 1, Size, File) == Size
+			&& Fixup(Record, Buffer, Record.ChunkSize);
+
+		if (!IsOk)
+		{
+			Memory::HeapFree(Buffer, STREAM_ALIGN);
+			mFailures.fetch_add(1, std::memory_order_relaxed);
+			Target.State.store(FAILED, std::memory_order_release);
+			return;
+		}
+
+		Target.Record = Record;
+		Target.Buffer = Buffer;
+		Target.State.store(RESIDENT, std::memory_order_release);
+
+		std::uint64_t Ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count());
+		std::uint64_t Max = mMaxLoadNs.load(std::memory_order_relaxed);
+
+		while (Ns > Max && !mMaxLoadNs.compare_exchange_weak(Max, Ns, std::memory_order_relaxed))
+		{
+		}
+
+		mLoads.fetch_add(1, std::memory_order_relaxed);
+		mBytesRead.fetch_add(Size, std::memory_order_relaxed);
+		mLoadNs.fetch_add(Ns, std::memory_order_relaxed);
+	}
+
+	void Streamer::Evict(Slot& Target)
+	{
+		if (Target.Buffer != nullptr)
+		{
+			Memory::HeapFree(Target.Buffer, STREAM_ALIGN);
+			Target.Buffer = nullptr;
+		}
+		Target.State.store(UNLOADED, std::memory_order_release);
+	}
+}
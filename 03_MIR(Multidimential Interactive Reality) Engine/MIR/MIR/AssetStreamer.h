@@ -0,0 +1,125 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Asset.h"
+
+namespace Asset
+{
+	struct StreamConfig
+	{
+		// Meshes whose node bounds come within LoadRadius of the viewer are
+		// paged in; they stay until the viewer is beyond UnloadRadius.
+		float LoadRadius = 64.f;
+		float UnloadRadius = 80.f;
+		std::uint32_t Threads = 2;
+	};
+
+	struct StreamStats
+	{
+		std::uint64_t Loads = 0;
+		std::uint64_t Evictions = 0;
+		std::uint64_t Cancels = 0;
+		std::uint64_t Failures = 0;
+		std::uint64_t BytesRead = 0;
+
+		std::uint32_t ResidentMeshes = 0;
+		std::uint64_t ResidentBytes = 0;
+
+		double TotalLoadMs = 0.0;
+		double MaxLoadMs = 0.0;
+	};
+
+	// Streams the mesh chunks of a .mira file. Open() reads the header and the
+	// mesh / node tables only. Update() ranks meshes by the distance from the
+	// viewer to their nodes' bounds and hands the requests to background
+	// threads nearest first; each thread reads one chunk into its own aligned
+	// buffer and fixes it up, then publishes it. Meshes beyond UnloadRadius
+	// are dropped or evicted. Update() and GetMesh() belong to one thread
+	// (the one that renders), so an evicted buffer is never in use.
+	class Streamer
+	{
+	public:
+		explicit Streamer(const StreamConfig& Config = StreamConfig());
+		~Streamer();
+
+		Streamer(const Streamer&) = delete;
+		Streamer& operator=(const Streamer&) = delete;
+
+		bool Open(const char* Path);
+		void Close();
+
+		void Update(const Vector3& Viewer);
+
+		// Null until the mesh is resident.
+		const MeshRecord* GetMesh(std::uint32_t Index) const;
+
+		std::uint32_t GetMeshCount() const { return static_cast<std::uint32_t>(mMeshes.size()); }
+		std::uint32_t GetNodeCount() const { return static_cast<std::uint32_t>(mNodes.size()); }
+		const NodeRecord& GetNode(std::uint32_t Index) const { return mNodes[Index]; }
+		const RayTrace::Aabb& GetBounds() const { return mHeader.Bounds; }
+
+		// Blocks until every queued request has been loaded.
+		void WaitIdle();
+
+		StreamStats GetStats() const;
+
+	private:
+		enum Status : std::uint32_t
+		{
+			UNLOADED,
+			QUEUED,
+			LOADING,
+			RESIDENT,
+			FAILED
+		};
+
+		struct Slot
+		{
+			std::atomic<std::uint32_t> State{ UNLOADED };
+			MeshRecord Record;
+			std::uint8_t* Buffer = nullptr;
+		};
+
+		void WorkerLoop();
+		void Load(std::FILE* File, std::uint32_t Mesh);
+		void Evict(Slot& Target);
+
+		StreamConfig mConfig;
+		std::string mPath;
+
+		FileHeader mHeader;
+		std::vector<MeshRecord> mMeshes;
+		std::vector<NodeRecord> mNodes;
+		std::unique_ptr<Slot[]> mSlots;
+		std::vector<float> mDistance;
+
+		std::vector<std::thread> mThreads;
+		std::mutex mMutex;
+		std::condition_variable mWake;
+		std::condition_variable mIdle;
+
+		// Sorted far to near, so workers pop the nearest from the back.
+		std::vector<std::uint32_t> mPending;
+		std::uint32_t mBusy;
+		bool mExit;
+
+		std::uint64_t mEvictions;
+		std::uint64_t mCancels;
+		std::atomic<std::uint64_t> mLoads;
+		std::atomic<std::uint64_t> mFailures;
+		std::atomic<std::uint64_t> mBytesRead;
+		std::atomic<std::uint64_t> mLoadNs;
+		std::atomic<std::uint64_t> mMaxLoadNs;
+	};
+}
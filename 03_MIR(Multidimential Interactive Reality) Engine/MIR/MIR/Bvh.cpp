@@ -0,0 +1,740 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#include "Bvh.h"
+#include "Profiler.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace RayTrace
+{
+	void Aabb::Grow(const Vector3& Point)
+	{
+		Min.Set(Math::Min(Min.X, Point.X), Math::Min(Min.Y, Point.Y), Math::Min(Min.Z, Point.Z));
+		Max.Set(Math::Max(Max.X, Point.X), Math::Max(Max.Y, Point.Y), Math::Max(Max.Z, Point.Z));
+	}
+
+	void Aabb::Grow(const Aabb& Box)
+	{
+		Grow(Box.Min);
+		Grow(Box.Max);
+	}
+
+	float Aabb::GetArea() const
+	{
+		if (IsEmpty())
+		{
+			return 0.f;
+		}
+
+		Vector3 Size = Max - Min;
+		return 2.f * (Size.X * Size.Y + Size.Y * Size.Z + Size.Z * Size.X);
+	}
+
+	namespace
+	{
+		const std::uint32_t BIN_COUNT = 16;
+		const std::uint32_t MAX_LEAF_TRIANGLES = 16;
+		// Each level keeps at most WIDTH - 1 siblings waiting.
+		const std::uint32_t STACK_SIZE = (Bvh::WIDTH - 1) * Bvh::MAX_DEPTH + 1;
+
+		struct BuildRef
+		{
+			Aabb Box;
+			Vector3 Center;
+			std::uint32_t Id;
+		};
+
+		struct BinaryNode
+		{
+			Aabb Box;
+			std::int32_t Left = -1;
+			std::int32_t Right = -1;
+			std::uint32_t First = 0;
+			std::uint32_t Count = 0;
+		};
+
+		struct BuildTask
+		{
+			std::uint32_t Node;
+			std::uint32_t First;
+			std::uint32_t Count;
+			std::uint32_t Depth;
+		};
+
+		float GetAxis(const Vector3& Vec, int Axis)
+		{
+			return Axis == 0 ? Vec.X : (Axis == 1 ? Vec.Y : Vec.Z);
+		}
+
+		std::uint32_t GetBin(const Vector3& Center, int Axis, float Lo, float Scale)
+		{
+			return Math::Min(static_cast<std::uint32_t>((GetAxis(Center, Axis) - Lo) * Scale), BIN_COUNT - 1);
+		}
+
+		float BlockCost(std::uint32_t Triangles)
+		{
+			return static_cast<float>((Triangles + Bvh::WIDTH - 1) / Bvh::WIDTH);
+		}
+
+		// Binned SAH. Returns false when no split beats keeping the range as a leaf.
+		bool FindSplit(const std::vector<BuildRef>& Refs, const BuildTask& Task, const Aabb& Box,
+			int& BestAxis, std::uint32_t& BestBin, float& BestScale, float& BestMin)
+		{
+			Aabb Centers;
+
+			for (std::uint32_t i = Task.First; i < Task.First + Task.Count; ++i)
+			{
+				Centers.Grow(Refs[i].Center);
+			}
+
+			float BestCost = Math::INF;
+			BestAxis = -1;
+
+			for (int Axis = 0; Axis < 3; ++Axis)
+			{
+				float Lo = GetAxis(Centers.Min, Axis), Hi = GetAxis(Centers.Max, Axis);
+
+				if (Hi - Lo <= 1.0e-12f)
+				{
+					continue;
+				}
+
+				float Scale = BIN_COUNT / (Hi - Lo) * 0.99999f;
+
+				Aabb BinBox[BIN_COUNT];
+				std::uint32_t BinCount[BIN_COUNT] = {};
+
+				for (std::uint32_t i = Task.First; i < Task.First + Task.Count; ++i)
+				{
+					std::uint32_t Bin = GetBin(Refs[i].Center, Axis, Lo, Scale);
+					BinBox[Bin].Grow(Refs[i].Box);
+					++BinCount[Bin];
+				}
+
+				float RightArea[BIN_COUNT];
+				std::uint32_t RightCount[BIN_COUNT];
+				Aabb Sweep;
+				std::uint32_t Count = 0;
+
+				for (std::uint32_t b = BIN_COUNT - 1; b > 0; --b)
+				{
+					Sweep.Grow(BinBox[b]);
+					Count += BinCount[b];
+					RightArea[b] = Sweep.GetArea();
+					RightCount[b] = Count;
+				}
+
+				Sweep = Aabb();
+				Count = 0;
+
+				for (std::uint32_t b = 0; b < BIN_COUNT - 1; ++b)
+				{
+					Sweep.Grow(BinBox[b]);
+					Count += BinCount[b];
+
+					if (Count == 0 || RightCount[b + 1] == 0)
+					{
+						continue;
+					}
+
+					float Cost = Sweep.GetArea() * BlockCost(Count) + RightArea[b + 1] * BlockCost(RightCount[b + 1]);
+
+					if (Cost < BestCost)
+					{
+						BestCost = Cost;
+						BestAxis = Axis;
+						BestBin = b + 1;
+						BestScale = Scale;
+						BestMin = Lo;
+					}
+				}
+			}
+
+			// Traversal step costs about as much as one triangle block.
+			float Area = Box.GetArea();
+			float SplitCost = 1.f + (Area > 0.f ? BestCost / Area : 0.f);
+			bool LeafAllowed = Task.Count <= MAX_LEAF_TRIANGLES;
+
+			return BestAxis >= 0 && (!LeafAllowed || SplitCost < BlockCost(Task.Count));
+		}
+
+		class Collapser
+		{
+		public:
+			Collapser(const std::vector<BinaryNode>& Binary, const std::vector<BuildRef>& Refs,
+				const Vector3* Positions, const std::uint32_t* Indices,
+				std::vector<Bvh::Node>& Nodes, std::vector<Bvh::TriangleBlock>& Blocks)
+				: mBinary(Binary), mRefs(Refs), mPositions(Positions), mIndices(Indices), mNodes(Nodes), mBlocks(Blocks)
+			{
+			}
+
+			std::uint32_t Emit(std::uint32_t Root)
+			{
+				std::uint32_t Children[Bvh::WIDTH];
+				std::uint32_t NumChildren = 0;
+
+				if (mBinary[Root].Left < 0)
+				{
+					Children[NumChildren++] = Root;
+				}
+				else
+				{
+					Children[NumChildren++] = static_cast<std::uint32_t>(mBinary[Root].Left);
+					Children[NumChildren++] = static_cast<std::uint32_t>(mBinary[Root].Right);
+				}
+
+				// Pull grandchildren up, always opening the largest inner child.
+				while (NumChildren < Bvh::WIDTH)
+				{
+					int Open = -1;
+					float OpenArea = -1.f;
+
+					for (std::uint32_t i = 0; i < NumChildren; ++i)
+					{
+						const BinaryNode& Child = mBinary[Children[i]];
+
+						if (Child.Left >= 0 && Child.Box.GetArea() > OpenArea)
+						{
+							Open = static_cast<int>(i);
+							OpenArea = Child.Box.GetArea();
+						}
+					}
+
+					if (Open < 0)
+					{
+						break;
+					}
+
+					const BinaryNode& Opened = mBinary[Children[Open]];
+					Children[Open] = static_cast<std::uint32_t>(Opened.Left);
+					Children[NumChildren++] = static_cast<std::uint32_t>(Opened.Right);
+				}
+
+				std::uint32_t Index = static_cast<std::uint32_t>(mNodes.size());
+				mNodes.emplace_back();
+
+				for (std::uint32_t i = 0; i < Bvh::WIDTH; ++i)
+				{
+					std::uint32_t Child = Bvh::EMPTY, Count = 0;
+					Aabb Box;
+
+					if (i < NumChildren)
+					{
+						const BinaryNode& Source = mBinary[Children[i]];
+						Box = Source.Box;
+
+						if (Source.Left < 0)
+						{
+							Child = Bvh::LEAF | static_cast<std::uint32_t>(mBlocks.size());
+							Count = EmitBlocks(Source.First, Source.Count);
+						}
+						else
+						{
+							Child = Emit(Children[i]);
+						}
+					}
+
+					Bvh::Node& Node = mNodes[Index];
+					Node.MinX[i] = Box.Min.X, Node.MinY[i] = Box.Min.Y, Node.MinZ[i] = Box.Min.Z;
+					Node.MaxX[i] = Box.Max.X, Node.MaxY[i] = Box.Max.Y, Node.MaxZ[i] = Box.Max.Z;
+					Node.Child[i] = Child;
+					Node.Count[i] = Count;
+				}
+				return Index;
+			}
+
+		private:
+			std::uint32_t EmitBlocks(std::uint32_t First, std::uint32_t Count)
+			{
+				std::uint32_t NumBlocks = (Count + Bvh::WIDTH - 1) / Bvh::WIDTH;
+
+				for (std::uint32_t b = 0; b < NumBlocks; ++b)
+				{
+					Bvh::TriangleBlock Block;
+
+					for (std::uint32_t Lane = 0; Lane < Bvh::WIDTH; ++Lane)
+					{
+						std::uint32_t Ref = First + Math::Min(b * Bvh::WIDTH + Lane, Count - 1);
+						std::uint32_t Id = mRefs[Ref].Id;
+
+						const Vector3& V0 = mPositions[mIndices[3 * Id + 0]];
+						Vector3 E1 = mPositions[mIndices[3 * Id + 1]] - V0;
+						Vector3 E2 = mPositions[mIndices[3 * Id + 2]] - V0;
+
+						Block.V0X[Lane] = V0.X, Block.V0Y[Lane] = V0.Y, Block.V0Z[Lane] = V0.Z;
+						Block.E1X[Lane] = E1.X, Block.E1Y[Lane] = E1.Y, Block.E1Z[Lane] = E1.Z;
+						Block.E2X[Lane] = E2.X, Block.E2Y[Lane] = E2.Y, Block.E2Z[Lane] = E2.Z;
+						Block.Id[Lane] = Id;
+					}
+					mBlocks.push_back(Block);
+				}
+				return NumBlocks;
+			}
+
+			const std::vector<BinaryNode>& mBinary;
+			const std::vector<BuildRef>& mRefs;
+			const Vector3* mPositions;
+			const std::uint32_t* mIndices;
+			std::vector<Bvh::Node>& mNodes;
+			std::vector<Bvh::TriangleBlock>& mBlocks;
+		};
+
+		struct RayData
+		{
+			Vector3 Origin;
+			Vector3 Dir;
+			Vector3 InvDir;
+		};
+
+		float SafeInverse(float Val)
+		{
+			const float Tiny = 1.0e-30f;
+			return 1.f / (Math::Abs(Val) > Tiny ? Val : (Val < 0.f ? -Tiny : Tiny));
+		}
+
+		// Slab test against the four child boxes. Returns a lane mask of hits and
+		// writes each child's entry distance.
+		int IntersectNode(const Bvh::Node& Node, const RayData& R, float MaxT, float* Near)
+		{
+#if MIR_SIMD_SSE
+			__m128 Ox = _mm_set1_ps(R.Origin.X), Oy = _mm_set1_ps(R.Origin.Y), Oz = _mm_set1_ps(R.Origin.Z);
+			__m128 Ix = _mm_set1_ps(R.InvDir.X), Iy = _mm_set1_ps(R.InvDir.Y), Iz = _mm_set1_ps(R.InvDir.Z);
+
+			__m128 T0x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(Node.MinX), Ox), Ix);
+			__m128 T1x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(Node.MaxX), Ox), Ix);
+			__m128 T0y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(Node.MinY), Oy), Iy);
+			__m128 T1y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(Node.MaxY), Oy), Iy);
+			__m128 T0z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(Node.MinZ), Oz), Iz);
+			__m128 T1z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(Node.MaxZ), Oz), Iz);
+
+			__m128 Enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(T0x, T1x), _mm_min_ps(T0y, T1y)),
+				_mm_max_ps(_mm_min_ps(T0z, T1z), _mm_setzero_ps()));
+			__m128 Exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(T0x, T1x), _mm_max_ps(T0y, T1y)),
+				_mm_min_ps(_mm_max_ps(T0z, T1z), _mm_set1_ps(MaxT)));
+
+			_mm_storeu_ps(Near, Enter);
+			return _mm_movemask_ps(_mm_cmple_ps(Enter, Exit));
+#else
+			int Mask = 0;
+
+			for (std::uint32_t i = 0; i < Bvh::WIDTH; ++i)
+			{
+				float T0x = (Node.MinX[i] - R.Origin.X) * R.InvDir.X, T1x = (Node.MaxX[i] - R.Origin.X) * R.InvDir.X;
+				float T0y = (Node.MinY[i] - R.Origin.Y) * R.InvDir.Y, T1y = (Node.MaxY[i] - R.Origin.Y) * R.InvDir.Y;
+				float T0z = (Node.MinZ[i] - R.Origin.Z) * R.InvDir.Z, T1z = (Node.MaxZ[i] - R.Origin.Z) * R.InvDir.Z;
+
+				float Enter = Math::Max(Math::Max(Math::Min(T0x, T1x), Math::Min(T0y, T1y)), Math::Max(Math::Min(T0z, T1z), 0.f));
+				float Exit = Math::Min(Math::Min(Math::Max(T0x, T1x), Math::Max(T0y, T1y)), Math::Min(Math::Max(T0z, T1z), MaxT));
+
+				Near[i] = Enter;
+				Mask |= Enter <= Exit ? 1 << i : 0;
+			}
+			return Mask;
+#endif
+		}
+
+		// Moller-Trumbore on four triangles. Returns the lane of the nearest hit
+		// closer than MaxT, or -1.
+		int IntersectBlock(const Bvh::TriangleBlock& Block, const RayData& R, float MaxT, float& OutT, float& OutU, float& OutV)
+		{
+			float T[Bvh::WIDTH], U[Bvh::WIDTH], V[Bvh::WIDTH];
+			int Mask;
+
+#if MIR_SIMD_SSE
+			__m128 Dx = _mm_set1_ps(R.Dir.X), Dy = _mm_set1_ps(R.Dir.Y), Dz = _mm_set1_ps(R.Dir.Z);
+			__m128 E1x = _mm_load_ps(Block.E1X), E1y = _mm_load_ps(Block.E1Y), E1z = _mm_load_ps(Block.E1Z);
+			__m128 E2x = _mm_load_ps(Block.E2X), E2y = _mm_load_ps(Block.E2Y), E2z = _mm_load_ps(Block.E2Z);
+
+			// P = D x E2
+			__m128 Px = _mm_sub_ps(_mm_mul_ps(Dy, E2z), _mm_mul_ps(Dz, E2y));
+			__m128 Py = _mm_sub_ps(_mm_mul_ps(Dz, E2x), _mm_mul_ps(Dx, E2z));
+			__m128 Pz = _mm_sub_ps(_mm_mul_ps(Dx, E2y), _mm_mul_ps(Dy, E2x));
+
+			__m128 Det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(E1x, Px), _mm_mul_ps(E1y, Py)), _mm_mul_ps(E1z, Pz));
+			__m128 InvDet = _mm_div_ps(_mm_set1_ps(1.f), Det);
+
+			__m128 Sx = _mm_sub_ps(_mm_set1_ps(R.Origin.X), _mm_load_ps(Block.V0X));
+			__m128 Sy = _mm_sub_ps(_mm_set1_ps(R.Origin.Y), _mm_load_ps(Block.V0Y));
+			__m128 Sz = _mm_sub_ps(_mm_set1_ps(R.Origin.Z), _mm_load_ps(Block.V0Z));
+
+			__m128 Uv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(Sx, Px), _mm_mul_ps(Sy, Py)), _mm_mul_ps(Sz, Pz)), InvDet);
+
+			// Q = S x E1
+			__m128 Qx = _mm_sub_ps(_mm_mul_ps(Sy, E1z), _mm_mul_ps(Sz, E1y));
+			__m128 Qy = _mm_sub_ps(_mm_mul_ps(Sz, E1x), _mm_mul_ps(Sx, E1z));
+			__m128 Qz = _mm_sub_ps(_mm_mul_ps(Sx, E1y), _mm_mul_ps(Sy, E1x));
+
+			__m128 Vv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(Dx, Qx), _mm_mul_ps(Dy, Qy)), _mm_mul_ps(Dz, Qz)), InvDet);
+			__m128 Tv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(E2x, Qx), _mm_mul_ps(E2y, Qy)), _mm_mul_ps(E2z, Qz)), InvDet);
+
+			const __m128 Zero = _mm_setzero_ps();
+			__m128 Valid = _mm_and_ps(_mm_cmpge_ps(Uv, Zero), _mm_cmpge_ps(Vv, Zero));
+			Valid = _mm_and_ps(Valid, _mm_cmple_ps(_mm_add_ps(Uv, Vv), _mm_set1_ps(1.f)));
+			Valid = _mm_and_ps(Valid, _mm_and_ps(_mm_cmpgt_ps(Tv, Zero), _mm_cmplt_ps(Tv, _mm_set1_ps(MaxT))));
+
+			Mask = _mm_movemask_ps(Valid);
+
+			if (Mask == 0)
+			{
+				return -1;
+			}
+
+			_mm_storeu_ps(T, Tv);
+			_mm_storeu_ps(U, Uv);
+			_mm_storeu_ps(V, Vv);
+#else
+			Mask = 0;
+
+			for (std::uint32_t i = 0; i < Bvh::WIDTH; ++i)
+			{
+				Vector3 E1(Block.E1X[i], Block.E1Y[i], Block.E1Z[i]), E2(Block.E2X[i], Block.E2Y[i], Block.E2Z[i]);
+				Vector3 P = Vector3::Cross(R.Dir, E2);
+				float InvDet = 1.f / Vector3::Dot(E1, P);
+
+				Vector3 S = R.Origin - Vector3(Block.V0X[i], Block.V0Y[i], Block.V0Z[i]);
+				Vector3 Q = Vector3::Cross(S, E1);
+
+				U[i] = Vector3::Dot(S, P) * InvDet;
+				V[i] = Vector3::Dot(R.Dir, Q) * InvDet;
+				T[i] = Vector3::Dot(E2, Q) * InvDet;
+
+				bool Valid = U[i] >= 0.f && V[i] >= 0.f && U[i] + V[i] <= 1.f && T[i] > 0.f && T[i] < MaxT;
+				Mask |= Valid ? 1 << i : 0;
+			}
+
+			if (Mask == 0)
+			{
+				return -1;
+			}
+#endif
+
+			int Best = -1;
+
+			for (int i = 0; i < static_cast<int>(Bvh::WIDTH); ++i)
+			{
+				if ((Mask & (1 << i)) != 0 && (Best < 0 || T[i] < T[Best]))
+				{
+					Best = i;
+				}
+			}
+
+			OutT = T[Best], OutU = U[Best], OutV = V[Best];
+			return Best;
+		}
+	}
+
+	void Bvh::Build(const Vector3* Positions, const std::uint32_t* Indices, std::size_t TriangleCount)
+	{
+		MIR_PROFILE_SCOPE("Bvh::Build");
+
+		mNodes.clear();
+		mBlocks.clear();
+		mBounds = Aabb();
+		BindOwned();
+
+		if (TriangleCount == 0)
+		{
+			return;
+		}
+
+		std::vector<BuildRef> Refs(TriangleCount);
+
+		for (std::size_t i = 0; i < TriangleCount; ++i)
+		{
+			BuildRef& Ref = Refs[i];
+			Ref.Box.Grow(Positions[Indices[3 * i + 0]]);
+			Ref.Box.Grow(Positions[Indices[3 * i + 1]]);
+			Ref.Box.Grow(Positions[Indices[3 * i + 2]]);
+			Ref.Center = Ref.Box.GetCenter();
+			Ref.Id = static_cast<std::uint32_t>(i);
+			mBounds.Grow(Ref.Box);
+		}
+
+		std::vector<BinaryNode> Binary;
+		Binary.reserve(TriangleCount);
+		Binary.emplace_back();
+
+		std::vector<BuildTask> Tasks;
+		Tasks.push_back({ 0, 0, static_cast<std::uint32_t>(TriangleCount), 1 });
+
+		while (!Tasks.empty())
+		{
+			BuildTask Task = Tasks.back();
+			Tasks.pop_back();
+
+			Aabb Box;
+
+			for (std::uint32_t i = Task.First; i < Task.First + Task.Count; ++i)
+			{
+				Box.Grow(Refs[i].Box);
+			}
+
+			Binary[Task.Node].Box = Box;
+			Binary[Task.Node].First = Task.First;
+			Binary[Task.Node].Count = Task.Count;
+
+			// A collapsed node never sits deeper than its binary node, so capping
+			// the binary depth caps the traversal stack.
+			if (Task.Count <= WIDTH || Task.Depth == MAX_DEPTH)
+			{
+				continue;
+			}
+
+			int Axis;
+			std::uint32_t Plane = 0;
+			float Scale = 0.f, Lo = 0.f;
+			std::uint32_t Mid;
+
+			if (FindSplit(Refs, Task, Box, Axis, Plane, Scale, Lo))
+			{
+				auto Begin = Refs.begin() + Task.First;
+				auto Split = std::partition(Begin, Begin + Task.Count, [&](const BuildRef& Ref)
+				{
+					return GetBin(Ref.Center, Axis, Lo, Scale) < Plane;
+				});
+				Mid = static_cast<std::uint32_t>(Split - Refs.begin());
+			}
+			else if (Task.Count > MAX_LEAF_TRIANGLES)
+			{
+				// Every centre coincides; any balanced split is as good as another.
+				Mid = Task.First + Task.Count / 2;
+			}
+			else
+			{
+				continue;
+			}
+
+			if (Mid == Task.First || Mid == Task.First + Task.Count)
+			{
+				Mid = Task.First + Task.Count / 2;
+			}
+
+			std::int32_t Left = static_cast<std::int32_t>(Binary.size());
+			Binary.emplace_back();
+			Binary.emplace_back();
+			Binary[Task.Node].Left = Left;
+			Binary[Task.Node].Right = Left + 1;
+
+			Tasks.push_back({ static_cast<std::uint32_t>(Left), Task.First, Mid - Task.First, Task.Depth + 1 });
+			Tasks.push_back({ static_cast<std::uint32_t>(Left + 1), Mid, Task.First + Task.Count - Mid, Task.Depth + 1 });
+		}
+
+		mNodes.reserve(Binary.size() / 2 + 1);
+		mBlocks.reserve(TriangleCount / 2 + 1);
+
+		Collapser Emitter(Binary, Refs, Positions, Indices, mNodes, mBlocks);
+		Emitter.Emit(0);
+		BindOwned();
+	}
+
+	std::uint32_t Bvh::MeasureDepth(const Node* Nodes, std::size_t NodeCount)
+	{
+		std::vector<std::uint32_t> Depth(NodeCount, 0);
+		std::uint32_t Deepest = 0;
+
+		if (NodeCount > 0)
+		{
+			Depth[0] = 1;
+		}
+
+		for (std::size_t n = 0; n < NodeCount; ++n)
+		{
+			Deepest = std::max(Deepest, Depth[n]);
+
+			for (std::uint32_t i = 0; i < WIDTH; ++i)
+			{
+				std::uint32_t Child = Nodes[n].Child[i];
+
+				if (Child != EMPTY && (Child & LEAF) == 0 && Child > n && Child < NodeCount)
+				{
+					Depth[Child] = std::max(Depth[Child], Depth[n] + 1);
+				}
+			}
+		}
+		return Deepest;
+	}
+
+	Bvh& Bvh::operator=(const Bvh& Other)
+	{
+		mNodes = Other.mNodes;
+		mBlocks = Other.mBlocks;
+		mBounds = Other.mBounds;
+
+		if (Other.mNodeData != Other.mNodes.data())
+		{
+			Attach(Other.mNodeData, Other.mNodeCount, Other.mBlockData, Other.mBlockCount, Other.mBounds);
+		}
+		else
+		{
+			BindOwned();
+		}
+		return *this;
+	}
+
+	// An owned tree moves its storage and leaves Other empty; an attached one
+	// is shared like a copy.
+	Bvh& Bvh::operator=(Bvh&& Other) noexcept
+	{
+		if (this == &Other)
+		{
+			return *this;
+		}
+
+		if (Other.mNodeData != Other.mNodes.data())
+		{
+			Attach(Other.mNodeData, Other.mNodeCount, Other.mBlockData, Other.mBlockCount, Other.mBounds);
+			return *this;
+		}
+
+		mNodes = std::move(Other.mNodes);
+		mBlocks = std::move(Other.mBlocks);
+		mBounds = Other.mBounds;
+		BindOwned();
+
+		Other.mNodes.clear();
+		Other.mBlocks.clear();
+		Other.mBounds = Aabb();
+		Other.BindOwned();
+		return *this;
+	}
+
+	void Bvh::Assign(std::vector<Node> Nodes, std::vector<TriangleBlock> Blocks, const Aabb& Bounds)
+	{
+		mNodes = std::move(Nodes);
+		mBlocks = std::move(Blocks);
+		mBounds = Bounds;
+		BindOwned();
+	}
+
+	void Bvh::Attach(const Node* Nodes, std::size_t NodeCount,
+		const TriangleBlock* Blocks, std::size_t BlockCount, const Aabb& Bounds)
+	{
+		mNodes.clear();
+		mBlocks.clear();
+		mBounds = Bounds;
+
+		mNodeData = Nodes;
+		mNodeCount = NodeCount;
+		mBlockData = Blocks;
+		mBlockCount = BlockCount;
+	}
+
+	void Bvh::BindOwned()
+	{
+		mNodeData = mNodes.data();
+		mNodeCount = mNodes.size();
+		mBlockData = mBlocks.data();
+		mBlockCount = mBlocks.size();
+	}
+
+	template <bool AnyHit>
+	bool Bvh::Traverse(const Ray& R, Hit& Out) const
+	{
+		if (mNodeCount == 0)
+		{
+			return false;
+		}
+
+		RayData Data;
+		Data.Origin = R.Origin;
+		Data.Dir = R.Dir;
+		Data.InvDir.Set(SafeInverse(R.Dir.X), SafeInverse(R.Dir.Y), SafeInverse(R.Dir.Z));
+
+		struct Entry
+		{
+			std::uint32_t Child;
+			std::uint32_t Count;
+			float Near;
+		};
+
+		Entry Stack[STACK_SIZE];
+		std::uint32_t Top = 0;
+		Stack[Top++] = { 0, 0, 0.f };
+
+		float MaxT = Out.T;
+		bool Found = false;
+
+		while (Top > 0)
+		{
+			const Entry Current = Stack[--Top];
+
+			if (Current.Near >= MaxT)
+			{
+				continue;
+			}
+
+			if ((Current.Child & LEAF) != 0)
+			{
+				std::uint32_t First = Current.Child & ~LEAF;
+
+				for (std::uint32_t b = First; b < First + Current.Count; ++b)
+				{
+					float T, U, V;
+					int Lane = IntersectBlock(mBlockData[b], Data, MaxT, T, U, V);
+
+					if (Lane < 0)
+					{
+						continue;
+					}
+
+					MaxT = T;
+					Found = true;
+					Out.T = T, Out.U = U, Out.V = V;
+					Out.Triangle = mBlockData[b].Id[Lane];
+
+					if (AnyHit)
+					{
+						return true;
+					}
+				}
+				continue;
+			}
+
+			const Node& Current4 = mNodeData[Current.Child];
+			float Near[WIDTH];
+			int Mask = IntersectNode(Current4, Data, MaxT, Near);
+
+			// Push far to near so the closest child is popped first.
+			Entry Hits[WIDTH];
+			std::uint32_t NumHits = 0;
+
+			for (std::uint32_t i = 0; i < WIDTH; ++i)
+			{
+				if ((Mask & (1 << i)) != 0 && Current4.Child[i] != EMPTY)
+				{
+					Entry Temp = { Current4.Child[i], Current4.Count[i], Near[i] };
+					std::uint32_t j = NumHits++;
+
+					for (; j > 0 && Hits[j - 1].Near < Temp.Near; --j)
+					{
+						Hits[j] = Hits[j - 1];
+					}
+					Hits[j] = Temp;
+				}
+			}
+
+			assert(Top + NumHits <= STACK_SIZE);
+
+			for (std::uint32_t i = 0; i < NumHits; ++i)
+			{
+				Stack[Top++] = Hits[i];
+			}
+		}
+		return Found;
+	}
+
+	bool Bvh::Intersect(const Ray& R, Hit& Out) const
+	{
+		return Traverse<false>(R, Out);
+	}
+
+	bool Bvh::Occluded(const Ray& R, float MaxT) const
+	{
+		Hit Temp;
+		Temp.T = MaxT;
+		return Traverse<true>(R, Temp);
+	}
+}
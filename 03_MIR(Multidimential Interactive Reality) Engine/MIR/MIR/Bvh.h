@@ -0,0 +1,130 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Math.h"
+
+namespace RayTrace
+{
+	const std::uint32_t NO_HIT = 0xFFFFFFFFu;
+
+	struct Ray
+	{
+		Vector3 Origin;
+		Vector3 Dir;
+	};
+
+	// Closest intersection. U, V are barycentrics of vertices 1 and 2.
+	struct Hit
+	{
+		float T = Math::INF;
+		float U = 0.f;
+		float V = 0.f;
+		std::uint32_t Triangle = NO_HIT;
+
+		bool IsHit() const { return Triangle != NO_HIT; }
+	};
+
+	struct Aabb
+	{
+		Vector3 Min = Vector3(Math::INF, Math::INF, Math::INF);
+		Vector3 Max = Vector3(-Math::INF, -Math::INF, -Math::INF);
+
+		void Grow(const Vector3& Point);
+		void Grow(const Aabb& Box);
+
+		Vector3 GetCenter() const { return 0.5f * (Min + Max); }
+		float GetArea() const;
+		bool IsEmpty() const { return Min.X > Max.X; }
+	};
+
+	// Four-wide BVH over a triangle mesh. A binned SAH build produces a binary
+	// tree that is then collapsed so every node holds the bounds of up to four
+	// children in SoA form; a ray tests all four boxes at once with SSE. Leaves
+	// point at blocks of four triangles, also SoA, intersected the same way.
+	class Bvh
+	{
+	public:
+		static const std::uint32_t WIDTH = 4;
+		static const std::uint32_t EMPTY = 0xFFFFFFFFu;
+		static const std::uint32_t LEAF = 0x80000000u;
+
+		// Deepest chain of nodes traversal has stack room for. Build() turns what
+		// would go deeper into larger leaves; loaders must reject deeper trees.
+		static const std::uint32_t MAX_DEPTH = 64;
+
+		// Child[i] is a node index, LEAF | first block for a leaf (with Count[i]
+		// blocks), or EMPTY for an unused slot.
+		struct alignas(64) Node
+		{
+			float MinX[WIDTH], MinY[WIDTH], MinZ[WIDTH];
+			float MaxX[WIDTH], MaxY[WIDTH], MaxZ[WIDTH];
+			std::uint32_t Child[WIDTH];
+			std::uint32_t Count[WIDTH];
+		};
+
+		// Precomputed Moller-Trumbore form. Unused lanes repeat a real triangle so
+		// they never report a different hit.
+		struct alignas(16) TriangleBlock
+		{
+			float V0X[WIDTH], V0Y[WIDTH], V0Z[WIDTH];
+			float E1X[WIDTH], E1Y[WIDTH], E1Z[WIDTH];
+			float E2X[WIDTH], E2Y[WIDTH], E2Z[WIDTH];
+			std::uint32_t Id[WIDTH];
+		};
+
+		Bvh() = default;
+		Bvh(const Bvh& Other) { *this = Other; }
+		Bvh(Bvh&& Other) noexcept { *this = std::move(Other); }
+		Bvh& operator=(const Bvh& Other);
+		Bvh& operator=(Bvh&& Other) noexcept;
+
+		// Indices hold three vertex indices per triangle. Triangle ids reported by
+		// Intersect() are positions in that list.
+		void Build(const Vector3* Positions, const std::uint32_t* Indices, std::size_t TriangleCount);
+
+		// Hits closer than Out.T only; the default Hit searches the whole ray.
+		bool Intersect(const Ray& R, Hit& Out) const;
+		bool Occluded(const Ray& R, float MaxT) const;
+
+		bool IsEmpty() const { return mNodeCount == 0; }
+		const Aabb& GetBounds() const { return mBounds; }
+
+		const Node* GetNodes() const { return mNodeData; }
+		std::size_t GetNodeCount() const { return mNodeCount; }
+		const TriangleBlock* GetBlocks() const { return mBlockData; }
+		std::size_t GetBlockCount() const { return mBlockCount; }
+
+		// Nodes on the longest path from the root. Children must follow their
+		// parent in the array, as Build() lays them out.
+		static std::uint32_t MeasureDepth(const Node* Nodes, std::size_t NodeCount);
+
+		// For loaders that already hold a built tree; Nodes[0] is the root.
+		void Assign(std::vector<Node> Nodes, std::vector<TriangleBlock> Blocks, const Aabb& Bounds);
+
+		// Same, without copying: the tree is traversed where it lies (e.g. in a
+		// mapped asset file), which must outlive this Bvh or the next Build().
+		void Attach(const Node* Nodes, std::size_t NodeCount,
+			const TriangleBlock* Blocks, std::size_t BlockCount, const Aabb& Bounds);
+
+	private:
+		template <bool AnyHit>
+		bool Traverse(const Ray& R, Hit& Out) const;
+
+		void BindOwned();
+
+		std::vector<Node> mNodes;
+		std::vector<TriangleBlock> mBlocks;
+		Aabb mBounds;
+
+		const Node* mNodeData = nullptr;
+		const TriangleBlock* mBlockData = nullptr;
+		std::size_t mNodeCount = 0;
+		std::size_t mBlockCount = 0;
+	};
+}
@@ -0,0 +1,1418 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#include "Collision.h"
+#include "Profiler.h"
+#include "Simd.h"
+
+namespace Collision
+{
+	namespace
+	{
+		const int GJK_MAX_ITER = 64;
+		const float GJK_REL_TOL = 1.0e-5f;
+		const float GJK_ABS_TOL = 1.0e-10f;
+
+		const int EPA_MAX_ITER = 64;
+		const int EPA_MAX_VERTS = 96;
+		const int EPA_MAX_FACES = 192;
+		const float EPA_TOL = 1.0e-4f;
+
+		const float CACHE_MATCH_DIST = 0.05f;
+		const float CACHE_BREAK_DIST = 0.02f;
+
+		Vector3 Rotate(const Quaternion& Quater, const Vector3& Vec)
+		{
+			return Vector3::Transform(Vec, Quater);
+		}
+
+		Vector3 InvRotate(const Quaternion& Quater, const Vector3& Vec)
+		{
+			Quaternion Temp = Quater;
+			Temp.Conjugate();
+			return Vector3::Transform(Vec, Temp);
+		}
+
+		float Sign(float Val) { return Val < 0.f ? -1.f : 1.f; }
+
+		// World-space view of a collider with its rotation already applied.
+		struct Proxy
+		{
+			ShapeType Type;
+			Vector3 Center;
+			Quaternion Rotation;
+			Vector3 Axis[3];
+			float Half[3];
+			float Radius;
+			const ConvexHull* Hull;
+
+			explicit Proxy(const Collider& Col)
+				: Type(Col.Type), Center(Col.Position), Rotation(Col.Rotation), Radius(Col.Radius), Hull(Col.Hull)
+			{
+				Axis[0] = Rotate(Rotation, Vector3::UnitX);
+				Axis[1] = Rotate(Rotation, Vector3::UnitY);
+				Axis[2] = Rotate(Rotation, Vector3::UnitZ);
+
+				Half[0] = Col.HalfExtents.X;
+				Half[1] = Col.HalfExtents.Y;
+				Half[2] = Col.HalfExtents.Z;
+			}
+
+			Vector3 Support(const Vector3& Dir, bool WithMargin) const
+			{
+				switch (Type)
+				{
+				case ShapeType::Sphere:
+				{
+					float Len = Dir.Length();
+
+					if (!WithMargin || Len <= 0.f)
+					{
+						return Center;
+					}
+					return Center + (Radius / Len) * Dir;
+				}
+				case ShapeType::Box:
+				{
+					Vector3 Temp = Center;
+
+					for (short i = 0; i < 3; ++i)
+					{
+						Temp += (Vector3::Dot(Dir, Axis[i]) >= 0.f ? Half[i] : -Half[i]) * Axis[i];
+					}
+					return Temp;
+				}
+				default:
+					return Center + Rotate(Rotation, Hull->Support(InvRotate(Rotation, Dir)));
+				}
+			}
+
+			float GetMargin() const { return Type == ShapeType::Sphere ? Radius : 0.f; }
+		};
+
+		struct SimplexVertex
+		{
+			Vector3 A;
+			Vector3 B;
+			Vector3 W;
+		};
+
+		struct Simplex
+		{
+			SimplexVertex V[4];
+			float Bary[4] = {};
+			int Count = 0;
+		};
+
+		SimplexVertex MakeVertex(const Proxy& A, const Proxy& B, const Vector3& Dir, bool WithMargin)
+		{
+			SimplexVertex Temp;
+			Temp.A = A.Support(Dir, WithMargin);
+			Temp.B = B.Support(-Dir, WithMargin);
+			Temp.W = Temp.A - Temp.B;
+			return Temp;
+		}
+
+		void Keep(Simplex& S, int I0, float B0)
+		{
+			S.V[0] = S.V[I0];
+			S.Bary[0] = B0;
+			S.Count = 1;
+		}
+
+		void Keep(Simplex& S, int I0, int I1, float B0, float B1)
+		{
+			SimplexVertex V0 = S.V[I0], V1 = S.V[I1];
+			S.V[0] = V0, S.V[1] = V1;
+			S.Bary[0] = B0, S.Bary[1] = B1;
+			S.Count = 2;
+		}
+
+		void SolveSegment(Simplex& S)
+		{
+			const Vector3& A = S.V[0].W;
+			Vector3 AB = S.V[1].W - A;
+
+			float Den = AB.Square();
+			float T = Den > 0.f ? -Vector3::Dot(A, AB) / Den : 0.f;
+
+			if (T <= 0.f)
+			{
+				Keep(S, 0, 1.f);
+			}
+			else if (T >= 1.f)
+			{
+				Keep(S, 1, 1.f);
+			}
+			else
+			{
+				S.Bary[0] = 1.f - T, S.Bary[1] = T;
+			}
+		}
+
+		// Closest point on triangle V[0..2] to the origin (Ericson, RTCD 5.1.5),
+		// reducing the simplex to the feature that holds it.
+		void SolveTriangle(Simplex& S)
+		{
+			const Vector3& A = S.V[0].W;
+			const Vector3& B = S.V[1].W;
+			const Vector3& C = S.V[2].W;
+
+			Vector3 AB = B - A, AC = C - A;
+
+			float D1 = -Vector3::Dot(AB, A);
+			float D2 = -Vector3::Dot(AC, A);
+
+			if (D1 <= 0.f && D2 <= 0.f)
+			{
+				Keep(S, 0, 1.f);
+				return;
+			}
+
+			float D3 = -Vector3::Dot(AB, B);
+			float D4 = -Vector3::Dot(AC, B);
+
+			if (D3 >= 0.f && D4 <= D3)
+			{
+				Keep(S, 1, 1.f);
+				return;
+			}
+
+			float VC = D1 * D4 - D3 * D2;
+
+			if (VC <= 0.f && D1 >= 0.f && D3 <= 0.f)
+			{
+				float V = D1 / (D1 - D3);
+				Keep(S, 0, 1, 1.f - V, V);
+				return;
+			}
+
+			float D5 = -Vector3::Dot(AB, C);
+			float D6 = -Vector3::Dot(AC, C);
+
+			if (D6 >= 0.f && D5 <= D6)
+			{
+				Keep(S, 2, 1.f);
+				return;
+			}
+
+			float VB = D5 * D2 - D1 * D6;
+
+			if (VB <= 0.f && D2 >= 0.f && D6 <= 0.f)
+			{
+				float W = D2 / (D2 - D6);
+				Keep(S, 0, 2, 1.f - W, W);
+				return;
+			}
+
+			float VA = D3 * D6 - D5 * D4;
+
+			if (VA <= 0.f && (D4 - D3) >= 0.f && (D5 - D6) >= 0.f)
+			{
+				float W = (D4 - D3) / ((D4 - D3) + (D5 - D6));
+				Keep(S, 1, 2, 1.f - W, W);
+				return;
+			}
+
+			float Den = 1.f / (VA + VB + VC);
+			float V = VB * Den, W = VC * Den;
+
+			S.Bary[0] = 1.f - V - W, S.Bary[1] = V, S.Bary[2] = W;
+		}
+
+		Vector3 GetClosest(const Simplex& S)
+		{
+			Vector3 Temp;
+
+			for (int i = 0; i < S.Count; ++i)
+			{
+				Temp += S.Bary[i] * S.V[i].W;
+			}
+			return Temp;
+		}
+
+		// Returns true if the origin is inside the tetrahedron; otherwise reduces
+		// the simplex to the closest face feature.
+		bool SolveTetrahedron(Simplex& S)
+		{
+			static const int Faces[4][4] =
+			{
+				{0, 1, 2, 3},
+				{0, 2, 3, 1},
+				{0, 3, 1, 2},
+				{1, 3, 2, 0}
+			};
+
+			Simplex Best;
+			float BestDist = Math::INF;
+			bool Outside = false;
+
+			for (short f = 0; f < 4; ++f)
+			{
+				const Vector3& A = S.V[Faces[f][0]].W;
+				Vector3 Normal = Vector3::Cross(S.V[Faces[f][1]].W - A, S.V[Faces[f][2]].W - A);
+
+				Vector3 ToD = S.V[Faces[f][3]].W - A;
+				float SignO = -Vector3::Dot(A, Normal);
+				float SignD = Vector3::Dot(ToD, Normal);
+
+				// A flat tetrahedron (common with box faces) has no inside, so every
+				// face is a candidate.
+				bool Flat = SignD * SignD <= 1.0e-10f * Normal.Square() * ToD.Square();
+
+				if (!Flat && SignO * SignD >= 0.f)
+				{
+					continue;
+				}
+
+				Outside = true;
+
+				Simplex Temp;
+				Temp.V[0] = S.V[Faces[f][0]];
+				Temp.V[1] = S.V[Faces[f][1]];
+				Temp.V[2] = S.V[Faces[f][2]];
+				Temp.Count = 3;
+				SolveTriangle(Temp);
+
+				float Dist = GetClosest(Temp).Square();
+
+				if (Dist < BestDist)
+				{
+					BestDist = Dist;
+					Best = Temp;
+				}
+			}
+
+			if (!Outside)
+			{
+				return true;
+			}
+
+			S = Best;
+			return false;
+		}
+
+		GjkResult RunGjk(const Proxy& A, const Proxy& B, bool WithMargin, Simplex& S)
+		{
+			GjkResult Result;
+
+			Vector3 Dir = B.Center - A.Center;
+
+			if (Dir.Square() <= GJK_ABS_TOL)
+			{
+				Dir = Vector3::UnitX;
+			}
+
+			S.V[0] = MakeVertex(A, B, -Dir, WithMargin);
+			S.Bary[0] = 1.f;
+			S.Count = 1;
+
+			Vector3 V = S.V[0].W;
+
+			for (int Iter = 0; Iter < GJK_MAX_ITER; ++Iter)
+			{
+				float VV = V.Square();
+
+				if (VV <= GJK_ABS_TOL)
+				{
+					Result.Overlap = true;
+					break;
+				}
+
+				SimplexVertex W = MakeVertex(A, B, -V, WithMargin);
+
+				if (VV - Vector3::Dot(V, W.W) <= GJK_REL_TOL * VV)
+				{
+					break;
+				}
+
+				bool Duplicate = false;
+
+				for (int i = 0; i < S.Count; ++i)
+				{
+					Duplicate |= (S.V[i].W - W.W).Square() <= GJK_ABS_TOL;
+				}
+
+				if (Duplicate)
+				{
+					break;
+				}
+
+				// Kept so a step that fails to get closer can be undone; the result
+				// must come from the simplex that produced V.
+				Simplex Prev = S;
+				S.V[S.Count++] = W;
+
+				if (S.Count == 2)
+				{
+					SolveSegment(S);
+				}
+				else if (S.Count == 3)
+				{
+					SolveTriangle(S);
+				}
+				else if (SolveTetrahedron(S))
+				{
+					Result.Overlap = true;
+					break;
+				}
+
+				Vector3 Next = GetClosest(S);
+
+				if (Next.Square() >= VV)
+				{
+					S = Prev;
+					break;
+				}
+				V = Next;
+			}
+
+			for (int i = 0; i < S.Count; ++i)
+			{
+				Result.PointA += S.Bary[i] * S.V[i].A;
+				Result.PointB += S.Bary[i] * S.V[i].B;
+			}
+
+			Result.Distance = Result.Overlap ? 0.f : V.Length();
+			return Result;
+		}
+
+		struct EpaFace
+		{
+			int V[3];
+			Vector3 Normal;
+			float Dist;
+			bool Alive;
+		};
+
+		struct EpaEdge
+		{
+			int A;
+			int B;
+		};
+
+		bool MakeFace(EpaFace& Face, const SimplexVertex* Verts, int A, int B, int C)
+		{
+			Vector3 Normal = Vector3::Cross(Verts[B].W - Verts[A].W, Verts[C].W - Verts[A].W);
+			float Len = Normal.Length();
+
+			if (Len <= 1.0e-12f)
+			{
+				return false;
+			}
+
+			Face.V[0] = A, Face.V[1] = B, Face.V[2] = C;
+			Face.Normal = (1.f / Len) * Normal;
+			Face.Dist = Vector3::Dot(Face.Normal, Verts[A].W);
+			Face.Alive = true;
+			return true;
+		}
+
+		// Grows a GJK simplex that touches the origin into a full tetrahedron.
+		bool InflateSimplex(const Proxy& A, const Proxy& B, Simplex& S)
+		{
+			static const Vector3 Axes[6] =
+			{
+				Vector3(1.f, 0.f, 0.f), Vector3(-1.f, 0.f, 0.f),
+				Vector3(0.f, 1.f, 0.f), Vector3(0.f, -1.f, 0.f),
+				Vector3(0.f, 0.f, 1.f), Vector3(0.f, 0.f, -1.f)
+			};
+
+			if (S.Count == 1)
+			{
+				for (short i = 0; i < 6 && S.Count == 1; ++i)
+				{
+					SimplexVertex W = MakeVertex(A, B, Axes[i], true);
+
+					if ((W.W - S.V[0].W).Square() > GJK_ABS_TOL)
+					{
+						S.V[S.Count++] = W;
+					}
+				}
+			}
+
+			if (S.Count == 2)
+			{
+				Vector3 Dir = Vector3::Norm(S.V[1].W - S.V[0].W);
+				Vector3 Pick = Math::Abs(Dir.X) < 0.57f ? Vector3::UnitX : (Math::Abs(Dir.Y) < 0.57f ? Vector3::UnitY : Vector3::UnitZ);
+				Vector3 Perp = Vector3::Cross(Dir, Pick);
+				Quaternion Step(Dir, Math::PI / 3.f);
+
+				for (short i = 0; i < 6 && S.Count == 2; ++i)
+				{
+					SimplexVertex W = MakeVertex(A, B, Perp, true);
+
+					if (Vector3::Cross(S.V[1].W - S.V[0].W, W.W - S.V[0].W).Square() > GJK_ABS_TOL)
+					{
+						S.V[S.Count++] = W;
+					}
+					Perp = Rotate(Step, Perp);
+				}
+			}
+
+			if (S.Count == 3)
+			{
+				Vector3 Normal = Vector3::Cross(S.V[1].W - S.V[0].W, S.V[2].W - S.V[0].W);
+				SimplexVertex W = MakeVertex(A, B, Normal, true);
+
+				if (Math::Abs(Vector3::Dot(W.W - S.V[0].W, Normal)) <= GJK_ABS_TOL)
+				{
+					W = MakeVertex(A, B, -Normal, true);
+				}
+
+				if (Math::Abs(Vector3::Dot(W.W - S.V[0].W, Normal)) > GJK_ABS_TOL)
+				{
+					S.V[S.Count++] = W;
+				}
+			}
+			return S.Count == 4;
+		}
+
+		PenetrationResult RunEpa(const Proxy& A, const Proxy& B, Simplex& S)
+		{
+			PenetrationResult Result;
+
+			if (!InflateSimplex(A, B, S))
+			{
+				return Result;
+			}
+
+			SimplexVertex Verts[EPA_MAX_VERTS];
+			EpaFace Faces[EPA_MAX_FACES];
+			EpaEdge Horizon[EPA_MAX_FACES];
+
+			int NumVerts = 4, NumFaces = 0;
+
+			for (short i = 0; i < 4; ++i)
+			{
+				Verts[i] = S.V[i];
+			}
+
+			// Wind the tetrahedron so every face normal points away from the opposite vertex.
+			static const int Tetra[4][4] = { {0, 1, 2, 3}, {0, 3, 1, 2}, {0, 2, 3, 1}, {1, 3, 2, 0} };
+
+			for (short f = 0; f < 4; ++f)
+			{
+				int I0 = Tetra[f][0], I1 = Tetra[f][1], I2 = Tetra[f][2];
+				Vector3 Normal = Vector3::Cross(Verts[I1].W - Verts[I0].W, Verts[I2].W - Verts[I0].W);
+
+				if (Vector3::Dot(Normal, Verts[Tetra[f][3]].W - Verts[I0].W) > 0.f)
+				{
+					int Swap = I1;
+					I1 = I2, I2 = Swap;
+				}
+
+				if (!MakeFace(Faces[NumFaces], Verts, I0, I1, I2))
+				{
+					return Result;
+				}
+				++NumFaces;
+			}
+
+			int Closest = 0;
+
+			for (int Iter = 0; Iter < EPA_MAX_ITER; ++Iter)
+			{
+				Closest = -1;
+
+				for (int f = 0; f < NumFaces; ++f)
+				{
+					if (Faces[f].Alive && (Closest < 0 || Faces[f].Dist < Faces[Closest].Dist))
+					{
+						Closest = f;
+					}
+				}
+
+				if (Closest < 0)
+				{
+					return Result;
+				}
+
+				SimplexVertex W = MakeVertex(A, B, Faces[Closest].Normal, true);
+				float Gain = Vector3::Dot(W.W, Faces[Closest].Normal) - Faces[Closest].Dist;
+
+				if (Gain <= EPA_TOL || NumVerts == EPA_MAX_VERTS)
+				{
+					break;
+				}
+
+				// Find the faces W can see and their horizon without touching the
+				// polytope, so running out of room leaves it whole.
+				bool Visible[EPA_MAX_FACES];
+				int NumEdges = 0;
+
+				for (int f = 0; f < NumFaces; ++f)
+				{
+					Visible[f] = Faces[f].Alive && Vector3::Dot(Faces[f].Normal, W.W - Verts[Faces[f].V[0]].W) > 0.f;
+
+					if (!Visible[f])
+					{
+						continue;
+					}
+
+					for (short e = 0; e < 3; ++e)
+					{
+						EpaEdge Edge = { Faces[f].V[e], Faces[f].V[(e + 1) % 3] };
+						bool Shared = false;
+
+						for (int h = 0; h < NumEdges; ++h)
+						{
+							if (Horizon[h].A == Edge.B && Horizon[h].B == Edge.A)
+							{
+								Horizon[h] = Horizon[--NumEdges];
+								Shared = true;
+								break;
+							}
+						}
+
+						if (!Shared && NumEdges < EPA_MAX_FACES)
+						{
+							Horizon[NumEdges++] = Edge;
+						}
+					}
+				}
+
+				int Live = 0;
+
+				for (int f = 0; f < NumFaces; ++f)
+				{
+					Live += Faces[f].Alive && !Visible[f] ? 1 : 0;
+				}
+
+				if (Live + NumEdges > EPA_MAX_FACES)
+				{
+					break;
+				}
+
+				int NewIdx = NumVerts;
+				Verts[NumVerts++] = W;
+
+				// Compact dead and visible faces before adding the new fan.
+				Live = 0;
+
+				for (int f = 0; f < NumFaces; ++f)
+				{
+					if (Faces[f].Alive && !Visible[f])
+					{
+						Faces[Live++] = Faces[f];
+					}
+				}
+				NumFaces = Live;
+
+				for (int h = 0; h < NumEdges; ++h)
+				{
+					if (MakeFace(Faces[NumFaces], Verts, Horizon[h].A, Horizon[h].B, NewIdx))
+					{
+						++NumFaces;
+					}
+				}
+			}
+
+			// Compaction moves faces, so the index picked in the loop may be stale.
+			Closest = -1;
+
+			for (int f = 0; f < NumFaces; ++f)
+			{
+				if (Faces[f].Alive && (Closest < 0 || Faces[f].Dist < Faces[Closest].Dist))
+				{
+					Closest = f;
+				}
+			}
+
+			if (Closest < 0)
+			{
+				return Result;
+			}
+
+			const EpaFace& Face = Faces[Closest];
+			const SimplexVertex& V0 = Verts[Face.V[0]];
+			const SimplexVertex& V1 = Verts[Face.V[1]];
+			const SimplexVertex& V2 = Verts[Face.V[2]];
+
+			// Barycentric coordinates of the origin's projection onto the face.
+			Vector3 P = Face.Dist * Face.Normal;
+			Vector3 E0 = V1.W - V0.W, E1 = V2.W - V0.W, E2 = P - V0.W;
+
+			float D00 = Vector3::Dot(E0, E0), D01 = Vector3::Dot(E0, E1), D11 = Vector3::Dot(E1, E1);
+			float D20 = Vector3::Dot(E2, E0), D21 = Vector3::Dot(E2, E1);
+			float Den = D00 * D11 - D01 * D01;
+
+			float V = Den != 0.f ? (D11 * D20 - D01 * D21) / Den : 0.f;
+			float U = Den != 0.f ? (D00 * D21 - D01 * D20) / Den : 0.f;
+			float T = 1.f - V - U;
+
+			Result.Valid = true;
+			Result.Normal = Face.Normal;
+			Result.Depth = Face.Dist;
+			Result.PointA = T * V0.A + V * V1.A + U * V2.A;
+			Result.PointB = T * V0.B + V * V1.B + U * V2.B;
+			return Result;
+		}
+
+		void SetPoint(ContactPoint& Point, const Collider& A, const Collider& B, const Vector3& OnA, const Vector3& OnB, float Depth)
+		{
+			Point.Position = 0.5f * (OnA + OnB);
+			Point.Depth = Depth;
+			Point.LocalA = InvRotate(A.Rotation, OnA - A.Position);
+			Point.LocalB = InvRotate(B.Rotation, OnB - B.Position);
+			Point.NormalImpulse = 0.f;
+			Point.TangentImpulse[0] = Point.TangentImpulse[1] = 0.f;
+		}
+
+		// Keeps the deepest point, the one farthest from it, and the two that span
+		// the largest area on either side of that segment.
+		std::uint32_t ReduceContacts(ContactPoint* Points, std::uint32_t Count, const Vector3& Normal)
+		{
+			if (Count <= MAX_CONTACTS)
+			{
+				return Count;
+			}
+
+			std::uint32_t Pick[4] = {0, 0, 0, 0};
+
+			for (std::uint32_t i = 1; i < Count; ++i)
+			{
+				Pick[0] = Points[i].Depth > Points[Pick[0]].Depth ? i : Pick[0];
+			}
+
+			float Best = -1.f;
+
+			for (std::uint32_t i = 0; i < Count; ++i)
+			{
+				float Dist = (Points[i].Position - Points[Pick[0]].Position).Square();
+
+				if (Dist > Best)
+				{
+					Best = Dist, Pick[1] = i;
+				}
+			}
+
+			Vector3 Edge = Points[Pick[1]].Position - Points[Pick[0]].Position;
+			float MaxArea = -Math::INF, MinArea = Math::INF;
+
+			for (std::uint32_t i = 0; i < Count; ++i)
+			{
+				float Area = Vector3::Dot(Vector3::Cross(Edge, Points[i].Position - Points[Pick[0]].Position), Normal);
+
+				if (Area > MaxArea)
+				{
+					MaxArea = Area, Pick[2] = i;
+				}
+
+				if (Area < MinArea)
+				{
+					MinArea = Area, Pick[3] = i;
+				}
+			}
+
+			ContactPoint Temp[4];
+			std::uint32_t Kept = 0;
+
+			for (short i = 0; i < 4; ++i)
+			{
+				bool Duplicate = false;
+
+				for (std::uint32_t j = 0; j < Kept; ++j)
+				{
+					Duplicate |= Temp[j].Position.X == Points[Pick[i]].Position.X &&
+						Temp[j].Position.Y == Points[Pick[i]].Position.Y &&
+						Temp[j].Position.Z == Points[Pick[i]].Position.Z;
+				}
+
+				if (!Duplicate)
+				{
+					Temp[Kept++] = Points[Pick[i]];
+				}
+			}
+
+			for (std::uint32_t i = 0; i < Kept; ++i)
+			{
+				Points[i] = Temp[i];
+			}
+			return Kept;
+		}
+
+		void FlipManifold(Manifold& Out)
+		{
+			Out.Normal = -Out.Normal;
+
+			for (std::uint32_t i = 0; i < Out.Count; ++i)
+			{
+				Vector3 Temp = Out.Points[i].LocalA;
+				Out.Points[i].LocalA = Out.Points[i].LocalB;
+				Out.Points[i].LocalB = Temp;
+			}
+		}
+
+		bool SphereSphere(const Collider& A, const Collider& B, Manifold& Out)
+		{
+			Vector3 Delta = B.Position - A.Position;
+			float Dist = Delta.Length();
+			float Sum = A.Radius + B.Radius;
+
+			if (Dist > Sum)
+			{
+				return false;
+			}
+
+			Out.Normal = Dist > 1.0e-6f ? (1.f / Dist) * Delta : Vector3::UnitY;
+			Out.Count = 1;
+			SetPoint(Out.Points[0], A, B, A.Position + A.Radius * Out.Normal, B.Position - B.Radius * Out.Normal, Sum - Dist);
+			return true;
+		}
+
+		bool SphereBox(const Collider& A, const Collider& B, Manifold& Out)
+		{
+			Vector3 Local = InvRotate(B.Rotation, A.Position - B.Position);
+			float Half[3] = { B.HalfExtents.X, B.HalfExtents.Y, B.HalfExtents.Z };
+			float Center[3] = { Local.X, Local.Y, Local.Z };
+			float Clamped[3];
+			bool Inside = true;
+
+			for (short i = 0; i < 3; ++i)
+			{
+				Clamped[i] = Math::Clamp(Center[i], -Half[i], Half[i]);
+				Inside &= Clamped[i] == Center[i];
+			}
+
+			Vector3 OutLocal;
+			float Depth;
+
+			if (Inside)
+			{
+				short Axis = 0;
+				float MinGap = Math::INF;
+
+				for (short i = 0; i < 3; ++i)
+				{
+					float Gap = Half[i] - Math::Abs(Center[i]);
+
+					if (Gap < MinGap)
+					{
+						MinGap = Gap, Axis = i;
+					}
+				}
+
+				float Face[3] = { 0.f, 0.f, 0.f };
+				Face[Axis] = Sign(Center[Axis]);
+				Clamped[Axis] = Face[Axis] * Half[Axis];
+
+				OutLocal.Set(Face[0], Face[1], Face[2]);
+				Depth = A.Radius + MinGap;
+			}
+			else
+			{
+				Vector3 Diff(Center[0] - Clamped[0], Center[1] - Clamped[1], Center[2] - Clamped[2]);
+				float Dist = Diff.Length();
+
+				if (Dist > A.Radius)
+				{
+					return false;
+				}
+
+				OutLocal = (1.f / Dist) * Diff;
+				Depth = A.Radius - Dist;
+			}
+
+			Vector3 OutWorld = Rotate(B.Rotation, OutLocal);
+			Vector3 OnB = B.Position + Rotate(B.Rotation, Vector3(Clamped[0], Clamped[1], Clamped[2]));
+
+			Out.Normal = -OutWorld;
+			Out.Count = 1;
+			SetPoint(Out.Points[0], A, B, A.Position - A.Radius * OutWorld, OnB, Depth);
+			return true;
+		}
+
+		bool ConvexConvex(const Collider& A, const Collider& B, Manifold& Out)
+		{
+			Proxy PA(A), PB(B);
+			Simplex S;
+
+			GjkResult Core = RunGjk(PA, PB, false, S);
+			float Margin = PA.GetMargin() + PB.GetMargin();
+
+			Vector3 OnA, OnB;
+			float Depth;
+
+			if (!Core.Overlap)
+			{
+				if (Core.Distance > Margin || Margin <= 0.f)
+				{
+					return false;
+				}
+
+				Out.Normal = (1.f / Core.Distance) * (Core.PointB - Core.PointA);
+				OnA = Core.PointA + PA.GetMargin() * Out.Normal;
+				OnB = Core.PointB - PB.GetMargin() * Out.Normal;
+				Depth = Margin - Core.Distance;
+			}
+			else
+			{
+				// Cores overlap, so the full shapes do too; rerun GJK with margins to seed EPA.
+				if (Margin > 0.f)
+				{
+					RunGjk(PA, PB, true, S);
+				}
+
+				PenetrationResult Pen = RunEpa(PA, PB, S);
+
+				if (!Pen.Valid)
+				{
+					return false;
+				}
+
+				Out.Normal = Pen.Normal;
+				OnA = Pen.PointA;
+				OnB = Pen.PointB;
+				Depth = Pen.Depth;
+			}
+
+			Out.Count = 1;
+			SetPoint(Out.Points[0], A, B, OnA, OnB, Depth);
+			return true;
+		}
+
+		int ClipPolygon(const Vector3* In, int Count, const Vector3& Normal, float Offset, Vector3* Out)
+		{
+			int NumOut = 0;
+
+			for (int i = 0; i < Count; ++i)
+			{
+				const Vector3& P0 = In[i];
+				const Vector3& P1 = In[(i + 1) % Count];
+
+				float D0 = Vector3::Dot(Normal, P0) - Offset;
+				float D1 = Vector3::Dot(Normal, P1) - Offset;
+
+				if (D0 <= 0.f)
+				{
+					Out[NumOut++] = P0;
+				}
+
+				if ((D0 < 0.f && D1 > 0.f) || (D0 > 0.f && D1 < 0.f))
+				{
+					Out[NumOut++] = Vector3::Lerp(P0, P1, D0 / (D0 - D1));
+				}
+			}
+			return NumOut;
+		}
+
+		bool IsSinglePointPair(const Collider& A, const Collider& B)
+		{
+			bool AnySphere = A.Type == ShapeType::Sphere || B.Type == ShapeType::Sphere;
+			bool AnyHull = A.Type == ShapeType::Hull || B.Type == ShapeType::Hull;
+			return AnyHull && !AnySphere;
+		}
+	}
+
+	void ConvexHull::Set(const Vector3* Points, std::size_t Count)
+	{
+		mCount = Count;
+
+		std::size_t Padded = (Count + 3) & ~static_cast<std::size_t>(3);
+		mX.resize(Padded);
+		mY.resize(Padded);
+		mZ.resize(Padded);
+
+		for (std::size_t i = 0; i < Padded; ++i)
+		{
+			const Vector3& Point = Points[i < Count ? i : Count - 1];
+			mX[i] = Point.X, mY[i] = Point.Y, mZ[i] = Point.Z;
+		}
+	}
+
+	Vector3 ConvexHull::Support(const Vector3& Dir) const
+	{
+		std::size_t Best = 0;
+
+#if MIR_SIMD_SSE
+		__m128 Dx = _mm_set1_ps(Dir.X), Dy = _mm_set1_ps(Dir.Y), Dz = _mm_set1_ps(Dir.Z);
+		__m128 BestDot = _mm_set1_ps(-Math::INF);
+		__m128i BestIdx = _mm_setzero_si128();
+		__m128i Idx = _mm_set_epi32(3, 2, 1, 0);
+		const __m128i Four = _mm_set1_epi32(4);
+
+		for (std::size_t i = 0; i < mX.size(); i += 4)
+		{
+			__m128 Dot = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_loadu_ps(&mX[i]), Dx),
+				_mm_mul_ps(_mm_loadu_ps(&mY[i]), Dy)),
+				_mm_mul_ps(_mm_loadu_ps(&mZ[i]), Dz));
+
+			__m128 Mask = _mm_cmpgt_ps(Dot, BestDot);
+			BestDot = _mm_max_ps(Dot, BestDot);
+			BestIdx = _mm_or_si128(_mm_and_si128(_mm_castps_si128(Mask), Idx), _mm_andnot_si128(_mm_castps_si128(Mask), BestIdx));
+			Idx = _mm_add_epi32(Idx, Four);
+		}
+
+		alignas(16) float Dots[4];
+		alignas(16) std::int32_t Indices[4];
+		_mm_store_ps(Dots, BestDot);
+		_mm_store_si128(reinterpret_cast<__m128i*>(Indices), BestIdx);
+
+		Best = static_cast<std::size_t>(Indices[0]);
+
+		for (short i = 1; i < 4; ++i)
+		{
+			if (Dots[i] > Dots[0])
+			{
+				Dots[0] = Dots[i];
+				Best = static_cast<std::size_t>(Indices[i]);
+			}
+		}
+#else
+		float BestDot = -Math::INF;
+
+		for (std::size_t i = 0; i < mCount; ++i)
+		{
+			float Dot = mX[i] * Dir.X + mY[i] * Dir.Y + mZ[i] * Dir.Z;
+
+			if (Dot > BestDot)
+			{
+				BestDot = Dot, Best = i;
+			}
+		}
+#endif
+		return GetPoint(Best);
+	}
+
+	Collider Collider::MakeSphere(const Vector3& Position, float Radius)
+	{
+		Collider Temp;
+		Temp.Type = ShapeType::Sphere;
+		Temp.Position = Position;
+		Temp.Radius = Radius;
+		return Temp;
+	}
+
+	Collider Collider::MakeBox(const Vector3& Position, const Quaternion& Rotation, const Vector3& HalfExtents)
+	{
+		Collider Temp;
+		Temp.Type = ShapeType::Box;
+		Temp.Position = Position;
+		Temp.Rotation = Rotation;
+		Temp.HalfExtents = HalfExtents;
+		return Temp;
+	}
+
+	Collider Collider::MakeHull(const Vector3& Position, const Quaternion& Rotation, const ConvexHull& Hull)
+	{
+		Collider Temp;
+		Temp.Type = ShapeType::Hull;
+		Temp.Position = Position;
+		Temp.Rotation = Rotation;
+		Temp.Hull = &Hull;
+		return Temp;
+	}
+
+	GjkResult Gjk(const Collider& A, const Collider& B)
+	{
+		Simplex S;
+		return RunGjk(Proxy(A), Proxy(B), false, S);
+	}
+
+	PenetrationResult Epa(const Collider& A, const Collider& B)
+	{
+		Proxy PA(A), PB(B);
+		Simplex S;
+
+		if (!RunGjk(PA, PB, true, S).Overlap)
+		{
+			return PenetrationResult();
+		}
+		return RunEpa(PA, PB, S);
+	}
+
+	bool SatBoxBox(const Collider& A, const Collider& B, Manifold& Out)
+	{
+		Proxy PA(A), PB(B);
+
+		float R[3][3], AbsR[3][3];
+
+		for (short i = 0; i < 3; ++i)
+		{
+			for (short j = 0; j < 3; ++j)
+			{
+				R[i][j] = Vector3::Dot(PA.Axis[i], PB.Axis[j]);
+				AbsR[i][j] = Math::Abs(R[i][j]) + 1.0e-6f;
+			}
+		}
+
+		Vector3 Delta = PB.Center - PA.Center;
+
+		float FacePenA = Math::INF, FacePenB = Math::INF, EdgePen = Math::INF;
+		short FaceA = 0, FaceB = 0, EdgeA = 0, EdgeB = 0;
+		Vector3 EdgeNormal;
+
+		for (short i = 0; i < 3; ++i)
+		{
+			float Dist = Vector3::Dot(Delta, PA.Axis[i]);
+			float Ra = PA.Half[i];
+			float Rb = PB.Half[0] * AbsR[i][0] + PB.Half[1] * AbsR[i][1] + PB.Half[2] * AbsR[i][2];
+			float Pen = Ra + Rb - Math::Abs(Dist);
+
+			if (Pen < 0.f)
+			{
+				return false;
+			}
+
+			if (Pen < FacePenA)
+			{
+				FacePenA = Pen, FaceA = i;
+			}
+		}
+
+		for (short j = 0; j < 3; ++j)
+		{
+			float Dist = Vector3::Dot(Delta, PB.Axis[j]);
+			float Ra = PA.Half[0] * AbsR[0][j] + PA.Half[1] * AbsR[1][j] + PA.Half[2] * AbsR[2][j];
+			float Rb = PB.Half[j];
+			float Pen = Ra + Rb - Math::Abs(Dist);
+
+			if (Pen < 0.f)
+			{
+				return false;
+			}
+
+			if (Pen < FacePenB)
+			{
+				FacePenB = Pen, FaceB = j;
+			}
+		}
+
+		for (short i = 0; i < 3; ++i)
+		{
+			for (short j = 0; j < 3; ++j)
+			{
+				Vector3 Axis = Vector3::Cross(PA.Axis[i], PB.Axis[j]);
+				float Len = Axis.Length();
+
+				if (Len < 1.0e-4f)
+				{
+					continue;
+				}
+
+				Axis *= 1.f / Len;
+
+				float Ra = 0.f, Rb = 0.f;
+
+				for (short k = 0; k < 3; ++k)
+				{
+					Ra += PA.Half[k] * Math::Abs(Vector3::Dot(PA.Axis[k], Axis));
+					Rb += PB.Half[k] * Math::Abs(Vector3::Dot(PB.Axis[k], Axis));
+				}
+
+				float Dist = Vector3::Dot(Delta, Axis);
+				float Pen = Ra + Rb - Math::Abs(Dist);
+
+				if (Pen < 0.f)
+				{
+					return false;
+				}
+
+				if (Pen < EdgePen)
+				{
+					EdgePen = Pen, EdgeA = i, EdgeB = j;
+					EdgeNormal = Sign(Dist) * Axis;
+				}
+			}
+		}
+
+		// Face contacts are more stable, so edges only win by a clear margin.
+		const float RelTol = 0.95f, AbsTol = 0.01f;
+		bool UseB = FacePenB < RelTol * FacePenA - AbsTol;
+		float FacePen = UseB ? FacePenB : FacePenA;
+
+		if (EdgePen < RelTol * FacePen - AbsTol)
+		{
+			Vector3 OnA = PA.Center, OnB = PB.Center;
+
+			for (short k = 0; k < 3; ++k)
+			{
+				if (k != EdgeA)
+				{
+					OnA += (Vector3::Dot(EdgeNormal, PA.Axis[k]) > 0.f ? PA.Half[k] : -PA.Half[k]) * PA.Axis[k];
+				}
+
+				if (k != EdgeB)
+				{
+					OnB += (Vector3::Dot(EdgeNormal, PB.Axis[k]) > 0.f ? -PB.Half[k] : PB.Half[k]) * PB.Axis[k];
+				}
+			}
+
+			// Closest points between the two supporting edges.
+			const Vector3& D1 = PA.Axis[EdgeA];
+			const Vector3& D2 = PB.Axis[EdgeB];
+			Vector3 Diff = OnA - OnB;
+
+			float B12 = Vector3::Dot(D1, D2);
+			float C = Vector3::Dot(D1, Diff);
+			float F = Vector3::Dot(D2, Diff);
+			float Den = 1.f - B12 * B12;
+
+			float S = Den > 1.0e-6f ? (B12 * F - C) / Den : 0.f;
+			S = Math::Clamp(S, -PA.Half[EdgeA], PA.Half[EdgeA]);
+
+			float T = Math::Clamp(B12 * S + F, -PB.Half[EdgeB], PB.Half[EdgeB]);
+
+			Out.Normal = EdgeNormal;
+			Out.Count = 1;
+			SetPoint(Out.Points[0], A, B, OnA + S * D1, OnB + T * D2, EdgePen);
+			return true;
+		}
+
+		const Proxy& Ref = UseB ? PB : PA;
+		const Proxy& Inc = UseB ? PA : PB;
+		short RefAxis = UseB ? FaceB : FaceA;
+
+		// Reference face normal points from the reference box toward the incident one.
+		Vector3 RefNormal = Sign(Vector3::Dot(Inc.Center - Ref.Center, Ref.Axis[RefAxis])) * Ref.Axis[RefAxis];
+		Vector3 RefCenter = Ref.Center + Ref.Half[RefAxis] * RefNormal;
+
+		short IncAxis = 0;
+		float MaxAlign = -1.f;
+
+		for (short k = 0; k < 3; ++k)
+		{
+			float Align = Math::Abs(Vector3::Dot(Inc.Axis[k], RefNormal));
+
+			if (Align > MaxAlign)
+			{
+				MaxAlign = Align, IncAxis = k;
+			}
+		}
+
+		Vector3 IncNormal = -Sign(Vector3::Dot(Inc.Axis[IncAxis], RefNormal)) * Inc.Axis[IncAxis];
+		Vector3 IncCenter = Inc.Center + Inc.Half[IncAxis] * IncNormal;
+
+		short U = (IncAxis + 1) % 3, V = (IncAxis + 2) % 3;
+		Vector3 Du = Inc.Half[U] * Inc.Axis[U], Dv = Inc.Half[V] * Inc.Axis[V];
+
+		Vector3 Poly[8], Clip[8];
+		Poly[0] = IncCenter + Du + Dv;
+		Poly[1] = IncCenter - Du + Dv;
+		Poly[2] = IncCenter - Du - Dv;
+		Poly[3] = IncCenter + Du - Dv;
+		int Count = 4;
+
+		for (short k = 1; k < 3 && Count > 0; ++k)
+		{
+			short Side = (RefAxis + k) % 3;
+			const Vector3& Tangent = Ref.Axis[Side];
+			float Center = Vector3::Dot(Tangent, Ref.Center);
+
+			Count = ClipPolygon(Poly, Count, Tangent, Center + Ref.Half[Side], Clip);
+			Count = ClipPolygon(Clip, Count, -Tangent, -Center + Ref.Half[Side], Poly);
+		}
+
+		ContactPoint Candidates[8];
+		std::uint32_t NumCandidates = 0;
+		Out.Normal = UseB ? -RefNormal : RefNormal;
+
+		for (int i = 0; i < Count; ++i)
+		{
+			float Sep = Vector3::Dot(RefNormal, Poly[i] - RefCenter);
+
+			if (Sep > 0.f)
+			{
+				continue;
+			}
+
+			Vector3 OnRef = Poly[i] - Sep * RefNormal;
+
+			if (UseB)
+			{
+				SetPoint(Candidates[NumCandidates++], A, B, Poly[i], OnRef, -Sep);
+			}
+			else
+			{
+				SetPoint(Candidates[NumCandidates++], A, B, OnRef, Poly[i], -Sep);
+			}
+		}
+
+		if (NumCandidates == 0)
+		{
+			return false;
+		}
+
+		Out.Count = ReduceContacts(Candidates, NumCandidates, Out.Normal);
+
+		for (std::uint32_t i = 0; i < Out.Count; ++i)
+		{
+			Out.Points[i] = Candidates[i];
+		}
+		return true;
+	}
+
+	bool Collide(const Collider& A, const Collider& B, Manifold& Out)
+	{
+		Out.Count = 0;
+
+		if (A.Type == ShapeType::Sphere && B.Type == ShapeType::Sphere)
+		{
+			return SphereSphere(A, B, Out);
+		}
+
+		if (A.Type == ShapeType::Sphere && B.Type == ShapeType::Box)
+		{
+			return SphereBox(A, B, Out);
+		}
+
+		if (A.Type == ShapeType::Box && B.Type == ShapeType::Sphere)
+		{
+			if (!SphereBox(B, A, Out))
+			{
+				return false;
+			}
+			FlipManifold(Out);
+			return true;
+		}
+
+		if (A.Type == ShapeType::Box && B.Type == ShapeType::Box)
+		{
+			return SatBoxBox(A, B, Out);
+		}
+		return ConvexConvex(A, B, Out);
+	}
+
+	ManifoldCache::ManifoldCache(std::size_t ExpectedPairs)
+		: mNodePool(NODE_SIZE, 256),
+		mPairs(ExpectedPairs, std::hash<std::uint64_t>(), std::equal_to<std::uint64_t>(), Memory::PoolAllocator<Value>(mNodePool)),
+		mFrame(1)
+	{
+	}
+
+	void ManifoldCache::Update(const Collider& A, const Collider& B, Manifold& Fresh, bool Accumulate)
+	{
+		std::uint64_t Key = (static_cast<std::uint64_t>(Fresh.BodyA) << 32) | Fresh.BodyB;
+		auto Iter = mPairs.find(Key);
+
+		if (Iter == mPairs.end())
+		{
+			Entry Temp;
+			Temp.Data = Fresh;
+			Temp.Frame = mFrame;
+			mPairs.emplace(Key, Temp);
+			return;
+		}
+
+		const Manifold& Old = Iter->second.Data;
+		bool Used[MAX_CONTACTS] = { false, false, false, false };
+
+		for (std::uint32_t i = 0; i < Fresh.Count; ++i)
+		{
+			float Best = CACHE_MATCH_DIST * CACHE_MATCH_DIST;
+			int Match = -1;
+
+			for (std::uint32_t j = 0; j < Old.Count; ++j)
+			{
+				float Dist = (Old.Points[j].LocalA - Fresh.Points[i].LocalA).Square();
+
+				if (!Used[j] && Dist < Best)
+				{
+					Best = Dist, Match = static_cast<int>(j);
+				}
+			}
+
+			if (Match >= 0)
+			{
+				Used[Match] = true;
+				Fresh.Points[i].NormalImpulse = Old.Points[Match].NormalImpulse;
+				Fresh.Points[i].TangentImpulse[0] = Old.Points[Match].TangentImpulse[0];
+				Fresh.Points[i].TangentImpulse[1] = Old.Points[Match].TangentImpulse[1];
+			}
+		}
+
+		if (Accumulate)
+		{
+			// Single-point routines rebuild a full manifold over several frames by
+			// keeping old points that are still touching and have not slid apart.
+			ContactPoint Candidates[MAX_CONTACTS * 2];
+			std::uint32_t NumCandidates = 0;
+
+			for (std::uint32_t i = 0; i < Fresh.Count; ++i)
+			{
+				Candidates[NumCandidates++] = Fresh.Points[i];
+			}
+
+			for (std::uint32_t j = 0; j < Old.Count; ++j)
+			{
+				if (Used[j])
+				{
+					continue;
+				}
+
+				ContactPoint Point = Old.Points[j];
+				Vector3 OnA = A.Position + Rotate(A.Rotation, Point.LocalA);
+				Vector3 OnB = B.Position + Rotate(B.Rotation, Point.LocalB);
+				Vector3 Gap = OnA - OnB;
+
+				float Depth = Vector3::Dot(Gap, Fresh.Normal);
+				Vector3 Drift = Gap - Depth * Fresh.Normal;
+
+				if (Depth < -CACHE_BREAK_DIST || Drift.Square() > CACHE_BREAK_DIST * CACHE_BREAK_DIST)
+				{
+					continue;
+				}
+
+				Point.Position = 0.5f * (OnA + OnB);
+				Point.Depth = Depth;
+				Candidates[NumCandidates++] = Point;
+			}
+
+			Fresh.Count = ReduceContacts(Candidates, NumCandidates, Fresh.Normal);
+
+			for (std::uint32_t i = 0; i < Fresh.Count; ++i)
+			{
+				Fresh.Points[i] = Candidates[i];
+			}
+		}
+
+		Iter->second.Data = Fresh;
+		Iter->second.Frame = mFrame;
+	}
+
+	void ManifoldCache::Store(const Manifold& Solved)
+	{
+		auto Iter = mPairs.find((static_cast<std::uint64_t>(Solved.BodyA) << 32) | Solved.BodyB);
+
+		if (Iter != mPairs.end())
+		{
+			Iter->second.Data = Solved;
+		}
+	}
+
+	void ManifoldCache::EndFrame()
+	{
+		for (auto Iter = mPairs.begin(); Iter != mPairs.end();)
+		{
+			Iter = Iter->second.Frame == mFrame ? std::next(Iter) : mPairs.erase(Iter);
+		}
+		++mFrame;
+	}
+
+	std::size_t CollideBatch(const Collider* Colliders, const CollisionPair* Pairs, std::size_t Count,
+		ManifoldCache& Cache, Manifold* Out)
+	{
+		MIR_PROFILE_SCOPE("Collision::CollideBatch");
+
+		std::size_t NumOut = 0;
+
+		for (std::size_t i = 0; i < Count; ++i)
+		{
+			const Collider& A = Colliders[Pairs[i].A];
+			const Collider& B = Colliders[Pairs[i].B];
+			Manifold& Result = Out[NumOut];
+
+			if (!Collide(A, B, Result))
+			{
+				continue;
+			}
+
+			Result.BodyA = Pairs[i].A;
+			Result.BodyB = Pairs[i].B;
+			Cache.Update(A, B, Result, IsSinglePointPair(A, B));
+			++NumOut;
+		}
+		return NumOut;
+	}
+}
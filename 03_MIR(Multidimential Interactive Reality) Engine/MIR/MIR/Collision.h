@@ -0,0 +1,164 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "Math.h"
+#include "Memory.h"
+
+namespace Collision
+{
+	const std::size_t MAX_CONTACTS = 4;
+
+	enum class ShapeType : std::uint8_t
+	{
+		Sphere,
+		Box,
+		Hull
+	};
+
+	// Convex point cloud in local space. Coordinates are kept SoA and padded to a
+	// multiple of four (by repeating the last point) for the SIMD support search.
+	class ConvexHull
+	{
+	public:
+		ConvexHull() : mCount(0) {}
+		explicit ConvexHull(const Vector3* Points, std::size_t Count) { Set(Points, Count); }
+
+		void Set(const Vector3* Points, std::size_t Count);
+
+		Vector3 GetPoint(std::size_t Index) const { return Vector3(mX[Index], mY[Index], mZ[Index]); }
+		std::size_t GetCount() const { return mCount; }
+
+		Vector3 Support(const Vector3& Dir) const;
+
+	private:
+		std::vector<float> mX;
+		std::vector<float> mY;
+		std::vector<float> mZ;
+		std::size_t mCount;
+	};
+
+	struct Collider
+	{
+		ShapeType Type = ShapeType::Sphere;
+		Vector3 Position;
+		Quaternion Rotation;
+
+		float Radius = 0.f;
+		Vector3 HalfExtents;
+		const ConvexHull* Hull = nullptr;
+
+		static Collider MakeSphere(const Vector3& Position, float Radius);
+		static Collider MakeBox(const Vector3& Position, const Quaternion& Rotation, const Vector3& HalfExtents);
+		static Collider MakeHull(const Vector3& Position, const Quaternion& Rotation, const ConvexHull& Hull);
+	};
+
+	struct ContactPoint
+	{
+		Vector3 Position;
+		float Depth = 0.f;
+
+		// Anchors in each body's local frame, used to re-match points across frames.
+		Vector3 LocalA;
+		Vector3 LocalB;
+
+		float NormalImpulse = 0.f;
+		float TangentImpulse[2] = {0.f, 0.f};
+	};
+
+	// Normal points from A to B. Depth is positive when the shapes overlap.
+	struct Manifold
+	{
+		std::uint32_t BodyA = 0;
+		std::uint32_t BodyB = 0;
+		Vector3 Normal;
+		ContactPoint Points[MAX_CONTACTS];
+		std::uint32_t Count = 0;
+	};
+
+	struct GjkResult
+	{
+		bool Overlap = false;
+		float Distance = 0.f;
+		Vector3 PointA;
+		Vector3 PointB;
+	};
+
+	struct PenetrationResult
+	{
+		bool Valid = false;
+		Vector3 Normal;
+		float Depth = 0.f;
+		Vector3 PointA;
+		Vector3 PointB;
+	};
+
+	struct CollisionPair
+	{
+		std::uint32_t A;
+		std::uint32_t B;
+	};
+
+	// Closest points between the shapes' cores (spheres count as their centre point).
+	GjkResult Gjk(const Collider& A, const Collider& B);
+
+	// Penetration of the full shapes; only meaningful when they overlap.
+	PenetrationResult Epa(const Collider& A, const Collider& B);
+
+	// Separating-axis test for two oriented boxes. Returns false if separated,
+	// otherwise the axis of least penetration with up to four clipped contacts.
+	bool SatBoxBox(const Collider& A, const Collider& B, Manifold& Out);
+
+	// Picks the cheapest routine for the shape pair. Returns false if no contact.
+	bool Collide(const Collider& A, const Collider& B, Manifold& Out);
+
+	// Manifolds persisted across frames for warm starting. Pairs not touched for a
+	// frame are evicted in EndFrame(). Not thread-safe.
+	class ManifoldCache
+	{
+	public:
+		explicit ManifoldCache(std::size_t ExpectedPairs = 1024);
+
+		// Merges a fresh manifold with last frame's, carrying impulses over to
+		// matching points and keeping still-valid old points for single-point routines.
+		void Update(const Collider& A, const Collider& B, Manifold& Fresh, bool Accumulate);
+
+		// Writes solver impulses back so the next Update() can warm start from them.
+		void Store(const Manifold& Solved);
+
+		void EndFrame();
+
+		std::size_t GetSize() const { return mPairs.size(); }
+		std::size_t GetPooledNodes() const { return mNodePool.GetLiveBlocks(); }
+
+	private:
+		struct Entry
+		{
+			Manifold Data;
+			std::uint64_t Frame;
+		};
+
+		using Value = std::pair<const std::uint64_t, Entry>;
+		using Map = std::unordered_map<std::uint64_t, Entry, std::hash<std::uint64_t>, std::equal_to<std::uint64_t>, Memory::PoolAllocator<Value>>;
+
+		// A hash node is the value plus at most two words: next and cached hash
+		// (libstdc++, libc++) or next and prev (MSVC). Smaller requests, such as
+		// debug iterator proxies, share the pool; larger ones go to the heap.
+		static const std::size_t NODE_SIZE = sizeof(Value) + 2 * sizeof(void*);
+
+		Memory::FixedPool mNodePool;
+		Map mPairs;
+		std::uint64_t mFrame;
+	};
+
+	// Narrowphase over an array of candidate pairs. Touching manifolds are written
+	// to Out (sized for Count) after warm-start merging; returns how many were written.
+	std::size_t CollideBatch(const Collider* Colliders, const CollisionPair* Pairs, std::size_t Count,
+		ManifoldCache& Cache, Manifold* Out);
+}
@@ -38,7 +38,7 @@ Vector2 Vector2::Transform(const Vector2& Vec, const Matrix3& Mat, float W)
 	Vector2 Temp
 	(
 		Vec.X * Mat.Mat[0][0] + Vec.Y * Mat.Mat[1][0] + W * Mat.Mat[2][0],
-		Vec.Y * Mat.Mat[0][1] + Vec.Y * Mat.Mat[1][1] + W * Mat.Mat[2][1]
+		Vec.X * Mat.Mat[0][1] + Vec.Y * Mat.Mat[1][1] + W * Mat.Mat[2][1]
 	);
 	return Temp;
 }
@@ -48,8 +48,8 @@ Vector3 Vector3::Transform(const Vector3& Vec, const Matrix4& Mat, float W)
 	Vector3 Temp
 	(
 		Vec.X * Mat.Mat[0][0] + Vec.Y * Mat.Mat[1][0] + Vec.Z * Mat.Mat[2][0] + W * Mat.Mat[3][0],
-		Vec.Y * Mat.Mat[0][1] + Vec.Y * Mat.Mat[1][1] + Vec.Z * Mat.Mat[2][1] + W * Mat.Mat[3][1],
-		Vec.Z * Mat.Mat[0][2] + Vec.Y * Mat.Mat[1][2] + Vec.Z * Mat.Mat[2][2] + W * Mat.Mat[3][2]
+		Vec.X * Mat.Mat[0][1] + Vec.Y * Mat.Mat[1][1] + Vec.Z * Mat.Mat[2][1] + W * Mat.Mat[3][1],
+		Vec.X * Mat.Mat[0][2] + Vec.Y * Mat.Mat[1][2] + Vec.Z * Mat.Mat[2][2] + W * Mat.Mat[3][2]
 	);
 	return Temp;
 }
@@ -61,6 +61,20 @@ Vector3 Vector3::Transform(const Vector3& Vec, const Quaternion& Quater)
 	return Temp;
 }
 
+Matrix4 Matrix4::CreateFromQuaternion(const Quaternion& Quater)
+{
+	const float X = Quater.X, Y = Quater.Y, Z = Quater.Z, W = Quater.W;
+
+	float Temp[4][4] =
+	{
+		{1.f - 2.f * Y * Y - 2.f * Z * Z, 2.f * X * Y + 2.f * W * Z, 2.f * X * Z - 2.f * W * Y, 0.f},
+		{2.f * X * Y - 2.f * W * Z, 1.f - 2.f * X * X - 2.f * Z * Z, 2.f * Y * Z + 2.f * W * X, 0.f},
+		{2.f * X * Z + 2.f * W * Y, 2.f * Y * Z - 2.f * W * X, 1.f - 2.f * X * X - 2.f * Y * Y, 0.f},
+		{0.f, 0.f, 0.f, 1.f}
+	};
+	return Matrix4(Temp);
+}
+
 void Matrix4::Invert()
 {
 	const short Size = 4;
@@ -107,9 +121,9 @@ void Matrix4::Invert()
     }
 }
 
-float Calculas::NumericDifferentiate(float X, float H = 1.0e-8)
+float Calculas::NumericDifferentiate(float X, float H)
 {
-	return (Calculas::Function(X + H) - Calculas::Function(X)) / H;
+	return (Function(X + H) - Function(X)) / H;
 }
 
 float Calculas::NumericIntegrate(float Start, float End, int Interval)
@@ -120,7 +134,7 @@ float Calculas::NumericIntegrate(float Start, float End, int Interval)
 
     while (Interval--)
     {
-        Sum += (Calculas::Function(X) + Calculas::Function(X + H)) * H / 2;
+        Sum += (Function(X) + Function(X + H)) * H / 2;
         X += H;
     }
     return Sum;
@@ -3,8 +3,12 @@
 #pragma once
 
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <limits>
+#include <random>
+#include <thread>
+#include <type_traits>
 #include <stdlib.h>
 #include <time.h>
 
@@ -43,13 +47,27 @@ namespace Math
 	template <typename T>
 	T Clamp(const T& Val, const T& Lower, const T& Upper) { return Min(Upper, Max(Lower, Val)); }
 
+	// One engine per thread, seeded once. Integers are drawn from [Min, Max],
+	// floating-point values from [Min, Max).
+	inline std::mt19937& GetRandomEngine()
+	{
+		thread_local std::mt19937 Engine(static_cast<unsigned>(time(NULL)) ^ static_cast<unsigned>(std::hash<std::thread::id>()(std::this_thread::get_id())));
+		return Engine;
+	}
+
+	inline void SeedRandom(unsigned Seed) { GetRandomEngine().seed(Seed); }
+
 	template <typename T>
 	T Random(T Min, T Max)
 	{
-		srand(time(NULL));
-
-		T RandNum = (rand() % (Min - Max + 1)) + Min;
-		return RandNum;
+		if constexpr (std::is_integral<T>::value)
+		{
+			return std::uniform_int_distribution<T>(Min, Max)(GetRandomEngine());
+		}
+		else
+		{
+			return std::uniform_real_distribution<T>(Min, Max)(GetRandomEngine());
+		}
 	}
 }
 
@@ -77,6 +95,11 @@ public:
 		return Vector2(Left.X - Right.X, Left.Y - Right.Y);
 	}
 
+	friend Vector2 operator-(const Vector2& Vec)
+	{
+		return Vector2(-Vec.X, -Vec.Y);
+	}
+
 	friend Vector2 operator*(float Scalar, const Vector2& Vec)
 	{
 		return Vector2(Scalar * Vec.X, Scalar * Vec.Y);
@@ -168,6 +191,11 @@ public:
 		return Vector3(Left.X - Right.X, Left.Y - Right.Y, Left.Z - Right.Z);
 	}
 
+	friend Vector3 operator-(const Vector3& Vec)
+	{
+		return Vector3(-Vec.X, -Vec.Y, -Vec.Z);
+	}
+
 	friend Vector3 operator*(float Scalar, const Vector3& Vec)
 	{
 		return Vector3(Scalar * Vec.X, Scalar * Vec.Y, Scalar * Vec.Z);
@@ -316,6 +344,20 @@ public:
 		return Matrix3(Temp);
 	}
 
+	// Same as CreateScale(Scale) * CreateRotation(Rad) * CreateTranslation(Translation),
+	// without the two matrix products.
+	static Matrix3 CreateAffine(const Vector2& Scale, float Rad, const Vector2& Translation)
+	{
+		float Cos = Math::Cos(Rad), Sin = Math::Sin(Rad);
+		float Temp[3][3] =
+		{
+			{Scale.X * Cos, Scale.X * Sin, 0.f},
+			{-Scale.Y * Sin, Scale.Y * Cos, 0.f},
+			{Translation.X, Translation.Y, 1.f}
+		};
+		return Matrix3(Temp);
+	}
+
 	static const Matrix3 Identity;
 };
 
@@ -338,7 +380,8 @@ public:
 				Temp.Mat[i][j] = 
 					Left.Mat[i][0] * Right.Mat[0][j] +
 					Left.Mat[i][1] * Right.Mat[1][j] +
-					Left.Mat[i][2] * Right.Mat[2][j];
+					Left.Mat[i][2] * Right.Mat[2][j] +
+					Left.Mat[i][3] * Right.Mat[3][j];
 			}
 		}
 		return Temp;
@@ -354,16 +397,16 @@ public:
 
 	Vector3 GetTranslation() const { return Vector3(Mat[3][0], Mat[3][1], Mat[3][2]); }
 
-	Vector3 GetXAxis() const { return Vector3::Norm(Vector3(Mat[0][1], Mat[0][1], Mat[0][2])); }
-	Vector3 GetYAxis() const { return Vector3::Norm(Vector3(Mat[1][1], Mat[1][1], Mat[1][2])); }
-	Vector3 GetZAxis() const { return Vector3::Norm(Vector3(Mat[2][1], Mat[2][1], Mat[2][2])); }
+	Vector3 GetXAxis() const { return Vector3::Norm(Vector3(Mat[0][0], Mat[0][1], Mat[0][2])); }
+	Vector3 GetYAxis() const { return Vector3::Norm(Vector3(Mat[1][0], Mat[1][1], Mat[1][2])); }
+	Vector3 GetZAxis() const { return Vector3::Norm(Vector3(Mat[2][0], Mat[2][1], Mat[2][2])); }
 
 	Vector3 GetScale() const
 	{
 		Vector3 Temp;
-		Temp.X = Vector3(Mat[0][1], Mat[0][1], Mat[0][2]).Length();
-		Temp.Y = Vector3(Mat[1][1], Mat[1][1], Mat[1][2]).Length();
-		Temp.Z = Vector3(Mat[2][1], Mat[2][1], Mat[2][2]).Length();
+		Temp.X = Vector3(Mat[0][0], Mat[0][1], Mat[0][2]).Length();
+		Temp.Y = Vector3(Mat[1][0], Mat[1][1], Mat[1][2]).Length();
+		Temp.Z = Vector3(Mat[2][0], Mat[2][1], Mat[2][2]).Length();
 		return Temp;
 	}
 
@@ -605,7 +648,8 @@ public:
 class Calculas
 {
 public:
-	virtual float Function(float X);
+	virtual ~Calculas() {}
+	virtual float Function(float X) = 0;
 
 	float NumericDifferentiate(float X, float H = 1.0e-8);
 	float NumericIntegrate(float Start, float End, int Interval);
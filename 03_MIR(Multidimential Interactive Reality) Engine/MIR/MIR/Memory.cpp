@@ -0,0 +1,373 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#include "Memory.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace Memory
+{
+	void* HeapAlloc(std::size_t Size, std::size_t Align)
+	{
+		return ::operator new(Size, std::align_val_t(Align));
+	}
+
+	void HeapFree(void* Ptr, std::size_t Align)
+	{
+		::operator delete(Ptr, std::align_val_t(Align));
+	}
+
+	LinearArena::LinearArena()
+		: mBase(nullptr), mCapacity(0), mOffset(0), mOverflow(nullptr), mOverflowBytes(0) {}
+
+	LinearArena::LinearArena(std::size_t Capacity)
+		: LinearArena()
+	{
+		Reserve(Capacity);
+	}
+
+	LinearArena::~LinearArena()
+	{
+		FreeOverflow();
+
+		if (mBase != nullptr)
+		{
+			HeapFree(mBase, CACHE_LINE);
+		}
+	}
+
+	void* LinearArena::Alloc(std::size_t Size, std::size_t Align)
+	{
+		assert(IsPow2(Align));
+
+		std::uintptr_t Base = reinterpret_cast<std::uintptr_t>(mBase);
+		std::size_t Start = AlignUp(Base + mOffset, Align) - Base;
+
+		++mStats.Allocations;
+		mStats.Bytes += Size;
+
+		if (mBase == nullptr || Start + Size > mCapacity)
+		{
+			return AllocOverflow(Size, Align);
+		}
+
+		mOffset = Start + Size;
+
+		if (GetUsed() > mStats.PeakBytes)
+		{
+			mStats.PeakBytes = GetUsed();
+		}
+		return mBase + Start;
+	}
+
+	void LinearArena::Rewind(std::size_t Marker)
+	{
+		assert(Marker <= mOffset);
+		mOffset = Marker;
+	}
+
+	void LinearArena::Reserve(std::size_t Capacity)
+	{
+		assert(mOffset == 0 && mOverflow == nullptr);
+
+		if (Capacity <= mCapacity)
+		{
+			return;
+		}
+
+		if (mBase != nullptr)
+		{
+			HeapFree(mBase, CACHE_LINE);
+		}
+
+		mCapacity = AlignUp(Capacity, CACHE_LINE);
+		mBase = static_cast<unsigned char*>(HeapAlloc(mCapacity, CACHE_LINE));
+
+		mStats.Capacity = mCapacity;
+		++mStats.HeapBlocks;
+	}
+
+	void LinearArena::Reset()
+	{
+		std::size_t Needed = GetUsed();
+		bool Overflowed = mOverflow != nullptr;
+
+		FreeOverflow();
+		mOffset = 0;
+		++mStats.Resets;
+
+		if (Overflowed)
+		{
+			Reserve(Needed + Needed / 2);
+		}
+	}
+
+	void* LinearArena::AllocOverflow(std::size_t Size, std::size_t Align)
+	{
+		std::size_t BlockAlign = Align < DEFAULT_ALIGN ? DEFAULT_ALIGN : Align;
+		std::size_t Header = AlignUp(sizeof(Overflow), BlockAlign);
+
+		unsigned char* Block = static_cast<unsigned char*>(HeapAlloc(Header + Size, BlockAlign));
+		Overflow* Node = reinterpret_cast<Overflow*>(Block);
+		Node->Next = mOverflow;
+		Node->Align = BlockAlign;
+		mOverflow = Node;
+
+		mOverflowBytes += Size + Align;
+		++mStats.HeapBlocks;
+
+		if (GetUsed() > mStats.PeakBytes)
+		{
+			mStats.PeakBytes = GetUsed();
+		}
+		return Block + Header;
+	}
+
+	void LinearArena::FreeOverflow()
+	{
+		while (mOverflow != nullptr)
+		{
+			Overflow* Next = mOverflow->Next;
+			HeapFree(mOverflow, mOverflow->Align);
+			mOverflow = Next;
+		}
+		mOverflowBytes = 0;
+	}
+
+	FixedPool::FixedPool(std::size_t BlockSize, std::size_t BlocksPerChunk, std::size_t Align)
+		: mBlockSize(0), mBlocksPerChunk(BlocksPerChunk), mAlign(Align), mHeaderSize(0),
+		mFreeList(nullptr), mChunks(nullptr), mLive(0)
+	{
+		assert(IsPow2(Align) && BlocksPerChunk > 0);
+
+		if (mAlign < alignof(FreeNode))
+		{
+			mAlign = alignof(FreeNode);
+		}
+
+		mBlockSize = AlignUp(BlockSize < sizeof(FreeNode) ? sizeof(FreeNode) : BlockSize, mAlign);
+		mHeaderSize = AlignUp(sizeof(Chunk), mAlign);
+	}
+
+	FixedPool::~FixedPool()
+	{
+		assert(mLive == 0);
+
+		while (mChunks != nullptr)
+		{
+			Chunk* Next = mChunks->Next;
+			HeapFree(mChunks, mAlign);
+			mChunks = Next;
+		}
+	}
+
+	void* FixedPool::Alloc()
+	{
+		if (mFreeList == nullptr)
+		{
+			Grow();
+		}
+
+		FreeNode* Node = mFreeList;
+		mFreeList = Node->Next;
+
+		++mLive;
+		++mStats.Allocations;
+		mStats.Bytes += mBlockSize;
+
+		if (mLive * mBlockSize > mStats.PeakBytes)
+		{
+			mStats.PeakBytes = mLive * mBlockSize;
+		}
+		return Node;
+	}
+
+	void FixedPool::Free(void* Ptr)
+	{
+		if (Ptr == nullptr)
+		{
+			return;
+		}
+
+		assert(mLive > 0);
+
+		FreeNode* Node = static_cast<FreeNode*>(Ptr);
+		Node->Next = mFreeList;
+		mFreeList = Node;
+		--mLive;
+	}
+
+	void FixedPool::Reserve(std::size_t Blocks)
+	{
+		while (mStats.Capacity / mBlockSize < Blocks)
+		{
+			Grow();
+		}
+	}
+
+	void FixedPool::Grow()
+	{
+		unsigned char* Block = static_cast<unsigned char*>(HeapAlloc(mHeaderSize + mBlockSize * mBlocksPerChunk, mAlign));
+
+		Chunk* NewChunk = reinterpret_cast<Chunk*>(Block);
+		NewChunk->Next = mChunks;
+		mChunks = NewChunk;
+
+		// Thread the blocks back to front so Alloc() hands them out in address order.
+		unsigned char* First = Block + mHeaderSize;
+
+		for (std::size_t i = mBlocksPerChunk; i-- > 0;)
+		{
+			FreeNode* Node = reinterpret_cast<FreeNode*>(First + i * mBlockSize);
+			Node->Next = mFreeList;
+			mFreeList = Node;
+		}
+
+		mStats.Capacity += mBlockSize * mBlocksPerChunk;
+		++mStats.HeapBlocks;
+	}
+
+	namespace Frame
+	{
+		namespace
+		{
+			struct ThreadFrame
+			{
+				LinearArena Single;
+				LinearArena Double[2];
+
+				ThreadFrame* Prev = nullptr;
+				ThreadFrame* Next = nullptr;
+			};
+
+			std::mutex RegistryLock;
+			ThreadFrame* Threads = nullptr;
+			AllocStats RetiredStats;
+
+			std::atomic<std::uint64_t> FrameIndex(0);
+			std::size_t FrameCapacity = 1 << 20;
+			std::size_t DoubleCapacity = 256 << 10;
+
+			struct ThreadFrameHandle
+			{
+				ThreadFrame* Ptr = nullptr;
+
+				~ThreadFrameHandle()
+				{
+					if (Ptr == nullptr)
+					{
+						return;
+					}
+
+					std::lock_guard<std::mutex> Lock(RegistryLock);
+
+					if (Ptr->Prev != nullptr)
+					{
+						Ptr->Prev->Next = Ptr->Next;
+					}
+					else
+					{
+						Threads = Ptr->Next;
+					}
+
+					if (Ptr->Next != nullptr)
+					{
+						Ptr->Next->Prev = Ptr->Prev;
+					}
+
+					RetiredStats += Ptr->Single.GetStats();
+					RetiredStats += Ptr->Double[0].GetStats();
+					RetiredStats += Ptr->Double[1].GetStats();
+
+					delete Ptr;
+				}
+			};
+
+			thread_local ThreadFrameHandle Local;
+
+			ThreadFrame& GetThreadFrame()
+			{
+				if (Local.Ptr != nullptr)
+				{
+					return *Local.Ptr;
+				}
+
+				ThreadFrame* Temp = new ThreadFrame;
+
+				std::lock_guard<std::mutex> Lock(RegistryLock);
+
+				Temp->Single.Reserve(FrameCapacity);
+				Temp->Double[0].Reserve(DoubleCapacity);
+				Temp->Double[1].Reserve(DoubleCapacity);
+
+				Temp->Next = Threads;
+
+				if (Threads != nullptr)
+				{
+					Threads->Prev = Temp;
+				}
+
+				Threads = Temp;
+				Local.Ptr = Temp;
+				return *Temp;
+			}
+		}
+
+		void SetDefaultCapacity(std::size_t FrameBytes, std::size_t DoubleBufferBytes)
+		{
+			std::lock_guard<std::mutex> Lock(RegistryLock);
+			FrameCapacity = FrameBytes;
+			DoubleCapacity = DoubleBufferBytes;
+		}
+
+		LinearArena& GetArena()
+		{
+			return GetThreadFrame().Single;
+		}
+
+		LinearArena& GetCurrentBuffer()
+		{
+			return GetThreadFrame().Double[FrameIndex.load(std::memory_order_relaxed) & 1];
+		}
+
+		LinearArena& GetPreviousBuffer()
+		{
+			return GetThreadFrame().Double[(FrameIndex.load(std::memory_order_relaxed) + 1) & 1];
+		}
+
+		void EndFrame()
+		{
+			std::lock_guard<std::mutex> Lock(RegistryLock);
+
+			std::uint64_t Next = FrameIndex.load(std::memory_order_relaxed) + 1;
+
+			for (ThreadFrame* Iter = Threads; Iter != nullptr; Iter = Iter->Next)
+			{
+				Iter->Single.Reset();
+				Iter->Double[Next & 1].Reset();
+			}
+
+			FrameIndex.store(Next, std::memory_order_release);
+		}
+
+		std::uint64_t GetFrameIndex()
+		{
+			return FrameIndex.load(std::memory_order_acquire);
+		}
+
+		AllocStats GetStats()
+		{
+			std::lock_guard<std::mutex> Lock(RegistryLock);
+
+			AllocStats Temp = RetiredStats;
+
+			for (ThreadFrame* Iter = Threads; Iter != nullptr; Iter = Iter->Next)
+			{
+				Temp += Iter->Single.GetStats();
+				Temp += Iter->Double[0].GetStats();
+				Temp += Iter->Double[1].GetStats();
+			}
+			return Temp;
+		}
+	}
+}
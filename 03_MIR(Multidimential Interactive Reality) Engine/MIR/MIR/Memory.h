@@ -0,0 +1,296 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace Memory
+{
+	const std::size_t DEFAULT_ALIGN = alignof(std::max_align_t);
+	const std::size_t CACHE_LINE = 64;
+
+	inline std::size_t AlignUp(std::size_t Val, std::size_t Align) { return (Val + Align - 1) & ~(Align - 1); }
+	inline bool IsPow2(std::size_t Val) { return Val != 0 && (Val & (Val - 1)) == 0; }
+
+	void* HeapAlloc(std::size_t Size, std::size_t Align = DEFAULT_ALIGN);
+	void HeapFree(void* Ptr, std::size_t Align = DEFAULT_ALIGN);
+
+	struct AllocStats
+	{
+		std::size_t Allocations = 0;
+		std::size_t Bytes = 0;
+		std::size_t PeakBytes = 0;
+		std::size_t Capacity = 0;
+		std::size_t Resets = 0;
+		std::size_t HeapBlocks = 0;
+
+		AllocStats& operator+=(const AllocStats& Right)
+		{
+			Allocations += Right.Allocations;
+			Bytes += Right.Bytes;
+			PeakBytes += Right.PeakBytes;
+			Capacity += Right.Capacity;
+			Resets += Right.Resets;
+			HeapBlocks += Right.HeapBlocks;
+			return *this;
+		}
+	};
+
+	// Bump allocator over one contiguous block. When the block runs out it chains
+	// overflow blocks from the heap, and the next Reset() regrows the main block to
+	// the high-water mark, so a steady-state frame never touches the heap.
+	class LinearArena
+	{
+	public:
+		LinearArena();
+		explicit LinearArena(std::size_t Capacity);
+		~LinearArena();
+
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+
+		void* Alloc(std::size_t Size, std::size_t Align = DEFAULT_ALIGN);
+
+		template <typename T, typename... Args>
+		T* New(Args&&... Params)
+		{
+			return new (Alloc(sizeof(T), alignof(T))) T(std::forward<Args>(Params)...);
+		}
+
+		template <typename T>
+		T* NewArray(std::size_t Count)
+		{
+			T* Temp = static_cast<T*>(Alloc(sizeof(T) * Count, alignof(T)));
+
+			for (std::size_t i = 0; i < Count; ++i)
+			{
+				new (Temp + i) T();
+			}
+			return Temp;
+		}
+
+		std::size_t GetMarker() const { return mOffset; }
+		void Rewind(std::size_t Marker);
+
+		void Reserve(std::size_t Capacity);
+		void Reset();
+
+		std::size_t GetUsed() const { return mOffset + mOverflowBytes; }
+		std::size_t GetCapacity() const { return mCapacity; }
+		const AllocStats& GetStats() const { return mStats; }
+
+	private:
+		struct Overflow
+		{
+			Overflow* Next;
+			std::size_t Align;
+		};
+
+		void* AllocOverflow(std::size_t Size, std::size_t Align);
+		void FreeOverflow();
+
+		unsigned char* mBase;
+		std::size_t mCapacity;
+		std::size_t mOffset;
+
+		Overflow* mOverflow;
+		std::size_t mOverflowBytes;
+
+		AllocStats mStats;
+	};
+
+	// Fixed-size block allocator. Blocks come from chunks of BlocksPerChunk and are
+	// recycled through an intrusive free list; chunks are only returned on destruction.
+	class FixedPool
+	{
+	public:
+		FixedPool(std::size_t BlockSize, std::size_t BlocksPerChunk, std::size_t Align = DEFAULT_ALIGN);
+		~FixedPool();
+
+		FixedPool(const FixedPool&) = delete;
+		FixedPool& operator=(const FixedPool&) = delete;
+
+		void* Alloc();
+		void Free(void* Ptr);
+
+		void Reserve(std::size_t Blocks);
+
+		// Whether an object of Size and Align can live in one block.
+		bool Fits(std::size_t Size, std::size_t Align) const { return Size <= mBlockSize && Align <= mAlign; }
+
+		std::size_t GetBlockSize() const { return mBlockSize; }
+		std::size_t GetLiveBlocks() const { return mLive; }
+		const AllocStats& GetStats() const { return mStats; }
+
+	private:
+		struct FreeNode { FreeNode* Next; };
+		struct Chunk { Chunk* Next; };
+
+		void Grow();
+
+		std::size_t mBlockSize;
+		std::size_t mBlocksPerChunk;
+		std::size_t mAlign;
+		std::size_t mHeaderSize;
+
+		FreeNode* mFreeList;
+		Chunk* mChunks;
+		std::size_t mLive;
+
+		AllocStats mStats;
+	};
+
+	template <typename T>
+	class ObjectPool
+	{
+	public:
+		explicit ObjectPool(std::size_t BlocksPerChunk = 256)
+			: mPool(sizeof(T) < sizeof(void*) ? sizeof(void*) : sizeof(T), BlocksPerChunk, alignof(T) < alignof(void*) ? alignof(void*) : alignof(T)) {}
+
+		template <typename... Args>
+		T* New(Args&&... Params)
+		{
+			return new (mPool.Alloc()) T(std::forward<Args>(Params)...);
+		}
+
+		void Delete(T* Ptr)
+		{
+			if (Ptr == nullptr)
+			{
+				return;
+			}
+			Ptr->~T();
+			mPool.Free(Ptr);
+		}
+
+		void Reserve(std::size_t Count) { mPool.Reserve(Count); }
+
+		std::size_t GetLiveCount() const { return mPool.GetLiveBlocks(); }
+		const AllocStats& GetStats() const { return mPool.GetStats(); }
+
+	private:
+		FixedPool mPool;
+	};
+
+	// Per-thread frame memory. Each thread that allocates gets its own arenas on
+	// first use, so allocation never takes a lock.
+	//  - Frame data lives until the next EndFrame().
+	//  - Double-buffered data survives one extra frame, so frame N can read what
+	//    frame N-1 produced (contact caches, previous visible sets, ...).
+	// EndFrame() must be called while no other thread is allocating.
+	namespace Frame
+	{
+		void SetDefaultCapacity(std::size_t FrameBytes, std::size_t DoubleBufferBytes);
+
+		LinearArena& GetArena();
+		LinearArena& GetCurrentBuffer();
+		LinearArena& GetPreviousBuffer();
+
+		inline void* Alloc(std::size_t Size, std::size_t Align = DEFAULT_ALIGN) { return GetArena().Alloc(Size, Align); }
+		inline void* AllocDoubleBuffered(std::size_t Size, std::size_t Align = DEFAULT_ALIGN) { return GetCurrentBuffer().Alloc(Size, Align); }
+
+		void EndFrame();
+
+		std::uint64_t GetFrameIndex();
+		AllocStats GetStats();
+	}
+
+	// STL adapter over a specific arena. deallocate() is a no-op; the memory comes
+	// back when the arena is reset.
+	template <typename T>
+	class ArenaAllocator
+	{
+	public:
+		using value_type = T;
+
+		explicit ArenaAllocator(LinearArena& Arena) : mArena(&Arena) {}
+
+		template <typename U>
+		ArenaAllocator(const ArenaAllocator<U>& Other) : mArena(Other.GetArena()) {}
+
+		T* allocate(std::size_t Count) { return static_cast<T*>(mArena->Alloc(sizeof(T) * Count, alignof(T))); }
+		void deallocate(T*, std::size_t) {}
+
+		LinearArena* GetArena() const { return mArena; }
+
+		template <typename U>
+		bool operator==(const ArenaAllocator<U>& Right) const { return mArena == Right.GetArena(); }
+
+		template <typename U>
+		bool operator!=(const ArenaAllocator<U>& Right) const { return mArena != Right.GetArena(); }
+
+	private:
+		LinearArena* mArena;
+	};
+
+	// STL adapter over the calling thread's frame arena. Containers using it must
+	// not outlive the frame.
+	template <typename T>
+	class FrameAllocator
+	{
+	public:
+		using value_type = T;
+
+		FrameAllocator() = default;
+
+		template <typename U>
+		FrameAllocator(const FrameAllocator<U>&) {}
+
+		T* allocate(std::size_t Count) { return static_cast<T*>(Frame::Alloc(sizeof(T) * Count, alignof(T))); }
+		void deallocate(T*, std::size_t) {}
+
+		template <typename U>
+		bool operator==(const FrameAllocator<U>&) const { return true; }
+
+		template <typename U>
+		bool operator!=(const FrameAllocator<U>&) const { return false; }
+	};
+
+	// STL adapter for node containers (list, map, set). Single-object requests go
+	// to the pool; anything larger falls back to the heap.
+	template <typename T>
+	class PoolAllocator
+	{
+	public:
+		using value_type = T;
+
+		explicit PoolAllocator(FixedPool& Pool) : mPool(&Pool) {}
+
+		template <typename U>
+		PoolAllocator(const PoolAllocator<U>& Other) : mPool(Other.GetPool()) {}
+
+		T* allocate(std::size_t Count)
+		{
+			if (Count == 1 && mPool->Fits(sizeof(T), alignof(T)))
+			{
+				return static_cast<T*>(mPool->Alloc());
+			}
+			return static_cast<T*>(HeapAlloc(sizeof(T) * Count, alignof(T)));
+		}
+
+		void deallocate(T* Ptr, std::size_t Count)
+		{
+			if (Count == 1 && mPool->Fits(sizeof(T), alignof(T)))
+			{
+				mPool->Free(Ptr);
+				return;
+			}
+			HeapFree(Ptr, alignof(T));
+		}
+
+		FixedPool* GetPool() const { return mPool; }
+
+		template <typename U>
+		bool operator==(const PoolAllocator<U>& Right) const { return mPool == Right.GetPool(); }
+
+		template <typename U>
+		bool operator!=(const PoolAllocator<U>& Right) const { return mPool != Right.GetPool(); }
+
+	private:
+		FixedPool* mPool;
+	};
+}
@@ -0,0 +1,124 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#include "Parallel.h"
+
+#include <cassert>
+
+namespace Parallel
+{
+	namespace
+	{
+		// Pool whose task the current thread is running, to catch nested dispatch.
+		thread_local const ThreadPool* tRunning = nullptr;
+	}
+
+	ThreadPool::ThreadPool(unsigned Threads)
+		: mTask(nullptr), mCtx(nullptr), mGeneration(0), mPending(0), mQuit(false)
+	{
+		if (Threads == 0)
+		{
+			Threads = std::thread::hardware_concurrency();
+		}
+
+		if (Threads == 0)
+		{
+			Threads = 1;
+		}
+
+		mWorkers.reserve(Threads - 1);
+
+		for (unsigned i = 1; i < Threads; ++i)
+		{
+			mWorkers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> Lock(mLock);
+			mQuit = true;
+		}
+		mWake.notify_all();
+
+		for (std::thread& Worker : mWorkers)
+		{
+			Worker.join();
+		}
+	}
+
+	void ThreadPool::Dispatch(TaskFn Task, void* Ctx)
+	{
+		assert(tRunning != this && "task dispatched on the pool running it");
+
+		std::lock_guard<std::mutex> Serial(mDispatchLock);
+		unsigned Workers = GetThreadCount();
+
+		if (Workers > 1)
+		{
+			std::lock_guard<std::mutex> Lock(mLock);
+			mTask = Task;
+			mCtx = Ctx;
+			mPending = Workers - 1;
+			++mGeneration;
+		}
+		mWake.notify_all();
+
+		const ThreadPool* Outer = tRunning;
+		tRunning = this;
+		Task(Ctx, 0, Workers);
+		tRunning = Outer;
+
+		if (Workers > 1)
+		{
+			std::unique_lock<std::mutex> Lock(mLock);
+			mDone.wait(Lock, [this]() { return mPending == 0; });
+		}
+	}
+
+	void ThreadPool::WorkerLoop(unsigned Worker)
+	{
+		std::uint64_t Seen = 0;
+
+		while (true)
+		{
+			TaskFn Task;
+			void* Ctx;
+
+			{
+				std::unique_lock<std::mutex> Lock(mLock);
+				mWake.wait(Lock, [&]() { return mQuit || mGeneration != Seen; });
+
+				if (mQuit)
+				{
+					return;
+				}
+
+				Seen = mGeneration;
+				Task = mTask;
+				Ctx = mCtx;
+			}
+
+			tRunning = this;
+			Task(Ctx, Worker, GetThreadCount());
+			tRunning = nullptr;
+
+			bool Last;
+			{
+				std::lock_guard<std::mutex> Lock(mLock);
+				Last = --mPending == 0;
+			}
+
+			if (Last)
+			{
+				mDone.notify_one();
+			}
+		}
+	}
+
+	ThreadPool& ThreadPool::GetDefault()
+	{
+		static ThreadPool Pool;
+		return Pool;
+	}
+}
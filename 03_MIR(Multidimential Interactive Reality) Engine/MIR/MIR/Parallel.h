@@ -0,0 +1,107 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Parallel
+{
+	// Fixed set of worker threads that all run the same task, with the calling
+	// thread taking part as worker 0. Tasks are passed as a function pointer plus
+	// context, so dispatching never allocates.
+	//
+	// Any thread may dispatch, but one task runs at a time: concurrent callers
+	// of a shared pool (such as GetDefault()) wait for each other. A task must
+	// not dispatch on the pool running it; that would wait on itself, and debug
+	// builds assert instead.
+	class ThreadPool
+	{
+	public:
+		explicit ThreadPool(unsigned Threads = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		unsigned GetThreadCount() const { return static_cast<unsigned>(mWorkers.size()) + 1; }
+
+		// Runs Task(Worker, WorkerCount) once on every thread and waits for all of them.
+		template <typename Fn>
+		void Run(Fn&& Task)
+		{
+			Dispatch(&Invoke<Fn>, &Task);
+		}
+
+		// Splits [0, Count) into one contiguous range per thread. Range k always goes
+		// to worker k, so per-worker scratch indexed by Worker stays deterministic.
+		template <typename Fn>
+		void For(std::size_t Count, Fn&& Body)
+		{
+			Run([&](unsigned Worker, unsigned Workers)
+			{
+				std::size_t Begin = Count * Worker / Workers;
+				std::size_t End = Count * (Worker + 1) / Workers;
+
+				if (Begin < End)
+				{
+					Body(Begin, End, Worker);
+				}
+			});
+		}
+
+		// Hands out Grain-sized chunks from a shared counter, for uneven work.
+		template <typename Fn>
+		void ForDynamic(std::size_t Count, std::size_t Grain, Fn&& Body)
+		{
+			std::atomic<std::size_t> Next(0);
+
+			Run([&](unsigned Worker, unsigned)
+			{
+				while (true)
+				{
+					std::size_t Begin = Next.fetch_add(Grain, std::memory_order_relaxed);
+
+					if (Begin >= Count)
+					{
+						return;
+					}
+					Body(Begin, Begin + Grain < Count ? Begin + Grain : Count, Worker);
+				}
+			});
+		}
+
+		static ThreadPool& GetDefault();
+
+	private:
+		using TaskFn = void (*)(void*, unsigned, unsigned);
+
+		template <typename Fn>
+		static void Invoke(void* Ctx, unsigned Worker, unsigned Workers)
+		{
+			(*static_cast<typename std::remove_reference<Fn>::type*>(Ctx))(Worker, Workers);
+		}
+
+		void Dispatch(TaskFn Task, void* Ctx);
+		void WorkerLoop(unsigned Worker);
+
+		std::vector<std::thread> mWorkers;
+
+		std::mutex mDispatchLock;
+		std::mutex mLock;
+		std::condition_variable mWake;
+		std::condition_variable mDone;
+
+		TaskFn mTask;
+		void* mCtx;
+		std::uint64_t mGeneration;
+		unsigned mPending;
+		bool mQuit;
+	};
+}
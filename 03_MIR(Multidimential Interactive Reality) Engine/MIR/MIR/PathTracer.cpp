@@ -0,0 +1,318 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#include "PathTracer.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace RayTrace
+{
+	namespace
+	{
+		const float RAY_OFFSET = 1.0e-4f;
+
+		inline std::uint32_t Hash(std::uint32_t Val)
+		{
+			Val = Val * 747796405u + 2891336453u;
+			Val = ((Val >> ((Val >> 28) + 4)) ^ Val) * 277803737u;
+			return (Val >> 22) ^ Val;
+		}
+
+		inline float NextFloat(std::uint32_t& Seed)
+		{
+			Seed = Hash(Seed);
+			return static_cast<float>(Seed >> 8) * (1.f / 16777216.f);
+		}
+
+		inline Vector3 Modulate(const Vector3& Left, const Vector3& Right)
+		{
+			return Vector3(Left.X * Right.X, Left.Y * Right.Y, Left.Z * Right.Z);
+		}
+
+		// Cosine-weighted direction around N.
+		Vector3 SampleHemisphere(const Vector3& N, std::uint32_t& Seed)
+		{
+			float Phi = 2.f * Math::PI * NextFloat(Seed);
+			float R2 = NextFloat(Seed);
+			float R = Math::Sqrt(R2);
+
+			Vector3 Tangent = Math::Abs(N.X) > 0.9f ? Vector3::UnitY : Vector3::UnitX;
+			Tangent = Vector3::Norm(Vector3::Cross(Tangent, N));
+			Vector3 Bitangent = Vector3::Cross(N, Tangent);
+
+			return Vector3::Norm(R * Math::Cos(Phi) * Tangent + R * Math::Sin(Phi) * Bitangent + Math::Sqrt(1.f - R2) * N);
+		}
+	}
+
+	std::uint32_t Scene::AddMaterial(const Material& Mat)
+	{
+		mMaterials.push_back(Mat);
+		return static_cast<std::uint32_t>(mMaterials.size() - 1);
+	}
+
+	void Scene::AddMesh(const Vector3* Positions, std::size_t VertexCount,
+		const std::uint32_t* Indices, std::size_t TriangleCount, std::uint32_t MaterialId)
+	{
+		std::uint32_t Base = static_cast<std::uint32_t>(mPositions.size());
+
+		mPositions.insert(mPositions.end(), Positions, Positions + VertexCount);
+
+		for (std::size_t i = 0; i < 3 * TriangleCount; ++i)
+		{
+			mIndices.push_back(Base + Indices[i]);
+		}
+
+		mTriangleMaterial.insert(mTriangleMaterial.end(), TriangleCount, MaterialId);
+	}
+
+	void Scene::Build()
+	{
+		std::size_t Count = GetTriangleCount();
+
+		mNormals.resize(Count);
+		mLights.clear();
+		mLightCdf.clear();
+		mLightArea = 0.f;
+
+		for (std::size_t i = 0; i < Count; ++i)
+		{
+			const Vector3& V0 = mPositions[mIndices[3 * i]];
+			Vector3 Normal = Vector3::Cross(mPositions[mIndices[3 * i + 1]] - V0, mPositions[mIndices[3 * i + 2]] - V0);
+			float Area = 0.5f * Normal.Length();
+
+			mNormals[i] = Area > 0.f ? Vector3::Norm(Normal) : Vector3::UnitY;
+
+			if (mMaterials[mTriangleMaterial[i]].Emission.Square() > 0.f && Area > 0.f)
+			{
+				mLightArea += Area;
+				mLights.push_back(static_cast<std::uint32_t>(i));
+				mLightCdf.push_back(mLightArea);
+			}
+		}
+
+		mBvh.Build(mPositions.data(), mIndices.data(), Count);
+	}
+
+	Vector3 Scene::SampleLight(float U0, float U1, float U2, std::uint32_t& Triangle) const
+	{
+		float Pick = U0 * mLightArea;
+		std::size_t Index = std::upper_bound(mLightCdf.begin(), mLightCdf.end(), Pick) - mLightCdf.begin();
+		Triangle = mLights[Math::Min(Index, mLights.size() - 1)];
+
+		if (U1 + U2 > 1.f)
+		{
+			U1 = 1.f - U1, U2 = 1.f - U2;
+		}
+
+		const Vector3& V0 = mPositions[mIndices[3 * Triangle]];
+		const Vector3& V1 = mPositions[mIndices[3 * Triangle + 1]];
+		const Vector3& V2 = mPositions[mIndices[3 * Triangle + 2]];
+		return V0 + U1 * (V1 - V0) + U2 * (V2 - V0);
+	}
+
+	Framebuffer::Framebuffer(std::uint32_t Width, std::uint32_t Height)
+		: mWidth(Width), mHeight(Height), mSamples(0), mSum(static_cast<std::size_t>(Width) * Height)
+	{
+	}
+
+	void Framebuffer::Clear()
+	{
+		std::fill(mSum.begin(), mSum.end(), Vector3::Zero);
+		mSamples = 0;
+	}
+
+	Vector3 Framebuffer::GetPixel(std::uint32_t X, std::uint32_t Y) const
+	{
+		if (mSamples == 0)
+		{
+			return Vector3::Zero;
+		}
+		return (1.f / mSamples) * mSum[static_cast<std::size_t>(Y) * mWidth + X];
+	}
+
+	bool Framebuffer::WritePpm(const char* Path) const
+	{
+		std::FILE* File = std::fopen(Path, "wb");
+
+		if (File == nullptr)
+		{
+			return false;
+		}
+
+		std::fprintf(File, "P6\n%u %u\n255\n", mWidth, mHeight);
+
+		std::vector<unsigned char> Row(3 * static_cast<std::size_t>(mWidth));
+
+		for (std::uint32_t Y = 0; Y < mHeight; ++Y)
+		{
+			for (std::uint32_t X = 0; X < mWidth; ++X)
+			{
+				Vector3 Pixel = GetPixel(X, Y);
+				float Channels[3] = { Pixel.X, Pixel.Y, Pixel.Z };
+
+				for (int c = 0; c < 3; ++c)
+				{
+					float Mapped = std::pow(Channels[c] / (1.f + Channels[c]), 1.f / 2.2f);
+					Row[3 * X + c] = static_cast<unsigned char>(Math::Clamp(Mapped, 0.f, 1.f) * 255.f + 0.5f);
+				}
+			}
+			std::fwrite(Row.data(), 1, Row.size(), File);
+		}
+		return std::fclose(File) == 0;
+	}
+
+	PathTracer::PathTracer(const Scene& Source, const Camera& View, Framebuffer& Target)
+		: mScene(Source), mTarget(Target), mEye(View.Eye), mMaxDepth(6), mRays(0)
+	{
+		Vector3 Forward = Vector3::Norm(View.Target - View.Eye);
+		Vector3 Right = Vector3::Norm(Vector3::Cross(Forward, View.Up));
+		Vector3 Up = Vector3::Cross(Right, Forward);
+
+		float HalfHeight = Math::Tan(0.5f * View.FovY);
+		float HalfWidth = HalfHeight * Target.GetWidth() / Target.GetHeight();
+
+		mCorner = Forward - HalfWidth * Right + HalfHeight * Up;
+		mRight = (2.f * HalfWidth / Target.GetWidth()) * Right;
+		mDown = (-2.f * HalfHeight / Target.GetHeight()) * Up;
+	}
+
+	Ray PathTracer::GetCameraRay(float X, float Y) const
+	{
+		Ray Temp;
+		Temp.Origin = mEye;
+		Temp.Dir = Vector3::Norm(mCorner + X * mRight + Y * mDown);
+		return Temp;
+	}
+
+	Vector3 PathTracer::TracePath(Ray R, std::uint32_t& Seed, std::uint64_t& Rays) const
+	{
+		const Bvh& Tree = mScene.GetBvh();
+
+		Vector3 Radiance, Throughput(1.f, 1.f, 1.f);
+		bool CountEmission = true;
+
+		for (std::uint32_t Depth = 0; Depth < mMaxDepth; ++Depth)
+		{
+			Hit Closest;
+			++Rays;
+
+			if (!Tree.Intersect(R, Closest))
+			{
+				Radiance += Modulate(Throughput, mScene.GetSky());
+				break;
+			}
+
+			const Material& Mat = mScene.GetMaterial(Closest.Triangle);
+			Vector3 Normal = mScene.GetNormal(Closest.Triangle);
+
+			if (Vector3::Dot(Normal, R.Dir) > 0.f)
+			{
+				Normal = -Normal;
+			}
+
+			if (CountEmission)
+			{
+				Radiance += Modulate(Throughput, Mat.Emission);
+			}
+
+			Vector3 Position = R.Origin + Closest.T * R.Dir;
+			R.Origin = Position + RAY_OFFSET * Normal;
+
+			if (Mat.Specular > 0.f && NextFloat(Seed) < Mat.Specular)
+			{
+				R.Dir = Vector3::Reflect(R.Dir, Normal);
+				Throughput = Modulate(Throughput, Mat.Albedo);
+				CountEmission = true;
+			}
+			else
+			{
+				// Next-event estimation toward one emissive triangle picked by area.
+				if (mScene.HasLights())
+				{
+					std::uint32_t Light;
+					Vector3 Point = mScene.SampleLight(NextFloat(Seed), NextFloat(Seed), NextFloat(Seed), Light);
+					Vector3 ToLight = Point - R.Origin;
+					float DistSq = ToLight.Square();
+					float Dist = Math::Sqrt(DistSq);
+					ToLight *= 1.f / Dist;
+
+					float CosSurface = Vector3::Dot(Normal, ToLight);
+					float CosLight = Math::Abs(Vector3::Dot(mScene.GetNormal(Light), ToLight));
+
+					if (CosSurface > 0.f && CosLight > 0.f)
+					{
+						Ray Shadow = { R.Origin, ToLight };
+						++Rays;
+
+						if (!Tree.Occluded(Shadow, Dist * (1.f - RAY_OFFSET)))
+						{
+							float Weight = CosSurface * CosLight * mScene.GetLightArea() / (Math::PI * DistSq);
+							Radiance += Weight * Modulate(Modulate(Throughput, Mat.Albedo), mScene.GetMaterial(Light).Emission);
+						}
+					}
+				}
+
+				R.Dir = SampleHemisphere(Normal, Seed);
+				Throughput = Modulate(Throughput, Mat.Albedo);
+				CountEmission = !mScene.HasLights();
+			}
+
+			if (Depth >= 3)
+			{
+				float Survive = Math::Min(0.95f, Math::Max(Throughput.X, Math::Max(Throughput.Y, Throughput.Z)));
+
+				if (NextFloat(Seed) >= Survive)
+				{
+					break;
+				}
+				Throughput *= 1.f / Survive;
+			}
+		}
+		return Radiance;
+	}
+
+	void PathTracer::RenderPass(Parallel::ThreadPool& Pool)
+	{
+		MIR_PROFILE_SCOPE("PathTracer::RenderPass");
+
+		const std::uint32_t Width = mTarget.GetWidth(), Height = mTarget.GetHeight();
+		const std::uint32_t TilesX = (Width + TILE_SIZE - 1) / TILE_SIZE;
+		const std::uint32_t TilesY = (Height + TILE_SIZE - 1) / TILE_SIZE;
+		const std::uint32_t Pass = mTarget.mSamples;
+
+		std::vector<std::uint64_t> Rays(Pool.GetThreadCount(), 0);
+
+		Pool.ForDynamic(static_cast<std::size_t>(TilesX) * TilesY, 1, [&](std::size_t Begin, std::size_t End, unsigned Worker)
+		{
+			MIR_PROFILE_SCOPE("PathTracer::Tile");
+
+			std::uint64_t Local = 0;
+
+			for (std::size_t Tile = Begin; Tile < End; ++Tile)
+			{
+				std::uint32_t X0 = static_cast<std::uint32_t>(Tile % TilesX) * TILE_SIZE;
+				std::uint32_t Y0 = static_cast<std::uint32_t>(Tile / TilesX) * TILE_SIZE;
+
+				for (std::uint32_t Y = Y0; Y < Math::Min(Y0 + TILE_SIZE, Height); ++Y)
+				{
+					for (std::uint32_t X = X0; X < Math::Min(X0 + TILE_SIZE, Width); ++X)
+					{
+						std::uint32_t Seed = Hash(Hash(Hash(X) ^ Y) ^ Pass);
+						Ray Primary = GetCameraRay(X + NextFloat(Seed), Y + NextFloat(Seed));
+
+						mTarget.mSum[static_cast<std::size_t>(Y) * Width + X] += TracePath(Primary, Seed, Local);
+					}
+				}
+			}
+			Rays[Worker] += Local;
+		});
+
+		for (std::uint64_t Iter : Rays)
+		{
+			mRays += Iter;
+		}
+		++mTarget.mSamples;
+	}
+}
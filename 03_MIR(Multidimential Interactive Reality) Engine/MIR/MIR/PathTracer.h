@@ -0,0 +1,131 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Bvh.h"
+#include "Math.h"
+#include "Parallel.h"
+
+namespace RayTrace
+{
+	// Lambertian surface that turns into a mirror with probability Specular.
+	struct Material
+	{
+		Vector3 Albedo = Color::White;
+		Vector3 Emission = Color::Black;
+		float Specular = 0.f;
+	};
+
+	// Triangle soup with one material per triangle. Meshes are appended into a
+	// single vertex/index list and share one BVH built by Build().
+	class Scene
+	{
+	public:
+		std::uint32_t AddMaterial(const Material& Mat);
+
+		void AddMesh(const Vector3* Positions, std::size_t VertexCount,
+			const std::uint32_t* Indices, std::size_t TriangleCount, std::uint32_t MaterialId);
+
+		void Build();
+
+		void SetSky(const Vector3& Radiance) { mSky = Radiance; }
+		const Vector3& GetSky() const { return mSky; }
+
+		const Bvh& GetBvh() const { return mBvh; }
+		std::size_t GetTriangleCount() const { return mIndices.size() / 3; }
+
+		const Material& GetMaterial(std::uint32_t Triangle) const { return mMaterials[mTriangleMaterial[Triangle]]; }
+		const Vector3& GetNormal(std::uint32_t Triangle) const { return mNormals[Triangle]; }
+
+		// Uniform point on the emissive surfaces (pdf 1 / GetLightArea()).
+		Vector3 SampleLight(float U0, float U1, float U2, std::uint32_t& Triangle) const;
+		bool HasLights() const { return !mLights.empty(); }
+		float GetLightArea() const { return mLightArea; }
+
+	private:
+		std::vector<Vector3> mPositions;
+		std::vector<std::uint32_t> mIndices;
+		std::vector<std::uint32_t> mTriangleMaterial;
+		std::vector<Vector3> mNormals;
+		std::vector<Material> mMaterials;
+
+		std::vector<std::uint32_t> mLights;
+		std::vector<float> mLightCdf;
+		float mLightArea = 0.f;
+
+		Vector3 mSky = Color::Black;
+		Bvh mBvh;
+	};
+
+	struct Camera
+	{
+		Vector3 Eye;
+		Vector3 Target = Vector3::UnitZ;
+		Vector3 Up = Vector3::UnitY;
+		float FovY = Math::ToRad(45.f);
+	};
+
+	// Running sum of linear radiance per pixel; the image is Sum / Samples.
+	class Framebuffer
+	{
+	public:
+		Framebuffer(std::uint32_t Width, std::uint32_t Height);
+
+		void Clear();
+
+		std::uint32_t GetWidth() const { return mWidth; }
+		std::uint32_t GetHeight() const { return mHeight; }
+		std::uint32_t GetSampleCount() const { return mSamples; }
+
+		Vector3 GetPixel(std::uint32_t X, std::uint32_t Y) const;
+
+		// Binary PPM, Reinhard tone mapped and gamma 2.2 encoded.
+		bool WritePpm(const char* Path) const;
+
+	private:
+		friend class PathTracer;
+
+		std::uint32_t mWidth;
+		std::uint32_t mHeight;
+		std::uint32_t mSamples;
+		std::vector<Vector3> mSum;
+	};
+
+	// Progressive path tracer. Each RenderPass() adds one sample to every pixel,
+	// with tiles handed out to the pool. Samples only depend on pixel and pass,
+	// so the image is the same for any thread count.
+	class PathTracer
+	{
+	public:
+		static const std::uint32_t TILE_SIZE = 16;
+
+		PathTracer(const Scene& Source, const Camera& View, Framebuffer& Target);
+
+		void SetMaxDepth(std::uint32_t Depth) { mMaxDepth = Depth; }
+
+		void RenderPass(Parallel::ThreadPool& Pool = Parallel::ThreadPool::GetDefault());
+
+		// Closest-hit and shadow rays traced so far.
+		std::uint64_t GetRayCount() const { return mRays; }
+
+		Ray GetCameraRay(float X, float Y) const;
+
+	private:
+		Vector3 TracePath(Ray R, std::uint32_t& Seed, std::uint64_t& Rays) const;
+
+		const Scene& mScene;
+		Framebuffer& mTarget;
+
+		Vector3 mEye;
+		Vector3 mCorner;
+		Vector3 mRight;
+		Vector3 mDown;
+
+		std::uint32_t mMaxDepth;
+		std::uint64_t mRays;
+	};
+}
@@ -0,0 +1,341 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Profiler
+{
+	ThreadBuffer::ThreadBuffer(std::size_t Capacity, std::uint32_t Id)
+		: mId(Id), mHead(0), mCachedTail(0), mDropped(0), mTail(0)
+	{
+		std::size_t Size = 1;
+
+		while (Size < Capacity)
+		{
+			Size <<= 1;
+		}
+
+		mEvents = new Event[Size];
+		mMask = Size - 1;
+	}
+
+	ThreadBuffer::~ThreadBuffer()
+	{
+		delete[] mEvents;
+	}
+
+	namespace
+	{
+		struct CapturedEvent
+		{
+			const char* Name;
+			std::uint64_t Begin;
+			std::uint64_t End;
+			std::uint32_t Thread;
+		};
+
+		std::mutex RegistryLock;
+		std::vector<ThreadBuffer*> Threads;
+		std::vector<std::string> ThreadNames;
+		std::size_t BufferCapacity = 1 << 16;
+		std::uint64_t RetiredDropped = 0;
+
+		// Tick <-> ns calibration spans the whole run, so it sharpens over time
+		// without ever spinning.
+		const std::uint64_t StartTicks = Now();
+		const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+		std::atomic<double> NsPerTick(1.0);
+
+		std::uint64_t FrameIndex = 0;
+		std::uint64_t FrameBegin = StartTicks;
+
+		// Stats are kept per name text, so the index grows with distinct names
+		// rather than with distinct pointers. Keys view the first pointer seen.
+		std::unordered_map<std::string_view, std::size_t> StatIndex;
+		std::vector<ScopeStats> Working;
+		std::vector<ScopeStats> LastFrame;
+
+		bool Capturing = false;
+		std::size_t CaptureLimit = 0;
+		std::vector<CapturedEvent> Captured;
+		std::vector<CapturedEvent> CapturedFrames;
+
+		void UpdateCalibration()
+		{
+#if MIR_PROFILE_RDTSC
+			double Ticks = static_cast<double>(Now() - StartTicks);
+			double Ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - StartTime).count();
+
+			if (Ticks > 0.0 && Ns > 1.0e6)
+			{
+				NsPerTick.store(Ns / Ticks, std::memory_order_relaxed);
+			}
+#endif
+		}
+
+		ScopeStats& GetStats(const char* Name)
+		{
+			auto Found = StatIndex.find(std::string_view(Name));
+
+			if (Found != StatIndex.end())
+			{
+				return Working[Found->second];
+			}
+
+			StatIndex.emplace(std::string_view(Name), Working.size());
+			Working.push_back({ Name, 0, 0.0, 0.0, 0.0 });
+			return Working.back();
+		}
+
+		// Folds a ring into the current frame's aggregates. RegistryLock held.
+		void Accumulate(ThreadBuffer& Buffer, double Scale)
+		{
+			std::uint32_t Thread = Buffer.GetId();
+
+			Buffer.Drain([&](const Event& Iter)
+			{
+				double Ns = static_cast<double>(Iter.End - Iter.Begin) * Scale;
+				ScopeStats& Stats = GetStats(Iter.Name);
+
+				if (Stats.Count == 0)
+				{
+					Stats.MinNs = Stats.MaxNs = Ns;
+				}
+				else
+				{
+					Stats.MinNs = std::min(Stats.MinNs, Ns);
+					Stats.MaxNs = std::max(Stats.MaxNs, Ns);
+				}
+
+				++Stats.Count;
+				Stats.TotalNs += Ns;
+
+				if (Capturing && Captured.size() < CaptureLimit)
+				{
+					Captured.push_back({ Iter.Name, Iter.Begin, Iter.End, Thread });
+				}
+			});
+		}
+
+		// A ring lives exactly as long as its thread: what is left in it at exit
+		// joins the current frame and the ring is freed on the spot, so threads
+		// that never see an EndFrame() (pool or streamer workers) leak nothing.
+		struct ThreadBufferHandle
+		{
+			ThreadBuffer* Ptr = nullptr;
+
+			~ThreadBufferHandle()
+			{
+				if (Ptr == nullptr)
+				{
+					return;
+				}
+
+				std::lock_guard<std::mutex> Lock(RegistryLock);
+
+				Accumulate(*Ptr, NsPerTick.load(std::memory_order_relaxed));
+				RetiredDropped += Ptr->GetDropped();
+
+				Threads.erase(std::find(Threads.begin(), Threads.end(), Ptr));
+				delete Ptr;
+
+				Ptr = nullptr;
+				tBuffer = nullptr;
+			}
+		};
+
+		thread_local ThreadBufferHandle Local;
+
+		void WriteEscaped(std::FILE* File, const char* Text)
+		{
+			for (; *Text != '\0'; ++Text)
+			{
+				if (*Text == '"' || *Text == '\\')
+				{
+					std::fputc('\\', File);
+				}
+
+				if (static_cast<unsigned char>(*Text) >= 0x20)
+				{
+					std::fputc(*Text, File);
+				}
+			}
+		}
+	}
+
+	ThreadBuffer* RegisterThread()
+	{
+		std::lock_guard<std::mutex> Lock(RegistryLock);
+
+		std::uint32_t Id = static_cast<std::uint32_t>(ThreadNames.size());
+		ThreadBuffer* Buffer = new ThreadBuffer(BufferCapacity, Id);
+
+		Threads.push_back(Buffer);
+		ThreadNames.push_back("Thread " + std::to_string(Id));
+
+		Local.Ptr = Buffer;
+		tBuffer = Buffer;
+		return Buffer;
+	}
+
+	void SetBufferCapacity(std::size_t Events)
+	{
+		std::lock_guard<std::mutex> Lock(RegistryLock);
+		BufferCapacity = Events < 16 ? 16 : Events;
+	}
+
+	void SetThreadName(const char* Name)
+	{
+		ThreadBuffer& Buffer = GetThreadBuffer();
+
+		std::lock_guard<std::mutex> Lock(RegistryLock);
+		ThreadNames[Buffer.GetId()] = Name;
+	}
+
+	void EndFrame()
+	{
+		std::uint32_t FrameThread = GetThreadBuffer().GetId();
+		std::uint64_t FrameEnd = Now();
+
+		std::lock_guard<std::mutex> Lock(RegistryLock);
+
+		UpdateCalibration();
+		const double Scale = NsPerTick.load(std::memory_order_relaxed);
+
+		for (ThreadBuffer* Iter : Threads)
+		{
+			Accumulate(*Iter, Scale);
+		}
+
+		LastFrame.clear();
+
+		for (const ScopeStats& Iter : Working)
+		{
+			if (Iter.Count != 0)
+			{
+				LastFrame.push_back(Iter);
+			}
+		}
+
+		std::sort(LastFrame.begin(), LastFrame.end(), [](const ScopeStats& Left, const ScopeStats& Right)
+		{
+			return Left.TotalNs > Right.TotalNs;
+		});
+
+		for (ScopeStats& Iter : Working)
+		{
+			Iter.Count = 0;
+			Iter.TotalNs = 0.0;
+		}
+
+		if (Capturing)
+		{
+			CapturedFrames.push_back({ "Frame", FrameBegin, FrameEnd, FrameThread });
+		}
+
+		FrameBegin = FrameEnd;
+		++FrameIndex;
+	}
+
+	std::uint64_t GetFrameIndex()
+	{
+		std::lock_guard<std::mutex> Lock(RegistryLock);
+		return FrameIndex;
+	}
+
+	std::uint64_t GetDroppedEvents()
+	{
+		std::lock_guard<std::mutex> Lock(RegistryLock);
+
+		std::uint64_t Dropped = RetiredDropped;
+
+		for (const ThreadBuffer* Iter : Threads)
+		{
+			Dropped += Iter->GetDropped();
+		}
+		return Dropped;
+	}
+
+	std::vector<ScopeStats> GetFrameStats()
+	{
+		std::lock_guard<std::mutex> Lock(RegistryLock);
+		return LastFrame;
+	}
+
+	double TicksToNs(std::uint64_t Ticks)
+	{
+		return static_cast<double>(Ticks) * NsPerTick.load(std::memory_order_relaxed);
+	}
+
+	void BeginCapture(std::size_t MaxEvents)
+	{
+		std::lock_guard<std::mutex> Lock(RegistryLock);
+
+		Captured.clear();
+		CapturedFrames.clear();
+		Captured.reserve(std::min<std::size_t>(MaxEvents, 1 << 16));
+		CaptureLimit = MaxEvents;
+		Capturing = true;
+	}
+
+	void EndCapture()
+	{
+		std::lock_guard<std::mutex> Lock(RegistryLock);
+		Capturing = false;
+	}
+
+	bool IsCapturing()
+	{
+		std::lock_guard<std::mutex> Lock(RegistryLock);
+		return Capturing;
+	}
+
+	bool WriteChromeTrace(const char* Path)
+	{
+		std::FILE* File = std::fopen(Path, "w");
+
+		if (File == nullptr)
+		{
+			return false;
+		}
+
+		std::lock_guard<std::mutex> Lock(RegistryLock);
+
+		UpdateCalibration();
+		const double UsPerTick = NsPerTick.load(std::memory_order_relaxed) * 1.0e-3;
+
+		std::fprintf(File, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+		std::fprintf(File, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"MIR\"}}");
+
+		for (std::size_t i = 0; i < ThreadNames.size(); ++i)
+		{
+			std::fprintf(File, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"", i);
+			WriteEscaped(File, ThreadNames[i].c_str());
+			std::fprintf(File, "\"}}");
+		}
+
+		for (const std::vector<CapturedEvent>* List : { &CapturedFrames, &Captured })
+		{
+			for (const CapturedEvent& Iter : *List)
+			{
+				// Complete events; nesting on a thread follows from ts/dur.
+				std::fprintf(File, ",\n{\"name\":\"");
+				WriteEscaped(File, Iter.Name);
+				std::fprintf(File, "\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+					List == &CapturedFrames ? "frame" : "scope",
+					static_cast<double>(Iter.Begin - StartTicks) * UsPerTick,
+					static_cast<double>(Iter.End - Iter.Begin) * UsPerTick,
+					Iter.Thread);
+			}
+		}
+
+		std::fprintf(File, "\n]}\n");
+		return std::fclose(File) == 0;
+	}
+}
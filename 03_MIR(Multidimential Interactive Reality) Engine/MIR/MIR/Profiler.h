@@ -0,0 +1,193 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// MIR_PROFILE=0 turns every MIR_PROFILE_* macro into nothing. The functions in
+// namespace Profiler stay callable either way; they just never see any events.
+#if !defined(MIR_PROFILE)
+#define MIR_PROFILE 1
+#endif
+
+// Timestamps come from rdtsc on x86 and steady_clock elsewhere, or everywhere
+// when MIR_PROFILE_STEADY_CLOCK=1 (e.g. on hosts without an invariant TSC).
+#if !defined(MIR_PROFILE_STEADY_CLOCK)
+#define MIR_PROFILE_STEADY_CLOCK 0
+#endif
+
+#if !MIR_PROFILE_STEADY_CLOCK && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define MIR_PROFILE_RDTSC 1
+#elif !MIR_PROFILE_STEADY_CLOCK && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define MIR_PROFILE_RDTSC 1
+#else
+#define MIR_PROFILE_RDTSC 0
+#endif
+
+namespace Profiler
+{
+	inline std::uint64_t Now()
+	{
+#if MIR_PROFILE_RDTSC
+		return __rdtsc();
+#else
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	// Names must outlive the profiler; string literals are the intended use.
+	struct Event
+	{
+		const char* Name;
+		std::uint64_t Begin;
+		std::uint64_t End;
+	};
+
+	struct ScopeStats
+	{
+		const char* Name;
+		std::uint32_t Count;
+		double TotalNs;
+		double MinNs;
+		double MaxNs;
+
+		double GetAvgNs() const { return Count != 0 ? TotalNs / Count : 0.0; }
+	};
+
+	// Single-producer ring owned by one thread. The owner pushes without locks or
+	// atomics read-modify-writes; EndFrame() drains it from the frame thread. A
+	// full ring drops new events and counts them instead of blocking.
+	class ThreadBuffer
+	{
+	public:
+		ThreadBuffer(std::size_t Capacity, std::uint32_t Id);
+		~ThreadBuffer();
+
+		ThreadBuffer(const ThreadBuffer&) = delete;
+		ThreadBuffer& operator=(const ThreadBuffer&) = delete;
+
+		void Push(const char* Name, std::uint64_t Begin, std::uint64_t End)
+		{
+			std::uint64_t Head = mHead.load(std::memory_order_relaxed);
+
+			if (Head - mCachedTail > mMask)
+			{
+				mCachedTail = mTail.load(std::memory_order_acquire);
+
+				if (Head - mCachedTail > mMask)
+				{
+					mDropped.store(mDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+					return;
+				}
+			}
+
+			Event& Slot = mEvents[Head & mMask];
+			Slot.Name = Name;
+			Slot.Begin = Begin;
+			Slot.End = End;
+			mHead.store(Head + 1, std::memory_order_release);
+		}
+
+		// Consumer side; callers serialize among themselves.
+		template <typename Fn>
+		std::size_t Drain(Fn&& Visit)
+		{
+			std::uint64_t Tail = mTail.load(std::memory_order_relaxed);
+			std::uint64_t Head = mHead.load(std::memory_order_acquire);
+
+			for (std::uint64_t i = Tail; i < Head; ++i)
+			{
+				Visit(mEvents[i & mMask]);
+			}
+
+			mTail.store(Head, std::memory_order_release);
+			return static_cast<std::size_t>(Head - Tail);
+		}
+
+		std::uint32_t GetId() const { return mId; }
+		std::uint64_t GetDropped() const { return mDropped.load(std::memory_order_relaxed); }
+
+	private:
+		Event* mEvents;
+		std::uint64_t mMask;
+		std::uint32_t mId;
+
+		alignas(64) std::atomic<std::uint64_t> mHead;
+		std::uint64_t mCachedTail;
+		std::atomic<std::uint64_t> mDropped;
+
+		alignas(64) std::atomic<std::uint64_t> mTail;
+	};
+
+	ThreadBuffer* RegisterThread();
+
+	inline thread_local ThreadBuffer* tBuffer = nullptr;
+
+	inline ThreadBuffer& GetThreadBuffer()
+	{
+		ThreadBuffer* Buffer = tBuffer;
+		return Buffer != nullptr ? *Buffer : *RegisterThread();
+	}
+
+	class Scope
+	{
+	public:
+		explicit Scope(const char* Name) : mName(Name), mBegin(Now()) {}
+		~Scope() { GetThreadBuffer().Push(mName, mBegin, Now()); }
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		const char* mName;
+		std::uint64_t mBegin;
+	};
+
+	// Ring size in events for threads registered after the call (default 64K).
+	void SetBufferCapacity(std::size_t Events);
+	void SetThreadName(const char* Name);
+
+	// Drains every thread's ring, rebuilds the per-frame aggregates and, while a
+	// capture runs, keeps the raw events for export. Call once per frame from the
+	// thread that owns the frame loop; events are counted in the frame in which
+	// they were drained. A thread's ring is drained and freed when it exits.
+	void EndFrame();
+
+	std::uint64_t GetFrameIndex();
+	std::uint64_t GetDroppedEvents();
+
+	// Aggregates of the last completed frame, most total time first.
+	std::vector<ScopeStats> GetFrameStats();
+
+	double TicksToNs(std::uint64_t Ticks);
+
+	// Keeps events (up to MaxEvents) from the following frames until EndCapture().
+	void BeginCapture(std::size_t MaxEvents = 1 << 22);
+	void EndCapture();
+	bool IsCapturing();
+
+	// Chrome Trace Event JSON; opens in chrome://tracing and ui.perfetto.dev.
+	bool WriteChromeTrace(const char* Path);
+}
+
+#define MIR_PROFILE_CONCAT_INNER(A, B) A##B
+#define MIR_PROFILE_CONCAT(A, B) MIR_PROFILE_CONCAT_INNER(A, B)
+
+#if MIR_PROFILE
+#define MIR_PROFILE_SCOPE(Name) ::Profiler::Scope MIR_PROFILE_CONCAT(ProfileScope_, __LINE__)(Name)
+#define MIR_PROFILE_FUNCTION() MIR_PROFILE_SCOPE(__func__)
+#define MIR_PROFILE_THREAD(Name) ::Profiler::SetThreadName(Name)
+#define MIR_PROFILE_END_FRAME() ::Profiler::EndFrame()
+#else
+#define MIR_PROFILE_SCOPE(Name) ((void)0)
+#define MIR_PROFILE_FUNCTION() ((void)0)
+#define MIR_PROFILE_THREAD(Name) ((void)0)
+#define MIR_PROFILE_END_FRAME() ((void)0)
+#endif
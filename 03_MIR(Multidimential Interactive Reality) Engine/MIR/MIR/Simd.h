@@ -0,0 +1,19 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#pragma once
+
+// MIR_SIMD_SSE is set when SSE2 can be used unconditionally (every x64 target,
+// or x86 built with SSE2). Code paths guarded by it always keep a scalar fallback.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIR_SIMD_SSE 1
+#include <emmintrin.h>
+#else
+#define MIR_SIMD_SSE 0
+#endif
+
+#if defined(__AVX__)
+#define MIR_SIMD_AVX 1
+#include <immintrin.h>
+#else
+#define MIR_SIMD_AVX 0
+#endif
@@ -0,0 +1,193 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#include "SpatialHash.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Spatial
+{
+	HashGrid::HashGrid(float CellSize, std::uint32_t BucketCount)
+		: mCellSize(CellSize), mInvCellSize(1.f / CellSize), mBucketMask(BucketCount - 1),
+		mPositions(nullptr), mCount(0), mBucketStart(BucketCount + 1, 0)
+	{
+		assert(Memory::IsPow2(BucketCount));
+	}
+
+	static std::uint32_t HashCell(int X, int Y, int Z)
+	{
+		return (static_cast<std::uint32_t>(X) * 73856093u) ^
+			(static_cast<std::uint32_t>(Y) * 19349663u) ^
+			(static_cast<std::uint32_t>(Z) * 83492791u);
+	}
+
+	std::uint32_t HashGrid::GetBucket(const Vector3& Position) const
+	{
+		int X = static_cast<int>(floorf(Position.X * mInvCellSize));
+		int Y = static_cast<int>(floorf(Position.Y * mInvCellSize));
+		int Z = static_cast<int>(floorf(Position.Z * mInvCellSize));
+		return HashCell(X, Y, Z) & mBucketMask;
+	}
+
+	void HashGrid::Build(Vector3* Positions, std::size_t Count, Parallel::ThreadPool& Pool)
+	{
+		MIR_PROFILE_SCOPE("HashGrid::Build");
+
+		const std::size_t Buckets = static_cast<std::size_t>(mBucketMask) + 1;
+		const unsigned Workers = Pool.GetThreadCount();
+
+		mCount = Count;
+		mBucketOf.resize(Count);
+		mOrder.resize(Count);
+		mHistogram.resize(Buckets * Workers);
+		mBlockSum.resize(Workers);
+
+		// 1. Bucket every position and count per worker.
+		Pool.Run([&](unsigned Worker, unsigned NumWorkers)
+		{
+			std::uint32_t* Hist = &mHistogram[Worker * Buckets];
+			std::memset(Hist, 0, Buckets * sizeof(std::uint32_t));
+
+			std::size_t End = Count * (Worker + 1) / NumWorkers;
+
+			for (std::size_t i = Count * Worker / NumWorkers; i < End; ++i)
+			{
+				std::uint32_t Bucket = GetBucket(Positions[i]);
+				mBucketOf[i] = Bucket;
+				++Hist[Bucket];
+			}
+		});
+
+		// 2. Exclusive scan in bucket-major, worker-minor order. Each worker sums a
+		// slice of buckets, the slice totals are scanned serially, then each worker
+		// turns its slice into write offsets.
+		Pool.Run([&](unsigned Worker, unsigned NumWorkers)
+		{
+			std::size_t End = Buckets * (Worker + 1) / NumWorkers;
+			std::uint32_t Sum = 0;
+
+			for (std::size_t b = Buckets * Worker / NumWorkers; b < End; ++b)
+			{
+				for (unsigned w = 0; w < NumWorkers; ++w)
+				{
+					Sum += mHistogram[w * Buckets + b];
+				}
+			}
+			mBlockSum[Worker] = Sum;
+		});
+
+		std::uint32_t Running = 0;
+
+		for (unsigned w = 0; w < Workers; ++w)
+		{
+			std::uint32_t Sum = mBlockSum[w];
+			mBlockSum[w] = Running;
+			Running += Sum;
+		}
+
+		Pool.Run([&](unsigned Worker, unsigned NumWorkers)
+		{
+			std::size_t End = Buckets * (Worker + 1) / NumWorkers;
+			std::uint32_t Offset = mBlockSum[Worker];
+
+			for (std::size_t b = Buckets * Worker / NumWorkers; b < End; ++b)
+			{
+				mBucketStart[b] = Offset;
+
+				for (unsigned w = 0; w < NumWorkers; ++w)
+				{
+					std::uint32_t Num = mHistogram[w * Buckets + b];
+					mHistogram[w * Buckets + b] = Offset;
+					Offset += Num;
+				}
+			}
+		});
+
+		mBucketStart[Buckets] = static_cast<std::uint32_t>(Count);
+
+		// 3. Scatter. Workers walk the same ranges as in step 1, so the sort is stable.
+		Pool.Run([&](unsigned Worker, unsigned NumWorkers)
+		{
+			std::uint32_t* Hist = &mHistogram[Worker * Buckets];
+			std::size_t End = Count * (Worker + 1) / NumWorkers;
+
+			for (std::size_t i = Count * Worker / NumWorkers; i < End; ++i)
+			{
+				mOrder[Hist[mBucketOf[i]]++] = static_cast<std::uint32_t>(i);
+			}
+		});
+
+		// 4. Move the positions themselves into bucket order.
+		Reorder(Positions, Pool);
+		mPositions = Positions;
+	}
+
+	std::uint32_t HashGrid::GatherBuckets(const Vector3& Center, int Reach, std::uint32_t* Out) const
+	{
+		assert(Reach <= MAX_QUERY_REACH);
+
+		int X = static_cast<int>(floorf(Center.X * mInvCellSize));
+		int Y = static_cast<int>(floorf(Center.Y * mInvCellSize));
+		int Z = static_cast<int>(floorf(Center.Z * mInvCellSize));
+
+		std::uint32_t Count = 0;
+
+		for (int dz = -Reach; dz <= Reach; ++dz)
+		{
+			for (int dy = -Reach; dy <= Reach; ++dy)
+			{
+				for (int dx = -Reach; dx <= Reach; ++dx)
+				{
+					// Distinct cells can share a bucket; keep the list sorted and unique
+					// so no bucket is scanned twice and reads stay in address order.
+					std::uint32_t Bucket = HashCell(X + dx, Y + dy, Z + dz) & mBucketMask;
+					std::uint32_t Pos = Count;
+
+					while (Pos > 0 && Out[Pos - 1] > Bucket)
+					{
+						--Pos;
+					}
+
+					if (Pos > 0 && Out[Pos - 1] == Bucket)
+					{
+						continue;
+					}
+
+					for (std::uint32_t i = Count; i > Pos; --i)
+					{
+						Out[i] = Out[i - 1];
+					}
+
+					Out[Pos] = Bucket;
+					++Count;
+				}
+			}
+		}
+		return Count;
+	}
+
+	void HashGrid::GatherBuckets(const Vector3& Center, int Reach, std::vector<std::uint32_t>& Out) const
+	{
+		int X = static_cast<int>(floorf(Center.X * mInvCellSize));
+		int Y = static_cast<int>(floorf(Center.Y * mInvCellSize));
+		int Z = static_cast<int>(floorf(Center.Z * mInvCellSize));
+
+		Out.clear();
+		Out.reserve(static_cast<std::size_t>(2 * Reach + 1) * (2 * Reach + 1) * (2 * Reach + 1));
+
+		for (int dz = -Reach; dz <= Reach; ++dz)
+		{
+			for (int dy = -Reach; dy <= Reach; ++dy)
+			{
+				for (int dx = -Reach; dx <= Reach; ++dx)
+				{
+					Out.push_back(HashCell(X + dx, Y + dy, Z + dz) & mBucketMask);
+				}
+			}
+		}
+
+		std::sort(Out.begin(), Out.end());
+		Out.erase(std::unique(Out.begin(), Out.end()), Out.end());
+	}
+}
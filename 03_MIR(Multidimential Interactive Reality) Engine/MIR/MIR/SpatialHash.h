@@ -0,0 +1,133 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Math.h"
+#include "Memory.h"
+#include "Parallel.h"
+
+namespace Spatial
+{
+	// Uniform hash grid for many similarly sized objects (particles, crowds).
+	// Build() counting-sorts the positions by cell bucket in parallel and permutes
+	// them in place, so every bucket is one contiguous run of the caller's array.
+	// Other per-particle arrays follow with Reorder(); GetOrder() maps each new
+	// slot back to its index before the build.
+	class HashGrid
+	{
+	public:
+		explicit HashGrid(float CellSize, std::uint32_t BucketCount = 1 << 18);
+
+		void Build(Vector3* Positions, std::size_t Count, Parallel::ThreadPool& Pool = Parallel::ThreadPool::GetDefault());
+
+		template <typename T>
+		void Reorder(T* Data, Parallel::ThreadPool& Pool = Parallel::ThreadPool::GetDefault())
+		{
+			mScratch.Reset();
+			T* Temp = static_cast<T*>(mScratch.Alloc(sizeof(T) * mCount, alignof(T)));
+
+			Pool.For(mCount, [&](std::size_t Begin, std::size_t End, unsigned)
+			{
+				for (std::size_t i = Begin; i < End; ++i)
+				{
+					new (Temp + i) T(Data[mOrder[i]]);
+				}
+			});
+
+			Pool.For(mCount, [&](std::size_t Begin, std::size_t End, unsigned)
+			{
+				for (std::size_t i = Begin; i < End; ++i)
+				{
+					Data[i] = Temp[i];
+					Temp[i].~T();
+				}
+			});
+		}
+
+		// Calls Visit(Index, DistSq) for every position within Radius of Center.
+		// Radii up to three cells gather their buckets on the stack; larger ones
+		// use a heap list, or scan every position once the cells outnumber the
+		// buckets.
+		template <typename Fn>
+		void QueryRadius(const Vector3& Center, float Radius, Fn&& Visit) const
+		{
+			float RadiusSq = Radius * Radius;
+			float Reach = ceilf(Radius * mInvCellSize);
+
+			if (Reach <= MAX_QUERY_REACH)
+			{
+				std::uint32_t Buckets[MAX_QUERY_CELLS];
+				std::uint32_t NumBuckets = GatherBuckets(Center, static_cast<int>(Reach), Buckets);
+				VisitBuckets(Buckets, NumBuckets, Center, RadiusSq, Visit);
+			}
+			else if (!((2.f * Reach + 1.f) * (2.f * Reach + 1.f) * (2.f * Reach + 1.f) < static_cast<float>(mBucketMask) + 1.f))
+			{
+				VisitRange(0, static_cast<std::uint32_t>(mCount), Center, RadiusSq, Visit);
+			}
+			else
+			{
+				std::vector<std::uint32_t> Buckets;
+				GatherBuckets(Center, static_cast<int>(Reach), Buckets);
+				VisitBuckets(Buckets.data(), static_cast<std::uint32_t>(Buckets.size()), Center, RadiusSq, Visit);
+			}
+		}
+
+		float GetCellSize() const { return mCellSize; }
+		std::size_t GetCount() const { return mCount; }
+		const std::uint32_t* GetOrder() const { return mOrder.data(); }
+
+		std::uint32_t GetBucket(const Vector3& Position) const;
+		std::uint32_t GetBucketBegin(std::uint32_t Bucket) const { return mBucketStart[Bucket]; }
+		std::uint32_t GetBucketEnd(std::uint32_t Bucket) const { return mBucketStart[Bucket + 1]; }
+
+	private:
+		static const int MAX_QUERY_REACH = 3;
+		static const std::uint32_t MAX_QUERY_CELLS = 7 * 7 * 7;
+
+		// Sorted, unique buckets of the cells within Reach of Center's cell.
+		std::uint32_t GatherBuckets(const Vector3& Center, int Reach, std::uint32_t* Out) const;
+		void GatherBuckets(const Vector3& Center, int Reach, std::vector<std::uint32_t>& Out) const;
+
+		template <typename Fn>
+		void VisitBuckets(const std::uint32_t* Buckets, std::uint32_t NumBuckets, const Vector3& Center, float RadiusSq, Fn& Visit) const
+		{
+			for (std::uint32_t b = 0; b < NumBuckets; ++b)
+			{
+				VisitRange(mBucketStart[Buckets[b]], mBucketStart[Buckets[b] + 1], Center, RadiusSq, Visit);
+			}
+		}
+
+		template <typename Fn>
+		void VisitRange(std::uint32_t Begin, std::uint32_t End, const Vector3& Center, float RadiusSq, Fn& Visit) const
+		{
+			for (std::uint32_t i = Begin; i < End; ++i)
+			{
+				float DistSq = (mPositions[i] - Center).Square();
+
+				if (DistSq <= RadiusSq)
+				{
+					Visit(i, DistSq);
+				}
+			}
+		}
+
+		float mCellSize;
+		float mInvCellSize;
+		std::uint32_t mBucketMask;
+
+		const Vector3* mPositions;
+		std::size_t mCount;
+
+		std::vector<std::uint32_t> mBucketStart;
+		std::vector<std::uint32_t> mBucketOf;
+		std::vector<std::uint32_t> mOrder;
+		std::vector<std::uint32_t> mHistogram;
+		std::vector<std::uint32_t> mBlockSum;
+
+		Memory::LinearArena mScratch;
+	};
+}
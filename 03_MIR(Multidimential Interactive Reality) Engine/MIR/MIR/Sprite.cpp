@@ -0,0 +1,489 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#include "Sprite.h"
+#include "Memory.h"
+#include "Profiler.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace Sprite
+{
+	namespace
+	{
+		std::uint32_t Modulate(std::uint32_t Left, std::uint32_t Right)
+		{
+			std::uint32_t Temp = 0;
+
+			for (int Shift = 0; Shift < 32; Shift += 8)
+			{
+				std::uint32_t A = (Left >> Shift) & 0xFF, B = (Right >> Shift) & 0xFF;
+				Temp |= ((A * B + 255) >> 8) << Shift;
+			}
+			return Temp;
+		}
+
+		std::uint32_t Blend(std::uint32_t Src, std::uint32_t Dst)
+		{
+			std::uint32_t Alpha = Src >> 24;
+
+			if (Alpha == 255)
+			{
+				return Src;
+			}
+
+			std::uint32_t Temp = 0;
+
+			for (int Shift = 0; Shift < 32; Shift += 8)
+			{
+				std::uint32_t S = (Src >> Shift) & 0xFF, D = (Dst >> Shift) & 0xFF;
+				Temp |= ((S * Alpha + D * (255 - Alpha) + 127) / 255) << Shift;
+			}
+			return Temp;
+		}
+	}
+
+	VertexRing::VertexRing(std::size_t Capacity)
+		: mData(static_cast<Vertex*>(Memory::HeapAlloc(sizeof(Vertex) * Capacity, Memory::CACHE_LINE))),
+		mCapacity(Capacity), mHead(0), mTail(0)
+	{
+		// Commit every page now, as a mapped GPU buffer would be, so no frame
+		// pays for the first touch.
+		std::memset(static_cast<void*>(mData), 0, sizeof(Vertex) * Capacity);
+	}
+
+	VertexRing::~VertexRing()
+	{
+		Memory::HeapFree(mData, Memory::CACHE_LINE);
+	}
+
+	Vertex* VertexRing::Acquire(std::size_t Count, RingSpan& Out)
+	{
+		std::uint64_t Start = mHead;
+		std::size_t Pos = static_cast<std::size_t>(Start % mCapacity);
+
+		// A frame never straddles the end; the rest of the buffer is skipped.
+		if (Pos + Count > mCapacity)
+		{
+			Start += mCapacity - Pos;
+		}
+
+		if (Count > mCapacity || Start + Count - mTail.load(std::memory_order_acquire) > mCapacity)
+		{
+			return nullptr;
+		}
+
+		Out.Begin = mHead;
+		Out.End = Start + Count;
+		Out.First = static_cast<std::uint32_t>(Start % mCapacity);
+		Out.Count = static_cast<std::uint32_t>(Count);
+
+		mHead = Out.End;
+		return mData + Out.First;
+	}
+
+	void VertexRing::Release(const RingSpan& Span)
+	{
+		assert(Span.Begin == mTail.load(std::memory_order_relaxed));
+		mTail.store(Span.End, std::memory_order_release);
+	}
+
+	void RadixSort(std::uint64_t* Items, std::uint64_t* Scratch, std::size_t Count)
+	{
+		if (Count == 0)
+		{
+			return;
+		}
+
+		std::size_t Histogram[4][256] = {};
+
+		for (std::size_t i = 0; i < Count; ++i)
+		{
+			std::uint32_t Key = static_cast<std::uint32_t>(Items[i] >> 32);
+
+			++Histogram[0][Key & 0xFF];
+			++Histogram[1][(Key >> 8) & 0xFF];
+			++Histogram[2][(Key >> 16) & 0xFF];
+			++Histogram[3][Key >> 24];
+		}
+
+		std::uint64_t* Src = Items;
+		std::uint64_t* Dst = Scratch;
+
+		for (int Pass = 0; Pass < 4; ++Pass)
+		{
+			const int Shift = 32 + 8 * Pass;
+			std::size_t* Offsets = Histogram[Pass];
+
+			if (Offsets[(Src[0] >> Shift) & 0xFF] == Count)
+			{
+				continue;
+			}
+
+			std::size_t Sum = 0;
+
+			for (int i = 0; i < 256; ++i)
+			{
+				std::size_t Temp = Offsets[i];
+				Offsets[i] = Sum;
+				Sum += Temp;
+			}
+
+			for (std::size_t i = 0; i < Count; ++i)
+			{
+				Dst[Offsets[(Src[i] >> Shift) & 0xFF]++] = Src[i];
+			}
+			std::swap(Src, Dst);
+		}
+
+		if (Src != Items)
+		{
+			std::memcpy(Items, Src, Count * sizeof(std::uint64_t));
+		}
+	}
+
+	void Batch::Clear()
+	{
+		for (std::vector<float>* Iter : { &mM00, &mM01, &mM10, &mM11, &mTx, &mTy })
+		{
+			Iter->clear();
+		}
+		mStyle.clear();
+		mOrder.clear();
+	}
+
+	void Batch::Reserve(std::size_t Count)
+	{
+		for (std::vector<float>* Iter : { &mM00, &mM01, &mM10, &mM11, &mTx, &mTy })
+		{
+			Iter->reserve(Count);
+		}
+		mStyle.reserve(Count);
+		mOrder.reserve(Count);
+	}
+
+	void Batch::Add(const Vector2& Position, const Vector2& Size, float Rad,
+		std::uint16_t Texture, std::uint16_t Layer, std::uint32_t Color, const UvRect& Uv)
+	{
+		// Matrix3::CreateAffine(Size, Rad, Position), written out.
+		float Cos = Math::Cos(Rad), Sin = Math::Sin(Rad);
+		Push(Size.X * Cos, Size.X * Sin, -Size.Y * Sin, Size.Y * Cos, Position.X, Position.Y, Texture, Layer, Color, Uv);
+	}
+
+	void Batch::Add(const Matrix3& Transform, std::uint16_t Texture, std::uint16_t Layer, std::uint32_t Color, const UvRect& Uv)
+	{
+		const float (&M)[3][3] = Transform.Mat;
+		Push(M[0][0], M[0][1], M[1][0], M[1][1], M[2][0], M[2][1], Texture, Layer, Color, Uv);
+	}
+
+	void Batch::Push(float M00, float M01, float M10, float M11, float Tx, float Ty,
+		std::uint16_t Texture, std::uint16_t Layer, std::uint32_t Color, const UvRect& Uv)
+	{
+		std::uint64_t Key = (static_cast<std::uint64_t>(Layer) << 16) | Texture;
+
+		mOrder.push_back((Key << 32) | mTx.size());
+		mM00.push_back(M00);
+		mM01.push_back(M01);
+		mM10.push_back(M10);
+		mM11.push_back(M11);
+		mTx.push_back(Tx);
+		mTy.push_back(Ty);
+		mStyle.push_back({ Uv, Color });
+	}
+
+	bool Batch::Build(VertexRing& Ring, RingSpan& Span, std::vector<DrawCommand>& Commands)
+	{
+		Sort();
+		Transform();
+		return Emit(Ring, Span, Commands);
+	}
+
+	void Batch::Sort()
+	{
+		MIR_PROFILE_SCOPE("Sprite::Batch::Sort");
+
+		mScratch.resize(mOrder.size());
+		RadixSort(mOrder.data(), mScratch.data(), mOrder.size());
+	}
+
+	void Batch::Transform()
+	{
+		MIR_PROFILE_SCOPE("Sprite::Batch::Transform");
+
+		const std::size_t Count = GetCount();
+		mCorners.resize(8 * Count);
+
+		// Corners of the unit quad are (-+0.5, -+0.5), so with A = 0.5 * row 0 and
+		// B = 0.5 * row 1 they are T - A - B, T + A - B, T + A + B and T - A + B.
+		// Four sprites are transformed at once and transposed into their blocks.
+		float* Out = mCorners.data();
+		std::size_t i = 0;
+
+#if MIR_SIMD_SSE
+		const __m128 Half = _mm_set1_ps(0.5f);
+
+		for (; i + 4 <= Count; i += 4, Out += 32)
+		{
+			__m128 Tx = _mm_loadu_ps(&mTx[i]), Ty = _mm_loadu_ps(&mTy[i]);
+			__m128 Ax = _mm_mul_ps(_mm_loadu_ps(&mM00[i]), Half), Ay = _mm_mul_ps(_mm_loadu_ps(&mM01[i]), Half);
+			__m128 Bx = _mm_mul_ps(_mm_loadu_ps(&mM10[i]), Half), By = _mm_mul_ps(_mm_loadu_ps(&mM11[i]), Half);
+			__m128 Lx = _mm_sub_ps(Tx, Ax), Rx = _mm_add_ps(Tx, Ax);
+			__m128 Ly = _mm_sub_ps(Ty, Ay), Ry = _mm_add_ps(Ty, Ay);
+
+			__m128 X0 = _mm_sub_ps(Lx, Bx), X1 = _mm_sub_ps(Rx, Bx), X2 = _mm_add_ps(Rx, Bx), X3 = _mm_add_ps(Lx, Bx);
+			__m128 Y0 = _mm_sub_ps(Ly, By), Y1 = _mm_sub_ps(Ry, By), Y2 = _mm_add_ps(Ry, By), Y3 = _mm_add_ps(Ly, By);
+
+			_MM_TRANSPOSE4_PS(X0, X1, X2, X3);
+			_MM_TRANSPOSE4_PS(Y0, Y1, Y2, Y3);
+
+			_mm_storeu_ps(Out + 0, X0); _mm_storeu_ps(Out + 4, Y0);
+			_mm_storeu_ps(Out + 8, X1); _mm_storeu_ps(Out + 12, Y1);
+			_mm_storeu_ps(Out + 16, X2); _mm_storeu_ps(Out + 20, Y2);
+			_mm_storeu_ps(Out + 24, X3); _mm_storeu_ps(Out + 28, Y3);
+		}
+#endif
+		for (; i < Count; ++i, Out += 8)
+		{
+			float Ax = 0.5f * mM00[i], Ay = 0.5f * mM01[i];
+			float Bx = 0.5f * mM10[i], By = 0.5f * mM11[i];
+			float Lx = mTx[i] - Ax, Rx = mTx[i] + Ax;
+			float Ly = mTy[i] - Ay, Ry = mTy[i] + Ay;
+
+			Out[0] = Lx - Bx; Out[1] = Rx - Bx; Out[2] = Rx + Bx; Out[3] = Lx + Bx;
+			Out[4] = Ly - By; Out[5] = Ry - By; Out[6] = Ry + By; Out[7] = Ly + By;
+		}
+	}
+
+	bool Batch::Emit(VertexRing& Ring, RingSpan& Span, std::vector<DrawCommand>& Commands) const
+	{
+		MIR_PROFILE_SCOPE("Sprite::Batch::Emit");
+
+		Commands.clear();
+
+		const std::size_t Count = GetCount();
+		Vertex* Out = Ring.Acquire(4 * Count, Span);
+
+		if (Out == nullptr)
+		{
+			return false;
+		}
+
+		std::uint64_t RunKey = ~0ull;
+
+		for (std::size_t k = 0; k < Count; ++k)
+		{
+			std::uint64_t Key = mOrder[k] >> 32;
+			std::uint32_t i = static_cast<std::uint32_t>(mOrder[k]);
+
+			if (Key != RunKey)
+			{
+				DrawCommand Command;
+				Command.Layer = static_cast<std::uint16_t>(Key >> 16);
+				Command.Texture = static_cast<std::uint16_t>(Key);
+				Command.FirstVertex = Span.First + static_cast<std::uint32_t>(4 * k);
+				Command.SpriteCount = 0;
+
+				Commands.push_back(Command);
+				RunKey = Key;
+			}
+			++Commands.back().SpriteCount;
+
+			const float* X = mCorners.data() + 8 * static_cast<std::size_t>(i);
+			const float* Y = X + 4;
+			const Style& Look = mStyle[i];
+			Vertex* Quad = Out + 4 * k;
+
+			Quad[0] = { X[0], Y[0], Look.Uv.U0, Look.Uv.V0, Look.Color };
+			Quad[1] = { X[1], Y[1], Look.Uv.U1, Look.Uv.V0, Look.Color };
+			Quad[2] = { X[2], Y[2], Look.Uv.U1, Look.Uv.V1, Look.Color };
+			Quad[3] = { X[3], Y[3], Look.Uv.U0, Look.Uv.V1, Look.Color };
+		}
+		return true;
+	}
+
+	Rasterizer::Rasterizer(std::uint32_t Width, std::uint32_t Height)
+		: mWidth(Width), mHeight(Height), mPixels(static_cast<std::size_t>(Width) * Height, 0), mPixelsWritten(0)
+	{
+		mBlank.Width = 1;
+		mBlank.Height = 1;
+		mBlank.Texels.assign(1, WHITE);
+	}
+
+	void Rasterizer::SetTexture(std::uint16_t Index, const Texture& Source)
+	{
+		if (Index >= mTextures.size())
+		{
+			mTextures.resize(static_cast<std::size_t>(Index) + 1);
+		}
+		mTextures[Index] = Source;
+	}
+
+	void Rasterizer::Clear(std::uint32_t Color)
+	{
+		std::fill(mPixels.begin(), mPixels.end(), Color);
+		mPixelsWritten = 0;
+	}
+
+	void Rasterizer::Draw(const Vertex* Vertices, const DrawCommand* Commands, std::size_t CommandCount, Parallel::ThreadPool& Pool)
+	{
+		MIR_PROFILE_SCOPE("Sprite::Rasterizer::Draw");
+
+		const std::uint32_t Bands = (mHeight + BAND_HEIGHT - 1) / BAND_HEIGHT;
+		std::vector<std::uint64_t> Written(Pool.GetThreadCount(), 0);
+
+		Pool.ForDynamic(Bands, 1, [&](std::size_t Begin, std::size_t End, unsigned Worker)
+		{
+			std::uint64_t Local = 0;
+
+			for (std::size_t Band = Begin; Band < End; ++Band)
+			{
+				std::uint32_t Y0 = static_cast<std::uint32_t>(Band) * BAND_HEIGHT;
+				std::uint32_t Y1 = Math::Min(Y0 + BAND_HEIGHT, mHeight);
+
+				for (std::size_t c = 0; c < CommandCount; ++c)
+				{
+					const DrawCommand& Command = Commands[c];
+					const Texture& Source = Command.Texture < mTextures.size() && mTextures[Command.Texture].Width > 0
+						? mTextures[Command.Texture] : mBlank;
+					const Vertex* Quad = Vertices + Command.FirstVertex;
+
+					for (std::uint32_t s = 0; s < Command.SpriteCount; ++s, Quad += 4)
+					{
+						DrawQuad(Quad, Source, Y0, Y1, Local);
+					}
+				}
+			}
+			Written[Worker] += Local;
+		});
+
+		for (std::uint64_t Iter : Written)
+		{
+			mPixelsWritten += Iter;
+		}
+	}
+
+	void Rasterizer::DrawQuad(const Vertex* Quad, const Texture& Source, std::uint32_t Y0, std::uint32_t Y1, std::uint64_t& Written)
+	{
+		float MinY = Math::Min(Math::Min(Quad[0].Y, Quad[1].Y), Math::Min(Quad[2].Y, Quad[3].Y));
+		float MaxY = Math::Max(Math::Max(Quad[0].Y, Quad[1].Y), Math::Max(Quad[2].Y, Quad[3].Y));
+
+		if (!(MaxY > static_cast<float>(Y0) && MinY < static_cast<float>(Y1)))
+		{
+			return;
+		}
+
+		float MinX = Math::Min(Math::Min(Quad[0].X, Quad[1].X), Math::Min(Quad[2].X, Quad[3].X));
+		float MaxX = Math::Max(Math::Max(Quad[0].X, Quad[1].X), Math::Max(Quad[2].X, Quad[3].X));
+
+		if (!(MaxX > 0.f && MinX < static_cast<float>(mWidth)))
+		{
+			return;
+		}
+
+		// The quad is a parallelogram, so a pixel centre P is inside when
+		// P - Q0 = S * (Q1 - Q0) + T * (Q3 - Q0) with S and T in [0, 1).
+		float E1x = Quad[1].X - Quad[0].X, E1y = Quad[1].Y - Quad[0].Y;
+		float E2x = Quad[3].X - Quad[0].X, E2y = Quad[3].Y - Quad[0].Y;
+		float Det = E1x * E2y - E1y * E2x;
+
+		if (Math::Abs(Det) < 1e-12f)
+		{
+			return;
+		}
+
+		float InvDet = 1.f / Det;
+		float DsDx = E2y * InvDet, DtDx = -E1y * InvDet;
+
+		float Du = Quad[1].U - Quad[0].U, Dv = Quad[1].V - Quad[0].V;
+		float Eu = Quad[3].U - Quad[0].U, Ev = Quad[3].V - Quad[0].V;
+
+		std::uint32_t X0 = static_cast<std::uint32_t>(Math::Max(0.f, MinX - 0.5f));
+		std::uint32_t X1 = static_cast<std::uint32_t>(Math::Min(static_cast<float>(mWidth), MaxX + 0.5f));
+		std::uint32_t RowBegin = Math::Max(Y0, static_cast<std::uint32_t>(Math::Max(0.f, MinY - 0.5f)));
+		std::uint32_t RowEnd = Math::Min(Y1, static_cast<std::uint32_t>(Math::Min(static_cast<float>(mHeight), MaxY + 0.5f)));
+
+		const float TexW = static_cast<float>(Source.Width), TexH = static_cast<float>(Source.Height);
+		const std::uint32_t Color = Quad[0].Color;
+
+		for (std::uint32_t Y = RowBegin; Y < RowEnd; ++Y)
+		{
+			float Px = X0 + 0.5f - Quad[0].X, Py = Y + 0.5f - Quad[0].Y;
+			float S0 = (Px * E2y - Py * E2x) * InvDet;
+			float T0 = (E1x * Py - E1y * Px) * InvDet;
+			std::uint32_t* Row = mPixels.data() + static_cast<std::size_t>(Y) * mWidth;
+
+			for (std::uint32_t X = X0; X < X1; ++X)
+			{
+				float Step = static_cast<float>(X - X0);
+				float S = S0 + Step * DsDx, T = T0 + Step * DtDx;
+
+				if (S < 0.f || S >= 1.f || T < 0.f || T >= 1.f)
+				{
+					continue;
+				}
+
+				float U = Quad[0].U + S * Du + T * Eu;
+				float V = Quad[0].V + S * Dv + T * Ev;
+				std::uint32_t Tu = static_cast<std::uint32_t>(Math::Clamp(U * TexW, 0.f, TexW - 1.f));
+				std::uint32_t Tv = static_cast<std::uint32_t>(Math::Clamp(V * TexH, 0.f, TexH - 1.f));
+				std::uint32_t Texel = Modulate(Source.Texels[static_cast<std::size_t>(Tv) * Source.Width + Tu], Color);
+
+				if ((Texel >> 24) != 0)
+				{
+					Row[X] = Blend(Texel, Row[X]);
+				}
+				++Written;
+			}
+		}
+	}
+
+	bool Rasterizer::WritePpm(const char* Path) const
+	{
+		std::FILE* File = std::fopen(Path, "wb");
+
+		if (File == nullptr)
+		{
+			return false;
+		}
+
+		std::fprintf(File, "P6\n%u %u\n255\n", mWidth, mHeight);
+
+		std::vector<unsigned char> Row(3 * static_cast<std::size_t>(mWidth));
+
+		for (std::uint32_t Y = 0; Y < mHeight; ++Y)
+		{
+			for (std::uint32_t X = 0; X < mWidth; ++X)
+			{
+				std::uint32_t Pixel = GetPixel(X, Y);
+
+				Row[3 * X + 0] = static_cast<unsigned char>(Pixel);
+				Row[3 * X + 1] = static_cast<unsigned char>(Pixel >> 8);
+				Row[3 * X + 2] = static_cast<unsigned char>(Pixel >> 16);
+			}
+			std::fwrite(Row.data(), 1, Row.size(), File);
+		}
+		return std::fclose(File) == 0;
+	}
+
+	bool DumpFrame(const char* Path, const VertexRing& Ring, const RingSpan& Span, const std::vector<DrawCommand>& Commands)
+	{
+		std::FILE* File = std::fopen(Path, "wb");
+
+		if (File == nullptr)
+		{
+			return false;
+		}
+
+		const std::uint32_t Header[4] = { 0x5352494Du, static_cast<std::uint32_t>(Commands.size()), Span.Count, static_cast<std::uint32_t>(sizeof(Vertex)) }; // "MIRS"
+
+		bool IsOk = std::fwrite(Header, sizeof(Header), 1, File) == 1
+			&& (Commands.empty() || std::fwrite(Commands.data(), sizeof(DrawCommand), Commands.size(), File) == Commands.size())
+			&& (Span.Count == 0 || std::fwrite(Ring.GetData() + Span.First, sizeof(Vertex), Span.Count, File) == Span.Count);
+
+		return std::fclose(File) == 0 && IsOk;
+	}
+}
@@ -0,0 +1,190 @@
+// Copyright 2023. Jiwon-Nam All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Math.h"
+#include "Parallel.h"
+
+namespace Sprite
+{
+	const std::uint32_t WHITE = 0xFFFFFFFFu;
+
+	// Colors are RGBA8 in memory order, i.e. 0xAABBGGRR.
+	inline std::uint32_t MakeColor(std::uint8_t R, std::uint8_t G, std::uint8_t B, std::uint8_t A = 255)
+	{
+		return static_cast<std::uint32_t>(R) | (static_cast<std::uint32_t>(G) << 8) | (static_cast<std::uint32_t>(B) << 16) | (static_cast<std::uint32_t>(A) << 24);
+	}
+
+	struct Vertex
+	{
+		float X, Y;
+		float U, V;
+		std::uint32_t Color;
+	};
+
+	struct UvRect
+	{
+		float U0 = 0.f, V0 = 0.f;
+		float U1 = 1.f, V1 = 1.f;
+	};
+
+	// A run of sprites sharing layer and texture. Each sprite is four vertices
+	// from FirstVertex on, drawn as the quad 0 1 2 3.
+	struct DrawCommand
+	{
+		std::uint16_t Layer;
+		std::uint16_t Texture;
+		std::uint32_t FirstVertex;
+		std::uint32_t SpriteCount;
+	};
+
+	// Range of a VertexRing handed out for one frame. Begin / End count every
+	// vertex ever written, including the padding skipped at a wrap.
+	struct RingSpan
+	{
+		std::uint64_t Begin = 0;
+		std::uint64_t End = 0;
+		std::uint32_t First = 0;
+		std::uint32_t Count = 0;
+	};
+
+	// Fixed vertex buffer with one producer and one consumer, the CPU stand-in
+	// for a persistently mapped GPU buffer. Every frame gets one contiguous
+	// range; the consumer gives ranges back with Release() in the order they
+	// were acquired, from any thread.
+	class VertexRing
+	{
+	public:
+		explicit VertexRing(std::size_t Capacity);
+		~VertexRing();
+
+		VertexRing(const VertexRing&) = delete;
+		VertexRing& operator=(const VertexRing&) = delete;
+
+		// Null when the range would overwrite vertices not yet released.
+		Vertex* Acquire(std::size_t Count, RingSpan& Out);
+		void Release(const RingSpan& Span);
+
+		const Vertex* GetData() const { return mData; }
+		std::size_t GetCapacity() const { return mCapacity; }
+		std::size_t GetInFlight() const { return static_cast<std::size_t>(mHead - mTail.load(std::memory_order_acquire)); }
+
+	private:
+		Vertex* mData;
+		std::size_t mCapacity;
+		std::uint64_t mHead;
+		std::atomic<std::uint64_t> mTail;
+	};
+
+	// Stable LSD radix sort of Items by their upper 32 bits, 8 bits per pass.
+	// Passes where every item has the same digit are skipped. Scratch must hold
+	// Count items.
+	void RadixSort(std::uint64_t* Items, std::uint64_t* Scratch, std::size_t Count);
+
+	// Sprites of one frame kept SoA. Each sprite is the affine image of the
+	// unit quad centred on the origin, stored as its 2x2 part and translation
+	// in the same row-vector layout as Matrix3.
+	//
+	// Build() = Sort() + Transform() + Emit(): order by (layer, texture) with a
+	// radix sort, transform the corners four sprites at a time, then write the
+	// vertices into the ring in sorted order, one command per run.
+	class Batch
+	{
+	public:
+		void Clear();
+		void Reserve(std::size_t Count);
+
+		std::size_t GetCount() const { return mTx.size(); }
+
+		// Size is the full width and height, rotated about the centre.
+		void Add(const Vector2& Position, const Vector2& Size, float Rad,
+			std::uint16_t Texture, std::uint16_t Layer, std::uint32_t Color = WHITE, const UvRect& Uv = UvRect());
+
+		// Transform maps the unit quad [-0.5, 0.5]^2 to the screen.
+		void Add(const Matrix3& Transform, std::uint16_t Texture, std::uint16_t Layer, std::uint32_t Color = WHITE, const UvRect& Uv = UvRect());
+
+		bool Build(VertexRing& Ring, RingSpan& Span, std::vector<DrawCommand>& Commands);
+
+		void Sort();
+		void Transform();
+		bool Emit(VertexRing& Ring, RingSpan& Span, std::vector<DrawCommand>& Commands) const;
+
+		// Corner 0..3 of sprite Index, valid after Transform().
+		Vector2 GetCorner(std::size_t Index, int Corner) const { return Vector2(mCorners[8 * Index + Corner], mCorners[8 * Index + 4 + Corner]); }
+
+	private:
+		void Push(float M00, float M01, float M10, float M11, float Tx, float Ty,
+			std::uint16_t Texture, std::uint16_t Layer, std::uint32_t Color, const UvRect& Uv);
+
+		// Read once per sprite, in sorted order, by Emit().
+		struct Style
+		{
+			UvRect Uv;
+			std::uint32_t Color;
+		};
+
+		std::vector<float> mM00, mM01, mM10, mM11, mTx, mTy;
+		std::vector<Style> mStyle;
+
+		// (Layer << 16 | Texture) << 32 | submission index.
+		std::vector<std::uint64_t> mOrder;
+		std::vector<std::uint64_t> mScratch;
+
+		// Per sprite X0..X3 then Y0..Y3, so Emit() gathers one 32-byte block.
+		std::vector<float> mCorners;
+	};
+
+	struct Texture
+	{
+		std::uint32_t Width = 0;
+		std::uint32_t Height = 0;
+		std::vector<std::uint32_t> Texels;
+	};
+
+	// Draws ring frames into an RGBA8 target: nearest texel sampling, vertex
+	// color modulation and "over" blending. Horizontal bands go to the pool,
+	// and each band walks the commands in order, so the image does not depend
+	// on the thread count. A pixel is covered when its centre lies in the
+	// half-open quad, so sprites sharing an edge never cover a pixel twice.
+	class Rasterizer
+	{
+	public:
+		static const std::uint32_t BAND_HEIGHT = 16;
+
+		Rasterizer(std::uint32_t Width, std::uint32_t Height);
+
+		void SetTexture(std::uint16_t Index, const Texture& Source);
+
+		void Clear(std::uint32_t Color);
+		void Draw(const Vertex* Vertices, const DrawCommand* Commands, std::size_t CommandCount,
+			Parallel::ThreadPool& Pool = Parallel::ThreadPool::GetDefault());
+
+		std::uint32_t GetWidth() const { return mWidth; }
+		std::uint32_t GetHeight() const { return mHeight; }
+		std::uint32_t GetPixel(std::uint32_t X, std::uint32_t Y) const { return mPixels[static_cast<std::size_t>(Y) * mWidth + X]; }
+
+		// Covered pixels since the last Clear(), overdraw included.
+		std::uint64_t GetPixelsWritten() const { return mPixelsWritten; }
+
+		bool WritePpm(const char* Path) const;
+
+	private:
+		void DrawQuad(const Vertex* Quad, const Texture& Source, std::uint32_t Y0, std::uint32_t Y1, std::uint64_t& Written);
+
+		std::uint32_t mWidth;
+		std::uint32_t mHeight;
+		std::vector<std::uint32_t> mPixels;
+		std::vector<Texture> mTextures;
+		Texture mBlank;
+		std::uint64_t mPixelsWritten;
+	};
+
+	// Writes one frame as the consumer would see it: a small header, the
+	// commands, then the raw vertices.
+	bool DumpFrame(const char* Path, const VertexRing& Ring, const RingSpan& Span, const std::vector<DrawCommand>& Commands);
+}